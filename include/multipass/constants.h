@@ -44,6 +44,9 @@ constexpr auto autostart_key = "client.gui.autostart"; // idem
 constexpr auto winterm_key = "client.apps.windows-terminal.profiles"; // idem
 constexpr auto hotkey_key = "client.gui.hotkey";                      // idem
 constexpr auto hotkey_default = "Ctrl+Alt+U";                         // idem; translates to Cmd+Opt+U on macOS
+constexpr auto warm_images_key = "local.images.warm"; // idem; images to fetch as soon as they are released
+constexpr auto image_cache_budget_key = "local.images.budget"; // idem; size cached images are kept within, 0 for none
+constexpr auto image_cache_budget_default = "20G";             // idem
 } // namespace multipass
 
 #endif // MULTIPASS_CONSTANTS_H
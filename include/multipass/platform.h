@@ -63,6 +63,9 @@ std::unique_ptr<Process> make_process(std::unique_ptr<ProcessSpec>&& process_spe
 int chown(const char* path, unsigned int uid, unsigned int gid);
 bool symlink(const char* target, const char* link, bool is_dir);
 bool link(const char* target, const char* link);
+bool copy_file(const char* source, const char* destination); // keeps holes; shares extents where supported
+// Has the calling thread, and the processes it starts, only use the disk when nothing else does
+bool set_background_io_priority(bool background);
 int utime(const char* path, int atime, int mtime);
 int symlink_attr_from(const char* path, sftp_attributes_struct* attr);
 bool is_alias_supported(const std::string& alias, const std::string& remote);
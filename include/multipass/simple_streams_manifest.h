@@ -23,10 +23,12 @@
 #include <multipass/vm_image_info.h>
 
 #include <QByteArray>
+#include <QHash>
 #include <QMap>
 #include <QString>
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace multipass
@@ -38,9 +40,19 @@ struct SimpleStreamsManifest
     SimpleStreamsManifest& operator=(const SimpleStreamsManifest&) = delete;
     static std::unique_ptr<SimpleStreamsManifest> fromJson(const QByteArray& json, const QString& host_url);
 
+    using ProductIndex = std::vector<const VMImageInfo*>;
+    using ProductRange = std::pair<ProductIndex::const_iterator, ProductIndex::const_iterator>;
+
+    // The first product with the given id, or nullptr if there is none
+    const VMImageInfo* product_with_id(const QString& id) const;
+    // Products whose ids start with the given prefix, in the order of their ids
+    ProductRange products_with_id_prefix(const QString& prefix) const;
+
     const QString updated_at;
     const std::vector<VMImageInfo> products;
     const QMap<QString, const VMImageInfo*> image_records;
+    const QHash<QString, const VMImageInfo*> products_by_id;
+    const ProductIndex products_sorted_by_id; // products in the same order where ids are the same
 };
 }
 #endif // MULTIPASS_SIMPLE_STREAMS_MANIFEST_H
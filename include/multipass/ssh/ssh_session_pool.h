@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MULTIPASS_SSH_SESSION_POOL_H
+#define MULTIPASS_SSH_SESSION_POOL_H
+
+#include <multipass/optional.h>
+#include <multipass/ssh/ssh_process.h>
+#include <multipass/ssh/ssh_session.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace multipass
+{
+class SSHKeyProvider;
+
+/*
+ * SSHSessionPool - keeps one authenticated SSH session per instance, for one user at a time
+ *
+ * A session is connected the first time it is leased and kept for later leases, so that they skip the connection,
+ * key exchange and authentication. It is replaced when the instance's address changes or the connection is found to
+ * be down, which covers instances that restarted. Sessions are not shared between users: a lease gives exclusive use
+ * of the session, and leasing it again waits for that lease to be over, so channels opened through it must be done
+ * with before the lease goes away. Dropping a session does not wait: a leased session is disconnected once its lease
+ * is over. This class is thread-safe.
+ */
+class SSHSessionPool
+{
+    struct Entry;
+
+public:
+    struct Metrics
+    {
+        std::uint64_t handshakes{0};       // sessions connected and authenticated
+        std::uint64_t handshakes_saved{0}; // leases served by a kept session
+        std::uint64_t channels_opened{0};
+        std::chrono::microseconds total_channel_open_time{0};
+        std::chrono::microseconds max_channel_open_time{0};
+    };
+
+    class Lease
+    {
+    public:
+        SSHProcess exec(const std::string& cmd);
+        SSHSession& session();
+        void reconnect();
+
+    private:
+        friend class SSHSessionPool;
+        Lease(SSHSessionPool& pool, std::shared_ptr<Entry> entry, std::unique_lock<std::mutex> entry_lock);
+
+        SSHSessionPool* pool;
+        std::shared_ptr<Entry> entry;
+        std::unique_lock<std::mutex> entry_lock;
+    };
+
+    explicit SSHSessionPool(const SSHKeyProvider& key_provider);
+
+    Lease lease(const std::string& name, const std::string& hostname, int port, const std::string& username);
+    void drop(const std::string& name);
+    Metrics metrics() const;
+
+private:
+    struct Entry
+    {
+        std::mutex mutex;
+        std::string hostname;
+        int port{0};
+        std::string username;
+        optional<SSHSession> session;
+    };
+
+    void connect(Entry& entry);
+    void record_channel_open(std::chrono::microseconds time);
+
+    const SSHKeyProvider& key_provider;
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<Entry>> entries;
+    Metrics current_metrics;
+};
+} // namespace multipass
+#endif // MULTIPASS_SSH_SESSION_POOL_H
@@ -26,7 +26,9 @@
 
 #include <atomic>
 #include <chrono>
+#include <functional>
 
+class QCryptographicHash;
 class QUrl;
 class QString;
 namespace multipass
@@ -37,10 +39,21 @@ public:
     URLDownloader(std::chrono::milliseconds timeout);
     URLDownloader(const Path& cache_dir, std::chrono::milliseconds timeout);
     virtual ~URLDownloader() = default;
+    // When given a digest, everything that is downloaded is also added to it, as it arrives
     virtual void download_to(const QUrl& url, const QString& file_name, int64_t size, const int download_type,
-                             const ProgressMonitor& monitor);
+                             const ProgressMonitor& monitor, QCryptographicHash* digest);
+    // Hands what is downloaded to consume as it arrives, instead of storing it. Whatever consume throws ends the
+    // download and is passed on.
+    using DataConsumer = std::function<void(const QByteArray& data)>;
+    virtual void download_stream(const QUrl& url, const DataConsumer& consume, int64_t size, const int download_type,
+                                 const ProgressMonitor& monitor, QCryptographicHash* digest);
     virtual QByteArray download(const QUrl& url);
+    // Like download(), except that when the copy of url that was downloaded before is still current, nothing is read
+    // and not_modified is set instead
+    virtual QByteArray download_if_modified(const QUrl& url, bool& not_modified);
     virtual QDateTime last_modified(const QUrl& url);
+    // The size the server gives for url, or -1 when it doesn't say or can't be reached
+    virtual int64_t content_length(const QUrl& url);
     virtual void abort_all_downloads();
 
 protected:
@@ -49,6 +62,7 @@ protected:
 private:
     URLDownloader(const URLDownloader&) = delete;
     URLDownloader& operator=(const URLDownloader&) = delete;
+    QByteArray download_validating_copy(const QUrl& url, bool* not_modified);
 
     const Path cache_dir_path;
     std::chrono::milliseconds timeout;
@@ -20,6 +20,7 @@
 
 #include <multipass/days.h>
 #include <multipass/fetch_type.h>
+#include <multipass/memory_size.h>
 #include <multipass/path.h>
 #include <multipass/virtual_machine.h>
 #include <multipass/vm_image.h>
@@ -59,7 +60,8 @@ public:
     virtual QString get_backend_version_string() = 0;
     virtual VMImageVault::UPtr create_image_vault(std::vector<VMImageHost*> image_hosts, URLDownloader* downloader,
                                                   const Path& cache_dir_path, const Path& data_dir_path,
-                                                  const days& days_to_expire) = 0;
+                                                  const days& days_to_expire,
+                                                  const MemorySize& cache_size_budget) = 0;
 
 protected:
     VirtualMachineFactory() = default;
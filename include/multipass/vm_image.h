@@ -35,6 +35,7 @@ public:
     std::string current_release;
     std::string release_date;
     std::vector<std::string> aliases;
+    Path backing_image_path; // set when image_path is an overlay on top of this one
 };
 }
 #endif // MULTIPASS_VIRTUAL_MACHINE_IMAGE_H
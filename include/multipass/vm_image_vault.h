@@ -21,8 +21,12 @@
 #include <multipass/fetch_type.h>
 #include <multipass/progress_monitor.h>
 
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace multipass
 {
@@ -35,6 +39,24 @@ public:
     using UPtr = std::unique_ptr<VMImageVault>;
     using PrepareAction = std::function<VMImage(const VMImage&)>;
 
+    struct CachedImage
+    {
+        std::string id;
+        std::string release;
+        std::string remote_name;
+        int64_t size;
+        std::chrono::system_clock::time_point last_accessed;
+        bool persistent;
+        bool in_use; // instances are based on it
+    };
+
+    struct CacheUsage
+    {
+        int64_t total_size{0};
+        int64_t budget{0}; // 0 when the cache has no size limit
+        std::vector<CachedImage> images;
+    };
+
     virtual ~VMImageVault() = default;
     virtual VMImage fetch_image(const FetchType& fetch_type, const Query& query, const PrepareAction& prepare,
                                 const ProgressMonitor& monitor) = 0;
@@ -43,6 +65,11 @@ public:
     virtual void prune_expired_images() = 0;
     virtual void update_images(const FetchType& fetch_type, const PrepareAction& prepare,
                                const ProgressMonitor& monitor) = 0;
+    virtual CacheUsage cache_usage() = 0;
+    // Gets the image that the query currently stands for ready ahead of any launch, unless it already is. It is
+    // downloaded at no more than bytes_per_second, when that is positive, and prepared with what the disk has to spare.
+    virtual void prefetch_image(const FetchType& fetch_type, const Query& query, const PrepareAction& prepare,
+                                const ProgressMonitor& monitor, int64_t bytes_per_second) = 0;
 
 protected:
     VMImageVault() = default;
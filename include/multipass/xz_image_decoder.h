@@ -21,14 +21,23 @@
 #include <multipass/path.h>
 #include <multipass/progress_monitor.h>
 
+#include <cstdint>
 #include <memory>
+#include <vector>
 
+#include <QByteArray>
 #include <QFile>
 
 #include <xz.h>
 
 namespace multipass
 {
+/*
+ * XzImageDecoder - decodes xz compressed images
+ *
+ * Images compressed in several blocks, as multi-threaded xz does, have their blocks decoded in parallel. Runs of
+ * zeros in the decoded image are left as holes in the file, rather than written.
+ */
 class XzImageDecoder
 {
 public:
@@ -38,9 +47,29 @@ public:
 
     using XzDecoderUPtr = std::unique_ptr<xz_dec, decltype(xz_dec_end)*>;
 
+    // Decodes an xz stream as it comes in, e.g. straight off the network, so that it needn't be stored first
+    class StreamDecoder
+    {
+    public:
+        StreamDecoder(const Path& decoded_file_path);
+        // Writes what is decoded from offset on, into a file that is already there
+        StreamDecoder(const Path& decoded_file_path, qint64 offset);
+
+        void decode(const QByteArray& data);
+        void finish(); // throws if the stream was cut short
+
+    private:
+        StreamDecoder(const Path& decoded_file_path, qint64 offset, QIODevice::OpenMode mode);
+        void write(size_t size);
+
+        QFile decoded_file;
+        XzDecoderUPtr xz_decoder;
+        std::vector<uint8_t> write_data;
+        bool stream_ended{false};
+    };
+
 private:
     QFile xz_file;
-    XzDecoderUPtr xz_decoder;
 };
 } // namespace multipass
 #endif // MULTIPASS_XZ_IMAGE_DECODER_H
@@ -58,6 +58,9 @@ mp::ReturnCode cmd::Launch::run(mp::ArgParser* parser)
 
     request.set_time_zone(QTimeZone::systemTimeZoneId().toStdString());
 
+    if (count > 1)
+        return request_launch_many();
+
     auto ret = request_launch();
     if (ret == ReturnCode::Ok && request.instance_name() == petenv_name.toStdString())
     {
@@ -126,7 +129,16 @@ mp::ParseCode cmd::Launch::parse_args(mp::ArgParser* parser)
         "name");
     QCommandLineOption cloudInitOption("cloud-init", "Path to a user-data cloud-init configuration, or '-' for stdin",
                                        "file");
-    parser->addOptions({cpusOption, diskOption, memOption, nameOption, cloudInitOption});
+    QCommandLineOption countOption("count",
+                                   "Number of instances to launch, default: 1. When launching several, the name "
+                                   "given with --name is used as a prefix, followed by \"-1\", \"-2\" and so on.",
+                                   "count", "1");
+    QCommandLineOption maxParallelOption("max-parallel",
+                                         "Maximum number of instances to prepare and boot at once, when launching "
+                                         "several. Defaults to the number of CPUs.",
+                                         "max-parallel");
+    parser->addOptions(
+        {cpusOption, diskOption, memOption, nameOption, cloudInitOption, countOption, maxParallelOption});
 
     auto status = parser->commandParse(this);
 
@@ -181,6 +193,29 @@ mp::ParseCode cmd::Launch::parse_args(mp::ArgParser* parser)
         request.set_num_cores(parser->value(cpusOption).toInt());
     }
 
+    if (parser->isSet(countOption))
+    {
+        bool ok;
+        count = parser->value(countOption).toUInt(&ok);
+        if (!ok || count == 0)
+        {
+            cerr << "error: Invalid instance count: " << parser->value(countOption).toStdString() << "\n";
+            return ParseCode::CommandLineError;
+        }
+    }
+
+    if (parser->isSet(maxParallelOption))
+    {
+        bool ok;
+        max_parallel = parser->value(maxParallelOption).toUInt(&ok);
+        if (!ok || max_parallel == 0)
+        {
+            cerr << "error: Invalid maximum of parallel launches: " << parser->value(maxParallelOption).toStdString()
+                 << "\n";
+            return ParseCode::CommandLineError;
+        }
+    }
+
     if (parser->isSet(memOption))
     {
         request.set_mem_size(parser->value(memOption).toStdString());
@@ -297,65 +332,112 @@ mp::ReturnCode cmd::Launch::request_launch()
 
     auto on_failure = [this, &spinner](grpc::Status& status) {
         spinner.stop();
+        return launch_failure_handler(status);
+    };
 
-        LaunchError launch_error;
-        launch_error.ParseFromString(status.error_details());
-        std::string error_details;
+    auto streaming_callback = [this, &spinner](mp::LaunchReply& reply) { show_progress(reply, spinner); };
 
-        for (const auto& error : launch_error.error_codes())
-        {
-            if (error == LaunchError::INVALID_DISK_SIZE)
-            {
-                error_details = fmt::format("Invalid disk size value supplied: {}.", request.disk_space());
-            }
-            else if (error == LaunchError::INVALID_MEM_SIZE)
-            {
-                error_details = fmt::format("Invalid memory size value supplied: {}.", request.mem_size());
-            }
-            else if (error == LaunchError::INVALID_HOSTNAME)
-            {
-                error_details = fmt::format("Invalid instance name supplied: {}", request.instance_name());
-            }
-        }
+    return dispatch(&RpcMethod::launch, request, on_success, on_failure, streaming_callback);
+}
+
+mp::ReturnCode cmd::Launch::request_launch_many()
+{
+    mp::AnimatedSpinner spinner{cout};
+
+    LaunchManyRequest many_request;
+    *many_request.mutable_launch() = request;
+    many_request.set_count(count);
+    many_request.set_max_parallel(max_parallel);
+    many_request.set_verbosity_level(request.verbosity_level());
 
-        return standard_failure_handler_for(name(), cerr, status, error_details);
+    auto on_success = [this, &spinner](mp::LaunchReply& reply) {
+        spinner.stop();
+
+        if (term->is_live() && update_available(reply.update_info()))
+            cout << update_notice(reply.update_info());
+
+        return ReturnCode::Ok;
+    };
+
+    auto on_failure = [this, &spinner](grpc::Status& status) {
+        spinner.stop();
+        return launch_failure_handler(status);
     };
 
+    // Instances come up one by one, each reported as soon as it is ready
     auto streaming_callback = [this, &spinner](mp::LaunchReply& reply) {
-        std::unordered_map<int, std::string> progress_messages{
-            {LaunchProgress_ProgressTypes_IMAGE, "Retrieving image: "},
-            {LaunchProgress_ProgressTypes_KERNEL, "Retrieving kernel image: "},
-            {LaunchProgress_ProgressTypes_INITRD, "Retrieving initrd image: "},
-            {LaunchProgress_ProgressTypes_EXTRACT, "Extracting image: "},
-            {LaunchProgress_ProgressTypes_VERIFY, "Verifying image: "},
-            {LaunchProgress_ProgressTypes_WAITING, "Preparing image: "}};
-
-        if (reply.create_oneof_case() == mp::LaunchReply::CreateOneofCase::kLaunchProgress)
+        if (reply.create_oneof_case() == mp::LaunchReply::CreateOneofCase::kVmInstanceName)
         {
-            auto& progress_message = progress_messages[reply.launch_progress().type()];
-            if (reply.launch_progress().percent_complete() != "-1")
-            {
-                spinner.stop();
-                cout << "\r";
-                cout << progress_message << reply.launch_progress().percent_complete() << "%" << std::flush;
-            }
-            else
-            {
-                spinner.stop();
-                spinner.start(progress_message);
-            }
+            spinner.stop();
+            cout << "Launched: " << reply.vm_instance_name() << "\n";
+        }
+        else
+        {
+            show_progress(reply, spinner);
+        }
+    };
+
+    return dispatch(&RpcMethod::launch_many, many_request, on_success, on_failure, streaming_callback);
+}
+
+mp::ReturnCode cmd::Launch::launch_failure_handler(grpc::Status& status)
+{
+    LaunchError launch_error;
+    launch_error.ParseFromString(status.error_details());
+    std::string error_details;
+
+    for (const auto& error : launch_error.error_codes())
+    {
+        if (error == LaunchError::INVALID_DISK_SIZE)
+        {
+            error_details = fmt::format("Invalid disk size value supplied: {}.", request.disk_space());
+        }
+        else if (error == LaunchError::INVALID_MEM_SIZE)
+        {
+            error_details = fmt::format("Invalid memory size value supplied: {}.", request.mem_size());
         }
-        else if (reply.create_oneof_case() == mp::LaunchReply::CreateOneofCase::kCreateMessage)
+        else if (error == LaunchError::INVALID_HOSTNAME)
+        {
+            error_details = fmt::format("Invalid instance name supplied: {}", request.instance_name());
+        }
+    }
+
+    return standard_failure_handler_for(name(), cerr, status, error_details);
+}
+
+void cmd::Launch::show_progress(const LaunchReply& reply, AnimatedSpinner& spinner)
+{
+    std::unordered_map<int, std::string> progress_messages{
+        {LaunchProgress_ProgressTypes_IMAGE, "Retrieving image: "},
+        {LaunchProgress_ProgressTypes_KERNEL, "Retrieving kernel image: "},
+        {LaunchProgress_ProgressTypes_INITRD, "Retrieving initrd image: "},
+        {LaunchProgress_ProgressTypes_EXTRACT, "Extracting image: "},
+        {LaunchProgress_ProgressTypes_VERIFY, "Verifying image: "},
+        {LaunchProgress_ProgressTypes_WAITING, "Preparing image: "}};
+
+    if (reply.create_oneof_case() == mp::LaunchReply::CreateOneofCase::kLaunchProgress)
+    {
+        auto& progress_message = progress_messages[reply.launch_progress().type()];
+        if (reply.launch_progress().percent_complete() != "-1")
         {
             spinner.stop();
-            spinner.start(reply.create_message());
+            cout << "\r";
+            cout << progress_message << reply.launch_progress().percent_complete() << "%" << std::flush;
         }
-        else if (!reply.reply_message().empty())
+        else
         {
             spinner.stop();
-            spinner.start(reply.reply_message());
+            spinner.start(progress_message);
         }
-    };
-
-    return dispatch(&RpcMethod::launch, request, on_success, on_failure, streaming_callback);
+    }
+    else if (reply.create_oneof_case() == mp::LaunchReply::CreateOneofCase::kCreateMessage)
+    {
+        spinner.stop();
+        spinner.start(reply.create_message());
+    }
+    else if (!reply.reply_message().empty())
+    {
+        spinner.stop();
+        spinner.start(reply.reply_message());
+    }
 }
@@ -24,6 +24,8 @@
 
 namespace multipass
 {
+class AnimatedSpinner;
+
 namespace cmd
 {
 class Launch final : public Command
@@ -39,9 +41,14 @@ public:
 private:
     ParseCode parse_args(ArgParser* parser) override;
     ReturnCode request_launch();
+    ReturnCode request_launch_many();
+    ReturnCode launch_failure_handler(grpc::Status& status);
+    void show_progress(const LaunchReply& reply, AnimatedSpinner& spinner);
 
     LaunchRequest request;
     QString petenv_name;
+    unsigned int count{1};
+    unsigned int max_parallel{0};
 };
 } // namespace cmd
 } // namespace multipass
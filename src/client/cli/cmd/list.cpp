@@ -25,6 +25,11 @@ namespace mp = multipass;
 namespace cmd = multipass::cmd;
 using RpcMethod = mp::Rpc::Stub;
 
+namespace
+{
+constexpr auto list_page_size = 100u;
+} // namespace
+
 mp::ReturnCode cmd::List::run(mp::ArgParser* parser)
 {
     auto ret = parse_args(parser);
@@ -33,11 +38,19 @@ mp::ReturnCode cmd::List::run(mp::ArgParser* parser)
         return parser->returnCodeFrom(ret);
     }
 
-    auto on_success = [this](ListReply& reply) {
-        cout << chosen_formatter->format(reply);
+    // The instances arrive in pages, so gather them all before formatting
+    ListReply instances;
+    auto streaming_callback = [&instances](ListReply& reply) {
+        instances.mutable_instances()->MergeFrom(reply.instances());
+        if (reply.has_update_info())
+            *instances.mutable_update_info() = reply.update_info();
+    };
+
+    auto on_success = [this, &instances](ListReply&) {
+        cout << chosen_formatter->format(instances);
 
-        if (term->is_live() && update_available(reply.update_info()))
-            cout << update_notice(reply.update_info());
+        if (term->is_live() && update_available(instances.update_info()))
+            cout << update_notice(instances.update_info());
 
         return ReturnCode::Ok;
     };
@@ -46,7 +59,8 @@ mp::ReturnCode cmd::List::run(mp::ArgParser* parser)
 
     ListRequest request;
     request.set_verbosity_level(parser->verbosityLevel());
-    return dispatch(&RpcMethod::list, request, on_success, on_failure);
+    request.set_page_size(list_page_size);
+    return dispatch(&RpcMethod::list, request, on_success, on_failure, streaming_callback);
 }
 
 std::string cmd::List::name() const
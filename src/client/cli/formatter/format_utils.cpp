@@ -78,6 +78,9 @@ std::string mp::format::status_string_for(const mp::InstanceStatus& status)
     case mp::InstanceStatus::SUSPENDED:
         status_val = "Suspended";
         break;
+    case mp::InstanceStatus::RESTORING:
+        status_val = "Restoring";
+        break;
     default:
         status_val = "Unknown";
         break;
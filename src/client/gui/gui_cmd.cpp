@@ -38,6 +38,8 @@ using namespace std::chrono_literals;
 
 namespace
 {
+constexpr auto watch_retry_delay = 1s;
+
 auto set_title_string_for(const std::string& text, const mp::InstanceStatus& state)
 {
     return QString::fromStdString(fmt::format("{}{}", text,
@@ -83,6 +85,7 @@ void set_input_state_for(QList<QAction*> actions, const mp::InstanceStatus& stat
         break;
     case mp::InstanceStatus::DELETED:
     case mp::InstanceStatus::SUSPENDING:
+    case mp::InstanceStatus::RESTORING:
         actions[ActionType::start]->setEnabled(false);
         actions[ActionType::open_shell]->setEnabled(false);
         actions[ActionType::stop]->setEnabled(false);
@@ -142,6 +145,7 @@ void cmd::GuiCmd::create_actions()
     QObject::connect(&config_watcher, &QFileSystemWatcher::fileChanged, this, [this](const QString& path) {
         update_hotkey();
         autostart_option.setChecked(MP_SETTINGS.get_as<bool>(autostart_key));
+        update_menu(); // the primary instance may have changed
 
         // Needed since the original watched file may be removed and opened as a new file
         if (!config_watcher.files().contains(path) && QFile::exists(path))
@@ -171,16 +175,14 @@ void cmd::GuiCmd::update_menu()
 {
     std::vector<std::string> instances_to_remove;
 
-    auto reply = list_future.result();
-
-    handle_petenv_instance(reply.instances());
+    handle_petenv_instance(instances);
 
     for (auto it = instances_entries.cbegin(); it != instances_entries.cend(); ++it)
     {
-        auto instance = std::find_if(reply.instances().cbegin(), reply.instances().cend(),
+        auto instance = std::find_if(instances.cbegin(), instances.cend(),
                                      [it](const ListVMInstance& instance) { return it->first == instance.name(); });
 
-        if (instance == reply.instances().cend())
+        if (instance == instances.cend())
         {
             instances_to_remove.push_back(it->first);
         }
@@ -191,7 +193,7 @@ void cmd::GuiCmd::update_menu()
         instances_entries.erase(instance);
     }
 
-    for (const auto& instance : reply.instances())
+    for (const auto& instance : instances)
     {
         auto name = instance.name();
         auto state = instance.instance_status();
@@ -270,12 +272,21 @@ void cmd::GuiCmd::create_menu()
 
     tray_icon.setIcon(QIcon{":images/multipass-icon.png"});
 
-    QObject::connect(&list_watcher, &QFutureWatcher<ListReply>::finished, this, &GuiCmd::update_menu);
-
-    QObject::connect(&menu_update_timer, &QTimer::timeout, this, [this] { initiate_menu_layout(); });
+    // Replies arrive on the watching thread, so these are queued onto the main thread
+    QObject::connect(this, &GuiCmd::watch_replies_pending, this, &GuiCmd::apply_watch_replies);
+    QObject::connect(this, &GuiCmd::watch_failed, this,
+                     [this] { tray_icon_menu.insertAction(about_separator, &failure_action); });
 
     // Use a singleShot here to make sure the event loop is running before the quit() runs
     QObject::connect(quit_action, &QAction::triggered, [this] {
+        {
+            std::lock_guard<decltype(watch_mutex)> lock{watch_mutex};
+            quitting = true;
+            if (watch_context)
+                watch_context->TryCancel();
+        }
+        watch_retry_cv.notify_all();
+
         future_synchronizer.waitForFinished();
         QTimer::singleShot(0, [] { QCoreApplication::quit(); });
     });
@@ -304,23 +315,12 @@ void cmd::GuiCmd::create_menu()
     initiate_menu_layout();
     initiate_about_menu_layout();
 
-    menu_update_timer.start(1s);
     about_update_timer.start(24h);
 }
 
 void cmd::GuiCmd::initiate_menu_layout()
 {
-    if (failure_action.isVisible())
-    {
-        tray_icon_menu.removeAction(&failure_action);
-    }
-
-    if (!list_future.isRunning())
-    {
-        list_future = QtConcurrent::run(this, &GuiCmd::retrieve_all_instances);
-        future_synchronizer.addFuture(list_future);
-        list_watcher.setFuture(list_future);
-    }
+    future_synchronizer.addFuture(QtConcurrent::run(this, &GuiCmd::watch_instances));
 }
 
 void cmd::GuiCmd::initiate_about_menu_layout()
@@ -333,25 +333,91 @@ void cmd::GuiCmd::initiate_about_menu_layout()
     }
 }
 
-mp::ListReply cmd::GuiCmd::retrieve_all_instances()
+// Runs for the lifetime of the GUI, reconnecting whenever the daemon goes away
+void cmd::GuiCmd::watch_instances()
 {
-    ListReply list_reply;
-    auto on_success = [&list_reply](ListReply& reply) {
-        list_reply = reply;
+    WatchRequest request;
 
-        return ReturnCode::Ok;
-    };
+    while (true)
+    {
+        grpc::ClientContext context;
+        {
+            std::lock_guard<decltype(watch_mutex)> lock{watch_mutex};
+            if (quitting)
+                return;
+
+            watch_context = &context;
+        }
 
-    auto on_failure = [this](grpc::Status& status) {
-        tray_icon_menu.insertAction(about_separator, &failure_action);
+        auto reader = stub->watch(&context, request);
 
-        return standard_failure_handler_for(name(), cerr, status);
-    };
+        WatchReply reply;
+        while (reader->Read(&reply))
+        {
+            std::lock_guard<decltype(watch_mutex)> lock{watch_mutex};
+            pending_watch_replies.push_back(reply);
+
+            // Replies that come in before the main thread gets to them are applied together
+            if (pending_watch_replies.size() == 1)
+                emit watch_replies_pending();
+        }
+
+        auto status = reader->Finish();
 
-    ListRequest request;
-    dispatch(&RpcMethod::list, request, on_success, on_failure);
+        std::unique_lock<decltype(watch_mutex)> lock{watch_mutex};
+        watch_context = nullptr;
+        if (quitting)
+            return;
+
+        if (!status.ok())
+            standard_failure_handler_for(name(), cerr, status);
+        emit watch_failed();
+
+        watch_retry_cv.wait_for(lock, watch_retry_delay, [this] { return quitting; });
+    }
+}
+
+void cmd::GuiCmd::apply_watch_replies()
+{
+    std::vector<WatchReply> replies;
+    {
+        std::lock_guard<decltype(watch_mutex)> lock{watch_mutex};
+        replies.swap(pending_watch_replies);
+    }
+
+    if (failure_action.isVisible())
+    {
+        tray_icon_menu.removeAction(&failure_action);
+    }
+
+    for (const auto& reply : replies)
+    {
+        if (reply.snapshot())
+            instances.Clear();
+
+        for (const auto& instance : reply.instances())
+        {
+            auto it = std::find_if(instances.begin(), instances.end(), [&instance](const ListVMInstance& known) {
+                return known.name() == instance.name();
+            });
+
+            if (it != instances.end())
+                *it = instance;
+            else
+                *instances.Add() = instance;
+        }
+
+        for (const auto& removed : reply.removed_instances())
+        {
+            auto it = std::find_if(instances.begin(), instances.end(),
+                                   [&removed](const ListVMInstance& known) { return known.name() == removed; });
+
+            if (it != instances.end())
+                instances.erase(it);
+        }
+    }
 
-    return list_reply;
+    update_menu();
 }
 
 void cmd::GuiCmd::create_menu_actions_for(const std::string& instance_name, const mp::InstanceStatus& state)
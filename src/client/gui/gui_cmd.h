@@ -30,7 +30,9 @@
 
 #include <QHotkey>
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
@@ -62,6 +64,10 @@ public:
         return "";
     };
 
+signals:
+    void watch_replies_pending();
+    void watch_failed();
+
 private:
     ParseCode parse_args(ArgParser* parser) override
     {
@@ -74,7 +80,8 @@ private:
     void update_about_menu();
     void initiate_menu_layout();
     void initiate_about_menu_layout();
-    ListReply retrieve_all_instances();
+    void watch_instances();
+    void apply_watch_replies();
     void create_menu_actions_for(const std::string& instance_name, const InstanceStatus& state);
     void handle_petenv_instance(const google::protobuf::RepeatedPtrField<ListVMInstance>&);
     void start_instance_for(const std::string& instance_name);
@@ -111,8 +118,15 @@ private:
     };
     std::unordered_map<std::string, InstanceEntry> instances_entries;
 
-    QFuture<ListReply> list_future;
-    QFutureWatcher<ListReply> list_watcher;
+    // Latest state of all instances, as pushed by the daemon
+    google::protobuf::RepeatedPtrField<ListVMInstance> instances;
+
+    // Shared with the thread watching the daemon
+    std::mutex watch_mutex;
+    std::condition_variable watch_retry_cv;
+    std::vector<WatchReply> pending_watch_replies;
+    grpc::ClientContext* watch_context{nullptr};
+    bool quitting{false};
 
     QFuture<VersionReply> version_future;
     QFutureWatcher<VersionReply> version_watcher;
@@ -121,7 +135,6 @@ private:
 
     QFileSystemWatcher config_watcher;
 
-    QTimer menu_update_timer;
     QTimer about_update_timer;
 
     QHotkey hotkey;
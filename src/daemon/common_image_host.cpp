@@ -21,6 +21,8 @@
 
 #include <multipass/format.h>
 
+#include <QtConcurrent/QtConcurrent>
+
 namespace mp = multipass;
 namespace mpl = multipass::logging;
 
@@ -32,17 +34,11 @@ constexpr auto category = "VMImageHost";
 mp::CommonVMImageHost::CommonVMImageHost(std::chrono::seconds manifest_time_to_live)
   : manifest_time_to_live{manifest_time_to_live}, last_update{}
 {
-    // careful: the functor below relies on polymorphic behavior, which is not available in constructors
+    // careful: the update relies on polymorphic behavior, which is not available in constructors
     // fine here as the call is deferred to after the constructor is done (independently of connection type)
     QObject::connect(&manifest_single_shot, &QTimer::timeout, [this]() {
-        try
-        {
-            update_manifests();
-        }
-        catch (const std::exception& e)
-        {
-            mpl::log(mpl::Level::error, category, e.what());
-        }
+        std::lock_guard<decltype(update_mutex)> lock{update_mutex};
+        start_manifest_update();
     });
 
     manifest_single_shot.setSingleShot(true);
@@ -63,18 +59,71 @@ auto mp::CommonVMImageHost::info_for_full_hash(const std::string& full_hash) ->
     return info_for_full_hash_impl(full_hash);
 }
 
+void mp::CommonVMImageHost::wait_for_manifest_update()
+{
+    std::unique_lock<decltype(update_mutex)> lock{update_mutex};
+    auto update = manifest_update;
+    lock.unlock();
+
+    update.waitForFinished();
+}
+
 void mp::CommonVMImageHost::update_manifests()
 {
+    std::unique_lock<decltype(update_mutex)> lock{update_mutex};
+
+    // Until manifests have been fetched, there is nothing to serve while fetching them
+    if (!fetched_once)
+    {
+        auto update = manifest_update;
+        lock.unlock();
+        update.waitForFinished();
+        lock.lock();
+
+        if (!fetched_once)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            fetched_once = fetch();
+            last_update = now;
+        }
+
+        return;
+    }
+
     const auto now = std::chrono::steady_clock::now();
     if ((now - last_update) > manifest_time_to_live || need_extra_update)
-    {
-        need_extra_update = false;
+        start_manifest_update();
+}
+
+void mp::CommonVMImageHost::start_manifest_update()
+{
+    if (manifest_update.isRunning())
+        return;
 
-        clear();
-        fetch_manifests();
+    manifest_update = QtConcurrent::run([this] {
+        const auto now = std::chrono::steady_clock::now();
+        bool fetched{false};
+        try
+        {
+            fetched = fetch();
+        }
+        catch (const std::exception& e)
+        {
+            need_extra_update = true;
+            mpl::log(mpl::Level::error, category, e.what());
+        }
 
+        std::lock_guard<decltype(update_mutex)> lock{update_mutex};
+        fetched_once = fetched_once || fetched;
         last_update = now;
-    }
+    });
+}
+
+bool mp::CommonVMImageHost::fetch()
+{
+    need_extra_update = false;
+
+    return fetch_manifests();
 }
 
 void mp::CommonVMImageHost::on_manifest_empty(const std::string& details)
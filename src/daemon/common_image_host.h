@@ -20,9 +20,12 @@
 
 #include "multipass/vm_image_host.h"
 
+#include <QFuture>
 #include <QTimer>
 
+#include <atomic>
 #include <chrono>
+#include <mutex>
 
 namespace multipass
 {
@@ -33,21 +36,34 @@ public:
     CommonVMImageHost(std::chrono::seconds manifest_time_to_live);
     void for_each_entry_do(const Action& action) final;
     VMImageInfo info_for_full_hash(const std::string& full_hash) final;
+    // Waits for manifests that are being updated in the background, if any. Derived classes need to call this when
+    // destroyed, before the update can find them gone.
+    void wait_for_manifest_update();
 
 protected:
+    // Once any manifest has been fetched, expired ones keep being served while they are updated in the background,
+    // along with retrying the remotes that could not be reached
     void update_manifests();
     void on_manifest_update_failure(const std::string& details);
     void on_manifest_empty(const std::string& details);
 
     virtual void for_each_entry_do_impl(const Action& action) = 0;
     virtual VMImageInfo info_for_full_hash_impl(const std::string& full_hash) = 0;
-    virtual void clear() = 0;
-    virtual void fetch_manifests() = 0;
+    // Fetches the manifests anew and then swaps them in at once, keeping the current manifest of a remote that could
+    // not be updated. May run on another thread while the current manifests are being read. Returns whether there is
+    // any manifest to serve, even if some remotes could not be reached.
+    virtual bool fetch_manifests() = 0;
 
 private:
+    void start_manifest_update();
+    bool fetch();
+
     std::chrono::seconds manifest_time_to_live;
     std::chrono::steady_clock::time_point last_update;
-    bool need_extra_update = true;
+    std::atomic_bool need_extra_update{true};
+    bool fetched_once{false};
+    std::mutex update_mutex;
+    QFuture<void> manifest_update;
     QTimer manifest_single_shot;
 };
 
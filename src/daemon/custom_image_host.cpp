@@ -184,6 +184,11 @@ mp::CustomVMImageHost::CustomVMImageHost(URLDownloader* downloader, std::chrono:
 {
 }
 
+mp::CustomVMImageHost::~CustomVMImageHost()
+{
+    wait_for_manifest_update();
+}
+
 mp::optional<mp::VMImageInfo> mp::CustomVMImageHost::info_for(const Query& query)
 {
     auto custom_manifest = manifest_from(query.remote_name);
@@ -228,7 +233,7 @@ std::vector<mp::VMImageInfo> mp::CustomVMImageHost::all_images_for(const std::st
 
 void mp::CustomVMImageHost::for_each_entry_do_impl(const Action& action)
 {
-    for (const auto& manifest : custom_image_info)
+    for (const auto& manifest : current_manifests())
     {
         for (const auto& info : manifest.second->products)
         {
@@ -242,34 +247,44 @@ std::vector<std::string> mp::CustomVMImageHost::supported_remotes()
     return remotes;
 }
 
-void mp::CustomVMImageHost::fetch_manifests()
+bool mp::CustomVMImageHost::fetch_manifests()
 {
+    auto fetched = current_manifests();
     for (const auto& spec :
          {std::make_pair(no_remote, multipass_image_info), std::make_pair(snapcraft_remote, snapcraft_image_info)})
     {
         try
         {
-            custom_image_info.emplace(spec.first, full_image_info_for(spec.second, url_downloader, path_prefix));
+            fetched[spec.first] = full_image_info_for(spec.second, url_downloader, path_prefix);
         }
         catch (mp::DownloadException& e)
         {
             on_manifest_update_failure(e.what());
         }
     }
+
+    const auto available = !fetched.empty();
+
+    std::lock_guard<decltype(manifests_mutex)> lock{manifests_mutex};
+    custom_image_info = std::move(fetched);
+
+    return available;
 }
 
-void mp::CustomVMImageHost::clear()
+auto mp::CustomVMImageHost::current_manifests() -> Manifests
 {
-    custom_image_info.clear();
+    std::lock_guard<decltype(manifests_mutex)> lock{manifests_mutex};
+    return custom_image_info;
 }
 
-mp::CustomManifest* mp::CustomVMImageHost::manifest_from(const std::string& remote_name)
+std::shared_ptr<mp::CustomManifest> mp::CustomVMImageHost::manifest_from(const std::string& remote_name)
 {
     update_manifests();
 
+    std::lock_guard<decltype(manifests_mutex)> lock{manifests_mutex};
     auto it = custom_image_info.find(remote_name);
     if (it == custom_image_info.end())
         throw std::runtime_error(fmt::format("Remote \"{}\" is unknown or unreachable.", remote_name));
 
-    return it->second.get();
+    return it->second;
 }
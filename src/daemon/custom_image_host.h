@@ -23,6 +23,7 @@
 #include <QString>
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -43,6 +44,7 @@ public:
     CustomVMImageHost(URLDownloader* downloader, std::chrono::seconds manifest_time_to_live);
     // For testing
     CustomVMImageHost(URLDownloader* downloader, std::chrono::seconds manifest_time_to_live, const QString& path_prefix);
+    ~CustomVMImageHost() override;
 
     optional<VMImageInfo> info_for(const Query& query) override;
     std::vector<VMImageInfo> all_info_for(const Query& query) override;
@@ -52,15 +54,19 @@ public:
 protected:
     void for_each_entry_do_impl(const Action& action) override;
     VMImageInfo info_for_full_hash_impl(const std::string& full_hash) override;
-    void fetch_manifests() override;
-    void clear() override;
+    bool fetch_manifests() override;
 
 private:
-    CustomManifest* manifest_from(const std::string& remote_name);
+    // Readers hold on to the manifests they got, which updates swap for new ones instead of changing them
+    using Manifests = std::unordered_map<std::string, std::shared_ptr<CustomManifest>>;
+
+    Manifests current_manifests();
+    std::shared_ptr<CustomManifest> manifest_from(const std::string& remote_name);
 
     URLDownloader* const url_downloader;
     const QString path_prefix;
-    std::unordered_map<std::string, std::unique_ptr<CustomManifest>> custom_image_info;
+    Manifests custom_image_info;
+    std::mutex manifests_mutex;
     std::vector<std::string> remotes;
 };
 } // namespace multipass
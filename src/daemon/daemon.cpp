@@ -18,6 +18,7 @@
 #include "daemon.h"
 #include "base_cloud_init_config.h"
 #include "json_writer.h"
+#include "lazy_virtual_machine.h"
 
 #include <multipass/cloud_init_iso.h>
 #include <multipass/constants.h>
@@ -32,6 +33,7 @@
 #include <multipass/platform.h>
 #include <multipass/process/qemuimg_process_spec.h>
 #include <multipass/query.h>
+#include <multipass/settings.h>
 #include <multipass/ssh/ssh_session.h>
 #include <multipass/utils.h>
 #include <multipass/version.h>
@@ -43,6 +45,7 @@
 #include <multipass/vm_image_vault.h>
 
 #include <multipass/format.h>
+#include <scope_guard.hpp>
 #include <yaml-cpp/yaml.h>
 
 #include <QDir>
@@ -56,6 +59,7 @@
 #include <QtConcurrent/QtConcurrent>
 
 #include <cassert>
+#include <deque>
 #include <functional>
 #include <stdexcept>
 #include <utility>
@@ -76,9 +80,13 @@ constexpr auto instance_db_name = "multipassd-vm-instances.json";
 constexpr auto uuid_file_name = "multipass-unique-id";
 constexpr auto metrics_opt_in_file = "multipassd-send-metrics.yaml";
 constexpr auto reboot_cmd = "sudo reboot";
+constexpr auto max_instance_waits = 100; // Each instance being waited on holds a thread while it boots
+constexpr auto persist_instances_delay = 100ms;
 constexpr auto up_timeout = 2min; // This may be tweaked as appropriate and used in places that wait for ssh to be up
 constexpr auto cloud_init_timeout = 5min;
 constexpr auto stop_ssh_cmd = "sudo systemctl stop ssh";
+constexpr auto hostname_lookup_timeout = 1s; // Asked on the main thread, where a running instance answers at once
+constexpr auto telemetry_probe_timeout = 10s;
 const std::string sshfs_error_template = "Error enabling mount support in '{}'"
                                          "\n\nPlease install the 'multipass-sshfs' snap manually inside the instance.";
 
@@ -287,6 +295,13 @@ auto fetch_image_for(const std::string& name, const mp::FetchType& fetch_type, m
     return vault.fetch_image(fetch_type, query, stub_prepare, stub_progress);
 }
 
+// Instances that are neither running nor about to be don't need their backend's machine until they are started
+bool is_dormant(const mp::VMSpecs& spec)
+{
+    using State = mp::VirtualMachine::State;
+    return spec.deleted || spec.state == State::off || spec.state == State::stopped || spec.state == State::suspended;
+}
+
 auto try_mem_size(const std::string& val) -> mp::optional<mp::MemorySize>
 {
     try
@@ -435,20 +450,27 @@ auto connect_rpc(mp::DaemonRpc& rpc, mp::Daemon& daemon)
 {
     QObject::connect(&rpc, &mp::DaemonRpc::on_create, &daemon, &mp::Daemon::create);
     QObject::connect(&rpc, &mp::DaemonRpc::on_launch, &daemon, &mp::Daemon::launch);
+    QObject::connect(&rpc, &mp::DaemonRpc::on_launch_many, &daemon, &mp::Daemon::launch_many);
     QObject::connect(&rpc, &mp::DaemonRpc::on_purge, &daemon, &mp::Daemon::purge);
     QObject::connect(&rpc, &mp::DaemonRpc::on_find, &daemon, &mp::Daemon::find);
-    QObject::connect(&rpc, &mp::DaemonRpc::on_info, &daemon, &mp::Daemon::info);
-    QObject::connect(&rpc, &mp::DaemonRpc::on_list, &daemon, &mp::Daemon::list);
     QObject::connect(&rpc, &mp::DaemonRpc::on_mount, &daemon, &mp::Daemon::mount);
     QObject::connect(&rpc, &mp::DaemonRpc::on_recover, &daemon, &mp::Daemon::recover);
-    QObject::connect(&rpc, &mp::DaemonRpc::on_ssh_info, &daemon, &mp::Daemon::ssh_info);
     QObject::connect(&rpc, &mp::DaemonRpc::on_start, &daemon, &mp::Daemon::start);
     QObject::connect(&rpc, &mp::DaemonRpc::on_stop, &daemon, &mp::Daemon::stop);
     QObject::connect(&rpc, &mp::DaemonRpc::on_suspend, &daemon, &mp::Daemon::suspend);
     QObject::connect(&rpc, &mp::DaemonRpc::on_restart, &daemon, &mp::Daemon::restart);
     QObject::connect(&rpc, &mp::DaemonRpc::on_delete, &daemon, &mp::Daemon::delet);
     QObject::connect(&rpc, &mp::DaemonRpc::on_umount, &daemon, &mp::Daemon::umount);
-    QObject::connect(&rpc, &mp::DaemonRpc::on_version, &daemon, &mp::Daemon::version);
+    QObject::connect(&rpc, &mp::DaemonRpc::on_image_cache, &daemon, &mp::Daemon::image_cache);
+
+    // Handlers that only read plain data, such as snapshots of the instances, run directly on the gRPC thread that
+    // received the call instead of queueing behind whatever the main thread is busy with
+    QObject::connect(&rpc, &mp::DaemonRpc::on_info, &daemon, &mp::Daemon::info, Qt::DirectConnection);
+    QObject::connect(&rpc, &mp::DaemonRpc::on_list, &daemon, &mp::Daemon::list, Qt::DirectConnection);
+    QObject::connect(&rpc, &mp::DaemonRpc::on_ssh_info, &daemon, &mp::Daemon::ssh_info, Qt::DirectConnection);
+    QObject::connect(&rpc, &mp::DaemonRpc::on_version, &daemon, &mp::Daemon::version, Qt::DirectConnection);
+    QObject::connect(&rpc, &mp::DaemonRpc::on_watch, &daemon, &mp::Daemon::watch, Qt::DirectConnection);
+    QObject::connect(&rpc, &mp::DaemonRpc::on_unwatch, &daemon, &mp::Daemon::unwatch, Qt::DirectConnection);
 }
 
 template <typename Instances, typename InstanceMap, typename InstanceCheck>
@@ -541,11 +563,8 @@ grpc::Status stop_accepting_ssh_connections(mp::SSHSession& session)
                                      proc.read_std_error()};
 }
 
-grpc::Status ssh_reboot(const std::string& hostname, int port, const std::string& username,
-                        const mp::SSHKeyProvider& key_provider)
+grpc::Status ssh_reboot(mp::SSHSession& session)
 {
-    mp::SSHSession session{hostname, port, username, key_provider};
-
     // This allows us to later detect when the machine has finished restarting by waiting for SSH to be back up.
     // Otherwise, there would be a race condition, and we would be unable to distinguish whether it had ever been down.
     stop_accepting_ssh_connections(session);
@@ -666,6 +685,114 @@ mp::MemorySize compute_final_image_size(const mp::VMImage& image, mp::optional<m
     return disk_space;
 }
 
+std::vector<std::string> instance_names_of(const mp::InstanceNames& instance_names)
+{
+    return {instance_names.instance_name().begin(), instance_names.instance_name().end()};
+}
+
+std::vector<std::string>
+instance_names_of(const google::protobuf::RepeatedPtrField<mp::TargetPathInfo>& target_paths)
+{
+    std::vector<std::string> names;
+    for (const auto& path_entry : target_paths)
+        names.push_back(path_entry.instance_name());
+
+    return names;
+}
+
+void add_watched_instance(mp::WatchReply& reply, const std::string& name, mp::InstanceStatus::Status status)
+{
+    auto entry = reply.add_instances();
+    entry->set_name(name);
+    entry->mutable_instance_status()->set_status(status);
+}
+
+mp::WatchReply watch_reply_for(const std::string& name, mp::InstanceStatus::Status status)
+{
+    mp::WatchReply reply;
+    add_watched_instance(reply, name, status);
+
+    return reply;
+}
+
+std::string generate_unused_mac_address(std::unordered_set<std::string>& allocated_mac_addrs)
+{
+    while (true)
+    {
+        auto mac_addr = mp::utils::generate_mac_address();
+        if (allocated_mac_addrs.insert(mac_addr).second)
+            return mac_addr;
+    }
+}
+
+struct PreparedInstance
+{
+    std::string name;
+    mp::optional<mp::VirtualMachineDescription> vm_desc; // empty if preparing failed
+    std::string error;
+};
+
+// Fetches the image and builds the instance's disk and cloud-init configuration. Runs off the main thread.
+mp::VirtualMachineDescription prepare_instance(const mp::DaemonConfig& config, const mp::LaunchRequest* request,
+                                               const std::string& name, const mp::MemorySize& mem_size,
+                                               const mp::optional<mp::MemorySize>& requested_disk_space,
+                                               const std::string& mac_addr,
+                                               const std::function<bool(const mp::LaunchReply&)>& write)
+{
+    auto query = query_from(request, name);
+
+    auto progress_monitor = [&write](int progress_type, int percentage) {
+        mp::LaunchReply create_reply;
+        create_reply.mutable_launch_progress()->set_percent_complete(std::to_string(percentage));
+        create_reply.mutable_launch_progress()->set_type((mp::LaunchProgress::ProgressTypes)progress_type);
+        return write(create_reply);
+    };
+
+    auto prepare_action = [&config, &write, &name](const mp::VMImage& source_image) -> mp::VMImage {
+        mp::LaunchReply reply;
+        reply.set_create_message("Preparing image for " + name);
+        write(reply);
+
+        return config.factory->prepare_source_image(source_image);
+    };
+
+    auto fetch_type = config.factory->fetch_type();
+
+    mp::LaunchReply reply;
+    reply.set_create_message("Creating " + name);
+    write(reply);
+    auto vm_image = config.vault->fetch_image(fetch_type, query, prepare_action, progress_monitor);
+
+    // TODO: make this come from the image host
+    const auto& driver = mp::utils::get_driver_str();
+    mp::MemorySize disk_space;
+    if (driver == "lxd")
+    {
+        disk_space = *requested_disk_space;
+    }
+    else
+    {
+        disk_space = compute_final_image_size(vm_image, requested_disk_space);
+    }
+
+    reply.set_create_message("Configuring " + name);
+    write(reply);
+    auto vendor_data_cloud_init_config =
+        make_cloud_init_vendor_config(*config.ssh_key_provider, request->time_zone(), config.ssh_username,
+                                      config.factory->get_backend_version_string().toStdString());
+    auto meta_data_cloud_init_config = make_cloud_init_meta_config(name);
+    auto user_data_cloud_init_config = YAML::Load(request->cloud_init_user_data());
+    prepare_user_data(user_data_cloud_init_config, vendor_data_cloud_init_config);
+
+    auto vm_desc = to_machine_desc(request, name, mem_size, disk_space, mac_addr, config.ssh_username, vm_image,
+                                   meta_data_cloud_init_config, user_data_cloud_init_config,
+                                   vendor_data_cloud_init_config);
+
+    config.factory->prepare_instance_image(vm_image, vm_desc);
+
+    return vm_desc;
+}
+
 } // namespace
 
 mp::Daemon::Daemon(std::unique_ptr<const DaemonConfig> the_config)
@@ -673,12 +800,18 @@ mp::Daemon::Daemon(std::unique_ptr<const DaemonConfig> the_config)
       vm_instance_specs{load_db(
           mp::utils::backend_directory_path(config->data_directory, config->factory->get_backend_directory_name()),
           mp::utils::backend_directory_path(config->cache_directory, config->factory->get_backend_directory_name()))},
+      ssh_sessions{*config->ssh_key_provider},
+      guest_telemetry{ssh_sessions},
       daemon_rpc{config->server_address, config->connection_type, *config->cert_provider, *config->client_cert_store},
       metrics_provider{"https://api.jujucharms.com/omnibus/v4/multipass/metrics", get_unique_id(config->data_directory),
                        config->data_directory},
       metrics_opt_in{get_metrics_opt_in(config->data_directory)},
       instance_mounts{*config->ssh_key_provider}
 {
+    instance_wait_pool.setMaxThreadCount(max_instance_waits);
+    persist_instances_timer.setSingleShot(true);
+    persist_instances_timer.setInterval(persist_instances_delay);
+    connect(&persist_instances_timer, &QTimer::timeout, this, &Daemon::write_instance_db);
     connect_rpc(daemon_rpc, *this);
     std::vector<std::string> invalid_specs;
     bool mac_addr_missing{false};
@@ -693,41 +826,13 @@ mp::Daemon::Daemon(std::unique_ptr<const DaemonConfig> the_config)
             continue;
         }
 
-        auto mac_addr = spec.mac_addr;
-        if (mac_addr.empty())
+        if (spec.mac_addr.empty())
         {
-            mac_addr = mp::utils::generate_mac_address();
-            vm_instance_specs[name].mac_addr = mac_addr;
+            std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
+            spec.mac_addr = mp::utils::generate_mac_address();
             mac_addr_missing = true;
         }
-        allocated_mac_addrs.insert(mac_addr);
-
-        auto vm_image = fetch_image_for(name, config->factory->fetch_type(), *config->vault);
-        const auto instance_dir = mp::utils::base_dir(vm_image.image_path);
-        const auto cloud_init_iso = instance_dir.filePath("cloud-init-config.iso");
-        mp::VirtualMachineDescription vm_desc{spec.num_cores,
-                                              spec.mem_size,
-                                              spec.disk_space,
-                                              name,
-                                              mac_addr,
-                                              spec.ssh_username,
-                                              vm_image,
-                                              cloud_init_iso,
-                                              {},
-                                              {},
-                                              {}};
-
-        try
-        {
-            auto& instance_record = spec.deleted ? deleted_instances : vm_instances;
-            instance_record[name] = config->factory->create_virtual_machine(vm_desc, *this);
-        }
-        catch (const std::exception& e)
-        {
-            mpl::log(mpl::Level::error, category, fmt::format("Removing instance {}: {}", name, e.what()));
-            invalid_specs.push_back(name);
-            config->vault->remove(name);
-        }
+        allocated_mac_addrs.insert(spec.mac_addr);
 
         // FIXME: somehow we're writing contradictory state to disk.
         if (spec.deleted && spec.state != VirtualMachine::State::stopped)
@@ -735,29 +840,38 @@ mp::Daemon::Daemon(std::unique_ptr<const DaemonConfig> the_config)
             mpl::log(mpl::Level::warning, category,
                      fmt::format("{} is deleted but has incompatible state {}, reseting state to 0 (stopped)", name,
                                  static_cast<int>(spec.state)));
+            std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
             spec.state = VirtualMachine::State::stopped;
         }
 
-        if (spec.state == VirtualMachine::State::running && vm_instances[name]->state != VirtualMachine::State::running)
+        // Instances are restored once the event loop runs, one at a time so that requests are served in between.
+        // Operations requested on an instance in the meantime wait for it to be restored.
         {
-            assert(!spec.deleted);
-            mpl::log(mpl::Level::info, category, fmt::format("{} needs starting. Starting now...", name));
-
-            QTimer::singleShot(0, [this, &name] {
-                vm_instances[name]->start();
-                on_restart(name);
-            });
+            std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
+            restoring_instances.insert(name);
         }
+        operation_queue.schedule({name}, InstanceOperationQueue::Kind::restore, [this, name](const auto& done) {
+            pending_restores.push_back([this, name, done] {
+                auto done_guard = sg::make_scope_guard([&done]() noexcept { done(); });
+                restore_instance(name);
+            });
+        });
     }
 
-    for (const auto& bad_spec : invalid_specs)
     {
-        vm_instance_specs.erase(bad_spec);
+        std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
+        for (const auto& bad_spec : invalid_specs)
+        {
+            vm_instance_specs.erase(bad_spec);
+        }
     }
 
     if (!invalid_specs.empty() || mac_addr_missing)
         persist_instances();
 
+    if (!pending_restores.empty())
+        QTimer::singleShot(0, this, &Daemon::restore_next_instance);
+
     for (const auto& image_host : config->image_hosts)
     {
         for (const auto& remote : image_host->supported_remotes())
@@ -810,6 +924,142 @@ mp::Daemon::Daemon(std::unique_ptr<const DaemonConfig> the_config)
         }
     });
     source_images_maintenance_task.start(config->image_refresh_timer);
+
+    // New images for the aliases that are kept warm are fetched in the background, as soon as they are released
+    connect(&image_prefetch_task, &QTimer::timeout, [this]() {
+        if (image_prefetch_future.isFinished())
+            image_prefetch_future = QtConcurrent::run(this, &Daemon::prefetch_warm_images);
+    });
+    image_prefetch_task.start(config->image_prefetch_interval);
+
+    connect(&telemetry_refresh_task, &QTimer::timeout, this, &Daemon::refresh_guest_telemetry);
+    telemetry_refresh_task.start(config->telemetry_refresh_interval);
+}
+
+mp::Daemon::~Daemon()
+{
+    {
+        // Set under the lock, for requests waiting on the instances to see it
+        std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
+        shutting_down = true;
+    }
+    instances_changed.notify_all();
+
+    // Work on images in the background uses the vault and the factory, which go away with the daemon
+    image_prefetch_task.stop();
+    source_images_maintenance_task.stop();
+    telemetry_refresh_task.stop();
+    config->url_downloader->abort_all_downloads();
+    image_prefetch_future.waitForFinished();
+    image_update_future.waitForFinished();
+
+    // Waits give up at their next check, but may still have changes of their own to save
+    instance_wait_pool.waitForDone();
+    if (instances_dirty)
+        write_instance_db();
+}
+
+void mp::Daemon::restore_next_instance()
+{
+    auto restore = std::move(pending_restores.front());
+    pending_restores.pop_front();
+
+    restore();
+
+    if (!pending_restores.empty())
+        QTimer::singleShot(0, this, &Daemon::restore_next_instance);
+}
+
+void mp::Daemon::restore_instance(const std::string& name)
+{
+    const auto& spec = vm_instance_specs[name];
+
+    VirtualMachine::ShPtr vm;
+    try
+    {
+        auto vm_image = fetch_image_for(name, config->factory->fetch_type(), *config->vault);
+        const auto instance_dir = mp::utils::base_dir(vm_image.image_path);
+        const auto cloud_init_iso = instance_dir.filePath("cloud-init-config.iso");
+        mp::VirtualMachineDescription vm_desc{spec.num_cores,
+                                              spec.mem_size,
+                                              spec.disk_space,
+                                              name,
+                                              spec.mac_addr,
+                                              spec.ssh_username,
+                                              vm_image,
+                                              cloud_init_iso,
+                                              {},
+                                              {},
+                                              {}};
+
+        if (is_dormant(spec))
+            vm = std::make_shared<LazyVirtualMachine>(spec.state, name, spec.ssh_username,
+                                                      [this, vm_desc](LazyVirtualMachine& placeholder) {
+                                                          return create_backend_vm_for(placeholder, vm_desc);
+                                                      });
+        else
+            vm = config->factory->create_virtual_machine(vm_desc, *this);
+    }
+    catch (const std::exception& e)
+    {
+        mpl::log(mpl::Level::error, category, fmt::format("Removing instance {}: {}", name, e.what()));
+        {
+            std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
+            restoring_instances.erase(name);
+            vm_instance_specs.erase(name);
+        }
+        instances_changed.notify_all();
+        config->vault->remove(name);
+        persist_instances();
+
+        WatchReply removed;
+        removed.add_removed_instances(name);
+        notify_watchers(removed);
+        return;
+    }
+
+    const auto deleted = spec.deleted;
+    const auto needs_starting =
+        spec.state == VirtualMachine::State::running && vm->state != VirtualMachine::State::running;
+    const auto observation = observe_instance(*vm);
+    look_up_image_info(name);
+    {
+        std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
+        restoring_instances.erase(name);
+        (deleted ? deleted_instances : vm_instances)[name] = vm;
+        instance_observations[name] = observation;
+    }
+    instances_changed.notify_all();
+
+    notify_watchers(
+        watch_reply_for(name, deleted ? mp::InstanceStatus::DELETED : grpc_instance_status_for(observation.state)));
+
+    if (needs_starting)
+    {
+        assert(!deleted);
+        mpl::log(mpl::Level::info, category, fmt::format("{} needs starting. Starting now...", name));
+
+        vm->start();
+        on_restart(name);
+    }
+}
+
+mp::VirtualMachine::ShPtr mp::Daemon::create_backend_vm_for(LazyVirtualMachine& placeholder,
+                                                            const VirtualMachineDescription& vm_desc)
+{
+    mpl::log(mpl::Level::debug, category, fmt::format("Creating the virtual machine for {}", placeholder.vm_name));
+    VirtualMachine::ShPtr vm = config->factory->create_virtual_machine(vm_desc, *this);
+
+    // From now on, the daemon deals with the backend's machine directly
+    std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
+    for (auto instances : {&vm_instances, &deleted_instances})
+    {
+        auto it = instances->find(placeholder.vm_name);
+        if (it != instances->end() && it->second.get() == &placeholder)
+            it->second = vm;
+    }
+
+    return vm;
 }
 
 void mp::Daemon::create(const CreateRequest* request, grpc::ServerWriter<CreateReply>* server,
@@ -867,7 +1117,10 @@ catch (const mp::StartException& e)
     auto name = e.name();
 
     release_resources(name);
-    vm_instances.erase(name);
+    {
+        std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
+        vm_instances.erase(name);
+    }
     persist_instances();
 
     status_promise->set_value(grpc::Status(grpc::StatusCode::ABORTED, e.what(), ""));
@@ -877,15 +1130,206 @@ catch (const std::exception& e)
     status_promise->set_value(grpc::Status(grpc::StatusCode::FAILED_PRECONDITION, e.what(), ""));
 }
 
+// Shared by the steps of a launch_many request. Those run on the main thread, except for the progress reports.
+struct mp::Daemon::LaunchBatch
+{
+    bool write(const LaunchReply& reply)
+    {
+        std::lock_guard<decltype(write_mutex)> lock{write_mutex};
+        return server->Write(reply);
+    }
+
+    grpc::ServerWriter<LaunchReply>* server;
+    std::promise<grpc::Status>* status_promise;
+    std::size_t max_parallel;
+    std::deque<std::string> to_boot;
+    std::size_t booting{0};
+    bool finished{false};
+    std::vector<std::string> errors;
+    std::mutex write_mutex; // instances being prepared report progress from several threads at once
+};
+
+void mp::Daemon::launch_many(const LaunchManyRequest* request, grpc::ServerWriter<LaunchReply>* server,
+                             std::promise<grpc::Status>* status_promise) // clang-format off
+try // clang-format on
+{
+    mpl::ClientLogger<LaunchReply> logger{mpl::level_from(request->verbosity_level()), *config->logger, server};
+
+    auto checked_args = validate_create_arguments(&request->launch());
+    if (!checked_args.option_errors.error_codes().empty())
+    {
+        return status_promise->set_value(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid arguments supplied",
+                                                      checked_args.option_errors.SerializeAsString()));
+    }
+
+    if (request->count() == 0)
+        return status_promise->set_value(
+            grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "The number of instances must be at least 1", ""));
+
+    auto name_taken = [this](const std::string& name) {
+        return vm_instances.find(name) != vm_instances.end() ||
+               deleted_instances.find(name) != deleted_instances.end() ||
+               preparing_instances.find(name) != preparing_instances.end() ||
+               restoring_instances.find(name) != restoring_instances.end();
+    };
+
+    std::vector<std::string> names;
+    for (auto i = 1u; i <= request->count(); ++i)
+    {
+        std::string name;
+        if (!checked_args.instance_name.empty())
+        {
+            name = fmt::format("{}-{}", checked_args.instance_name, i);
+
+            CreateError create_error;
+            if (!mp::utils::valid_hostname(name))
+            {
+                create_error.add_error_codes(CreateError::INVALID_HOSTNAME);
+                return status_promise->set_value(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                                              fmt::format("invalid instance name \"{}\"", name),
+                                                              create_error.SerializeAsString()));
+            }
+
+            if (name_taken(name))
+            {
+                create_error.add_error_codes(CreateError::INSTANCE_EXISTS);
+                return status_promise->set_value(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                                              fmt::format("instance \"{}\" already exists", name),
+                                                              create_error.SerializeAsString()));
+            }
+        }
+        else
+        {
+            constexpr int num_retries = 100;
+            for (int retry = 0; retry < num_retries && (name.empty() || name_taken(name) ||
+                                                        std::find(names.begin(), names.end(), name) != names.end());
+                 ++retry)
+                name = config->name_generator->make_name();
+
+            if (name_taken(name) || std::find(names.begin(), names.end(), name) != names.end())
+                throw std::runtime_error("unable to generate a unique name");
+        }
+
+        names.push_back(name);
+    }
+
+    if (!instances_running(vm_instances))
+        config->factory->hypervisor_health_check();
+
+    if (metrics_opt_in.opt_in_status == OptInStatus::ACCEPTED)
+        metrics_provider.send_metrics();
+
+    auto batch = std::make_shared<LaunchBatch>();
+    batch->server = server;
+    batch->status_promise = status_promise;
+    batch->max_parallel = request->max_parallel() ? request->max_parallel() : std::max(1, QThread::idealThreadCount());
+
+    std::vector<std::string> mac_addrs;
+    for (const auto& name : names)
+    {
+        preparing_instances.insert(name);
+        mac_addrs.push_back(generate_unused_mac_address(allocated_mac_addrs));
+    }
+
+    auto prepare_future_watcher = new QFutureWatcher<std::vector<PreparedInstance>>();
+
+    QObject::connect(prepare_future_watcher, &QFutureWatcher<std::vector<PreparedInstance>>::finished,
+                     [this, batch, prepare_future_watcher] {
+                         for (const auto& prepared : prepare_future_watcher->future().result())
+                         {
+                             try
+                             {
+                                 if (!prepared.vm_desc)
+                                     throw std::runtime_error(prepared.error);
+
+                                 register_instance(prepared.name, *prepared.vm_desc);
+                                 batch->to_boot.push_back(prepared.name);
+                             }
+                             catch (const std::exception& e)
+                             {
+                                 discard_instance(prepared.name);
+                                 batch->errors.push_back(fmt::format("{}: {}", prepared.name, e.what()));
+                             }
+                         }
+
+                         delete prepare_future_watcher;
+                         boot_next(batch);
+                     });
+
+    prepare_future_watcher->setFuture(QtConcurrent::run([this, batch, request, names, mac_addrs, checked_args] {
+        std::vector<PreparedInstance> prepared(names.size());
+        auto prepare = [&](std::size_t i) {
+            prepared[i].name = names[i];
+            try
+            {
+                prepared[i].vm_desc =
+                    prepare_instance(*config, &request->launch(), names[i], checked_args.mem_size,
+                                     checked_args.disk_space, mac_addrs[i],
+                                     [&batch](const LaunchReply& reply) { return batch->write(reply); });
+            }
+            catch (const std::exception& e)
+            {
+                prepared[i].error = e.what();
+            }
+        };
+
+        // The first instance brings the image into the vault, where the others then find it
+        prepare(0);
+        if (!prepared[0].vm_desc)
+        {
+            for (auto i = 1u; i < names.size(); ++i)
+                prepared[i] = {names[i], nullopt, prepared[0].error};
+
+            return prepared;
+        }
+
+        QThreadPool pool;
+        pool.setMaxThreadCount(static_cast<int>(batch->max_parallel));
+        for (auto i = 1u; i < names.size(); ++i)
+            QtConcurrent::run(&pool, [&prepare, i] { prepare(i); });
+        pool.waitForDone();
+
+        return prepared;
+    }));
+}
+catch (const std::exception& e)
+{
+    status_promise->set_value(grpc::Status(grpc::StatusCode::FAILED_PRECONDITION, e.what(), ""));
+}
+
 void mp::Daemon::purge(const PurgeRequest* request, grpc::ServerWriter<PurgeReply>* server,
-                       std::promise<grpc::Status>* status_promise) // clang-format off
+                       std::promise<grpc::Status>* status_promise)
+{
+    // Instances still being restored may turn out to be deleted, so they are waited for
+    std::vector<std::string> instances = restoring_instance_names();
+    for (const auto& instance : deleted_instances)
+        instances.push_back(instance.first);
+
+    operation_queue.schedule(instances, InstanceOperationQueue::Kind::purge,
+                             [this, request, server, status_promise](const auto& done) {
+                                 purge_instances(request, server, status_promise, done);
+                             });
+}
+
+void mp::Daemon::purge_instances(const PurgeRequest* request, grpc::ServerWriter<PurgeReply>* server,
+                                 std::promise<grpc::Status>* status_promise,
+                                 const InstanceOperationQueue::Done& done) // clang-format off
 try // clang-format on
 {
+    auto done_guard = sg::make_scope_guard([&done]() noexcept { done(); });
+    WatchReply removals;
     for (const auto& del : deleted_instances)
+    {
         release_resources(del.first);
+        removals.add_removed_instances(del.first);
+    }
 
-    deleted_instances.clear();
+    {
+        std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
+        deleted_instances.clear();
+    }
     persist_instances();
+    notify_watchers(removals);
 
     status_promise->set_value(grpc::Status::OK);
 }
@@ -1065,67 +1509,44 @@ try // clang-format on
     InfoReply response;
 
     fmt::memory_buffer errors;
-    std::vector<decltype(vm_instances)::key_type> instances_for_info;
+    const auto& names = request->instance_names().instance_name();
 
-    if (request->instance_names().instance_name().empty())
-    {
-        for (auto& pair : vm_instances)
-            instances_for_info.push_back(pair.first);
-    }
-    else
+    for (const auto& snapshot : snapshot_instances({names.begin(), names.end()}, /*include_deleted=*/false))
     {
-        for (const auto& name : request->instance_names().instance_name())
-            instances_for_info.push_back(name);
-    }
+        const auto& name = snapshot.name;
+        if (snapshot.restoring)
+        {
+            auto info = response.add_info();
+            info->set_name(name);
+            info->mutable_instance_status()->set_status(mp::InstanceStatus::RESTORING);
+            continue;
+        }
 
-    for (const auto& name : instances_for_info)
-    {
-        auto it = vm_instances.find(name);
-        bool deleted{false};
-        if (it == vm_instances.end())
+        if (!snapshot.vm)
         {
-            it = deleted_instances.find(name);
-            if (it == deleted_instances.end())
-            {
-                fmt::format_to(errors, "instance \"{}\" does not exist\n", name);
-                continue;
-            }
-            deleted = true;
+            fmt::format_to(errors, "instance \"{}\" does not exist\n", name);
+            continue;
         }
 
         auto info = response.add_info();
-        auto& vm = it->second;
-        auto present_state = vm->current_state();
+        const auto& observed = snapshot.observed;
         info->set_name(name);
-        if (deleted)
+        if (snapshot.deleted)
         {
             info->mutable_instance_status()->set_status(mp::InstanceStatus::DELETED);
         }
         else
         {
-            info->mutable_instance_status()->set_status(grpc_instance_status_for(present_state));
+            info->mutable_instance_status()->set_status(grpc_instance_status_for(observed.state));
         }
 
-        auto vm_image = fetch_image_for(name, config->factory->fetch_type(), *config->vault);
-        auto original_release = vm_image.original_release;
-
-        if (!vm_image.id.empty() && original_release.empty())
-        {
-            try
-            {
-                auto vm_image_info = config->image_hosts.back()->info_for_full_hash(vm_image.id);
-                original_release = vm_image_info.release_title.toStdString();
-            }
-            catch (const std::exception& e)
-            {
-                mpl::log(mpl::Level::warning, category, fmt::format("Cannot fetch image information: {}", e.what()));
-            }
-        }
+        const auto image_info = image_info_for(name);
+        const auto& original_release = image_info.release;
 
         info->set_image_release(original_release);
-        info->set_id(vm_image.id);
+        info->set_id(image_info.id);
 
-        auto vm_specs = vm_instance_specs[name];
+        const auto& vm_specs = snapshot.specs;
 
         auto mount_info = info->mutable_mount_info();
 
@@ -1152,46 +1573,38 @@ try // clang-format on
             }
         }
 
-        if (mp::utils::is_running(present_state))
+        if (mp::utils::is_running(observed.state))
         {
-            mp::SSHSession session{vm->ssh_hostname(), vm->ssh_port(), vm_specs.ssh_username,
-                                   *config->ssh_key_provider};
-
-            auto run_in_vm = [&session](const std::string& cmd) {
-                auto proc = session.exec(cmd);
-                if (proc.exit_code() != 0)
-                {
-                    auto error_msg = proc.read_std_error();
-                    mpl::log(
-                        mpl::Level::warning, category,
-                        fmt::format("failed to run '{}', error message: '{}'", cmd, mp::utils::trim_end(error_msg)));
-                    return std::string{};
-                }
-
-                auto output = proc.read_std_output();
-                if (output.empty())
-                {
-                    mpl::log(mpl::Level::warning, category, fmt::format("no output after running '{}'", cmd));
-                    return std::string{};
-                }
-
-                return mp::utils::trim_end(output);
-            };
-
-            info->set_load(run_in_vm("cat /proc/loadavg | cut -d ' ' -f1-3"));
-            info->set_memory_usage(run_in_vm("free -b | sed '1d;3d' | awk '{printf $3}'"));
-            info->set_memory_total(run_in_vm("free -b | sed '1d;3d' | awk '{printf $2}'"));
-            info->set_disk_usage(
-                run_in_vm("df --output=used `awk '$2 == \"/\" { print $1 }' /proc/mounts` -B1 | sed 1d"));
-            info->set_disk_total(
-                run_in_vm("df --output=size `awk '$2 == \"/\" { print $1 }' /proc/mounts` -B1 | sed 1d"));
-            info->set_ipv4(vm->ipv4());
+            // Left out when not gathered yet (e.g. the instance just started), until the next telemetry refresh
+            auto telemetry = guest_telemetry.cached(name);
+            if (telemetry)
+            {
+                info->set_load(telemetry->load);
+                info->set_memory_usage(telemetry->memory_usage);
+                info->set_memory_total(telemetry->memory_total);
+                info->set_disk_usage(telemetry->disk_usage);
+                info->set_disk_total(telemetry->disk_total);
+                info->set_telemetry_timestamp(
+                    std::chrono::duration_cast<std::chrono::seconds>(telemetry->timestamp.time_since_epoch()).count());
+            }
+            info->set_ipv4(observed.ipv4);
 
-            auto current_release = run_in_vm("lsb_release -ds");
+            auto current_release = telemetry ? telemetry->current_release : std::string{};
             info->set_current_release(!current_release.empty() ? current_release : original_release);
         }
     }
 
+    // Instances still being restored have nothing to report but their name
+    if (names.empty())
+    {
+        for (const auto& name : restoring_instance_names())
+        {
+            auto info = response.add_info();
+            info->set_name(name);
+            info->mutable_instance_status()->set_status(mp::InstanceStatus::RESTORING);
+        }
+    }
+
     auto status = grpc_status_for(errors);
     if (status.ok())
         server->Write(response);
@@ -1211,47 +1624,82 @@ try // clang-format on
     ListReply response;
     config->update_prompt->populate_if_time_to_show(response.mutable_update_info());
 
-    for (const auto& instance : vm_instances)
+    const auto& states = request->states();
+    const auto& name_prefix = request->name_prefix();
+    const auto& image = request->image();
+    const auto page_size = request->page_size();
+    bool written{false};
+
+    for (const auto& snapshot : snapshot_instances({}, /*include_deleted=*/true))
     {
-        const auto& name = instance.first;
-        const auto& vm = instance.second;
-        auto present_state = vm->current_state();
-        auto entry = response.add_instances();
-        entry->set_name(name);
-        entry->mutable_instance_status()->set_status(grpc_instance_status_for(present_state));
+        const auto& name = snapshot.name;
+        if (name.compare(0, name_prefix.size(), name_prefix) != 0)
+            continue;
 
-        // FIXME: Set the release to the cached current version when supported
-        auto vm_image = fetch_image_for(name, config->factory->fetch_type(), *config->vault);
-        auto current_release = vm_image.original_release;
+        const auto& observed = snapshot.observed;
+        const auto status = snapshot.deleted ? mp::InstanceStatus::DELETED : grpc_instance_status_for(observed.state);
+
+        if (!states.empty() && std::find(states.begin(), states.end(), status) == states.end())
+            continue;
+
+        // Deleted instances only report their status, so they cannot match an image
+        InstanceImageInfo image_info;
+        if (!snapshot.deleted)
+            image_info = image_info_for(name);
+        else if (!image.empty())
+            continue;
+
+        if (!image.empty() && image_info.id.compare(0, image.size(), image) != 0 &&
+            image_info.release.compare(0, image.size(), image) != 0)
+            continue;
+
+        auto entry = response.add_instances();
+        entry->set_name(name);
+        entry->mutable_instance_status()->set_status(status);
 
-        if (!vm_image.id.empty() && current_release.empty())
+        if (!snapshot.deleted)
         {
-            try
-            {
-                auto vm_image_info = config->image_hosts.back()->info_for_full_hash(vm_image.id);
-                current_release = vm_image_info.release_title.toStdString();
-            }
-            catch (const std::exception& e)
-            {
-                mpl::log(mpl::Level::warning, category, fmt::format("Cannot fetch image information: {}", e.what()));
-            }
-        }
+            // FIXME: Set the release to the cached current version when supported
+            entry->set_current_release(image_info.release);
 
-        entry->set_current_release(current_release);
+            if (mp::utils::is_running(observed.state))
+                entry->set_ipv4(observed.ipv4);
+        }
 
-        if (mp::utils::is_running(present_state))
-            entry->set_ipv4(vm->ipv4());
+        if (page_size && static_cast<unsigned>(response.instances_size()) >= page_size)
+        {
+            server->Write(response);
+            response.Clear();
+            written = true;
+        }
     }
 
-    for (const auto& instance : deleted_instances)
+    // Instances still being restored from the last run have nothing to report but their name
+    const bool restoring_wanted =
+        states.empty() || std::find(states.begin(), states.end(), mp::InstanceStatus::RESTORING) != states.end();
+    if (restoring_wanted && image.empty())
     {
-        const auto& name = instance.first;
-        auto entry = response.add_instances();
-        entry->set_name(name);
-        entry->mutable_instance_status()->set_status(mp::InstanceStatus::DELETED);
+        for (const auto& name : restoring_instance_names())
+        {
+            if (name.compare(0, name_prefix.size(), name_prefix) != 0)
+                continue;
+
+            auto entry = response.add_instances();
+            entry->set_name(name);
+            entry->mutable_instance_status()->set_status(mp::InstanceStatus::RESTORING);
+
+            if (page_size && static_cast<unsigned>(response.instances_size()) >= page_size)
+            {
+                server->Write(response);
+                response.Clear();
+                written = true;
+            }
+        }
     }
 
-    server->Write(response);
+    if (response.instances_size() || !written)
+        server->Write(response);
+
     status_promise->set_value(grpc::Status::OK);
 }
 catch (const std::exception& e)
@@ -1260,9 +1708,20 @@ catch (const std::exception& e)
 }
 
 void mp::Daemon::mount(const MountRequest* request, grpc::ServerWriter<MountReply>* server,
-                       std::promise<grpc::Status>* status_promise) // clang-format off
+                       std::promise<grpc::Status>* status_promise)
+{
+    schedule_operation(instance_names_of(request->target_paths()), InstanceOperationQueue::Kind::mount,
+                       [this, request, server, status_promise](const auto& done) {
+                           mount_instances(request, server, status_promise, done);
+                       });
+}
+
+void mp::Daemon::mount_instances(const MountRequest* request, grpc::ServerWriter<MountReply>* server,
+                                 std::promise<grpc::Status>* status_promise,
+                                 const InstanceOperationQueue::Done& done) // clang-format off
 try // clang-format on
 {
+    auto done_guard = sg::make_scope_guard([&done]() noexcept { done(); });
     mpl::ClientLogger<MountReply> logger{mpl::level_from(request->verbosity_level()), *config->logger, server};
 
     QFileInfo source_dir(QString::fromStdString(request->source_path()));
@@ -1337,6 +1796,7 @@ try // clang-format on
                     mount_reply.set_mount_message("Enabling support for mounting");
                     server->Write(mount_reply);
 
+                    // Installing can take minutes, which is too long to keep a pooled session from other uses
                     mp::SSHSession session{vm->ssh_hostname(), vm->ssh_port(), vm_specs.ssh_username,
                                            *config->ssh_key_provider};
                     mp::utils::install_sshfs_for(name, session);
@@ -1361,6 +1821,7 @@ try // clang-format on
         }
 
         VMMount mount{request->source_path(), gid_map, uid_map};
+        std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
         vm_specs.mounts[target_path] = mount;
     }
 
@@ -1374,9 +1835,20 @@ catch (const std::exception& e)
 }
 
 void mp::Daemon::recover(const RecoverRequest* request, grpc::ServerWriter<RecoverReply>* server,
-                         std::promise<grpc::Status>* status_promise) // clang-format off
+                         std::promise<grpc::Status>* status_promise)
+{
+    schedule_operation(instance_names_of(request->instance_names()), InstanceOperationQueue::Kind::recover,
+                       [this, request, server, status_promise](const auto& done) {
+                           recover_instances(request, server, status_promise, done);
+                       });
+}
+
+void mp::Daemon::recover_instances(const RecoverRequest* request, grpc::ServerWriter<RecoverReply>* server,
+                                   std::promise<grpc::Status>* status_promise,
+                                   const InstanceOperationQueue::Done& done) // clang-format off
 try // clang-format on
 {
+    auto done_guard = sg::make_scope_guard([&done]() noexcept { done(); });
     mpl::ClientLogger<RecoverReply> logger{mpl::level_from(request->verbosity_level()), *config->logger, server};
 
     const auto [instances, status] =
@@ -1385,15 +1857,18 @@ try // clang-format on
 
     if (status.ok())
     {
+        WatchReply recoveries;
         for (const auto& name : instances)
         {
             auto it = deleted_instances.find(name);
             if (it != std::end(deleted_instances))
             {
+                std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
                 assert(vm_instance_specs[name].deleted);
                 vm_instance_specs[name].deleted = false;
                 vm_instances[name] = std::move(it->second);
                 deleted_instances.erase(it);
+                add_watched_instance(recoveries, name, grpc_instance_status_for(vm_instances[name]->current_state()));
             }
             else
             {
@@ -1403,6 +1878,7 @@ try // clang-format on
         }
 
         persist_instances();
+        notify_watchers(recoveries);
     }
 
     status_promise->set_value(status);
@@ -1418,33 +1894,52 @@ try // clang-format on
 {
     mpl::ClientLogger<SSHInfoReply> logger{mpl::level_from(request->verbosity_level()), *config->logger, server};
     SSHInfoReply response;
+    const auto& names = request->instance_name();
 
-    for (const auto& name : request->instance_name())
+    // Instances still being restored, or running but not reachable yet, are waited for rather than reported missing or
+    // unreachable. Other instances are answered for at once, whatever operations they are going through.
     {
-        auto it = vm_instances.find(name);
-        if (it == vm_instances.end())
-        {
-            if (deleted_instances.find(name) == deleted_instances.end())
-                return status_promise->set_value(
-                    grpc::Status{grpc::StatusCode::NOT_FOUND, fmt::format("instance \"{}\" does not exist", name)});
-            else
-                return status_promise->set_value(
-                    grpc::Status{grpc::StatusCode::INVALID_ARGUMENT, fmt::format("instance \"{}\" is deleted", name)});
-        }
+        auto settling = [this](const std::string& name) {
+            if (restoring_instances.find(name) != restoring_instances.end())
+                return true;
 
-        auto& vm = it->second;
-        if (vm->current_state() == VirtualMachine::State::unknown)
+            auto it = instance_observations.find(name);
+            return vm_instances.find(name) != vm_instances.end() && it != instance_observations.end() &&
+                   mp::utils::is_running(it->second.state) && it->second.ssh_hostname.empty();
+        };
+
+        std::shared_lock<decltype(instances_mutex)> lock{instances_mutex};
+        instances_changed.wait_for(lock, up_timeout, [this, &names, &settling] {
+            return shutting_down || std::none_of(names.begin(), names.end(), settling);
+        });
+    }
+
+    const auto snapshots = names.empty() ? std::vector<InstanceSnapshot>{}
+                                         : snapshot_instances({names.begin(), names.end()}, /*include_deleted=*/false);
+
+    for (const auto& snapshot : snapshots)
+    {
+        const auto& name = snapshot.name;
+        if (!snapshot.vm)
+            return status_promise->set_value(
+                grpc::Status{grpc::StatusCode::NOT_FOUND, fmt::format("instance \"{}\" does not exist", name)});
+        else if (snapshot.deleted)
+            return status_promise->set_value(
+                grpc::Status{grpc::StatusCode::INVALID_ARGUMENT, fmt::format("instance \"{}\" is deleted", name)});
+
+        const auto& observed = snapshot.observed;
+        if (observed.state == VirtualMachine::State::unknown)
             throw std::runtime_error("Cannot retrieve credentials in unknown state");
 
-        if (!mp::utils::is_running(vm->current_state()))
+        if (!mp::utils::is_running(observed.state))
         {
             return status_promise->set_value(
                 grpc::Status(grpc::StatusCode::ABORTED, fmt::format("instance \"{}\" is not running", name)));
         }
 
-        if (vm->state == VirtualMachine::State::delayed_shutdown)
+        if (observed.state == VirtualMachine::State::delayed_shutdown && snapshot.shutdown_time_remaining)
         {
-            if (delayed_shutdown_instances[name]->get_time_remaining() <= std::chrono::minutes(1))
+            if (*snapshot.shutdown_time_remaining <= std::chrono::minutes(1))
             {
                 return status_promise->set_value(
                     grpc::Status(grpc::StatusCode::FAILED_PRECONDITION,
@@ -1455,11 +1950,14 @@ try // clang-format on
             }
         }
 
+        if (observed.ssh_hostname.empty())
+            throw std::runtime_error(fmt::format("cannot reach instance \"{}\"", name));
+
         mp::SSHInfo ssh_info;
-        ssh_info.set_host(vm->ssh_hostname());
-        ssh_info.set_port(vm->ssh_port());
+        ssh_info.set_host(observed.ssh_hostname);
+        ssh_info.set_port(observed.ssh_port);
         ssh_info.set_priv_key_base64(config->ssh_key_provider->private_key_as_base64());
-        ssh_info.set_username(vm->ssh_username());
+        ssh_info.set_username(snapshot.specs.ssh_username);
         (*response.mutable_ssh_info())[name] = ssh_info;
     }
 
@@ -1472,9 +1970,20 @@ catch (const std::exception& e)
 }
 
 void mp::Daemon::start(const StartRequest* request, grpc::ServerWriter<StartReply>* server,
-                       std::promise<grpc::Status>* status_promise) // clang-format off
+                       std::promise<grpc::Status>* status_promise)
+{
+    schedule_operation(instance_names_of(request->instance_names()), InstanceOperationQueue::Kind::start,
+                       [this, request, server, status_promise](const auto& done) {
+                           start_instances(request, server, status_promise, done);
+                       });
+}
+
+void mp::Daemon::start_instances(const StartRequest* request, grpc::ServerWriter<StartReply>* server,
+                                 std::promise<grpc::Status>* status_promise,
+                                 const InstanceOperationQueue::Done& done) // clang-format off
 try // clang-format on
 {
+    auto done_guard = sg::make_scope_guard([&done]() noexcept { done(); });
     mpl::ClientLogger<StartReply> logger{mpl::level_from(request->verbosity_level()), *config->logger, server};
 
     if (!instances_running(vm_instances))
@@ -1492,7 +2001,7 @@ try // clang-format on
                                       ? mp::StartError::DOES_NOT_EXIST
                                       : mp::StartError::INSTANCE_DELETED});
         else if (it->second->current_state() == VirtualMachine::State::delayed_shutdown)
-            delayed_shutdown_instances.erase(name);
+            erase_delayed_shutdown(name);
         else if (it->second->current_state() != VirtualMachine::State::running)
             vms.push_back(name);
     }
@@ -1519,9 +2028,11 @@ try // clang-format on
             it->second->start();
     }
 
-    auto future_watcher = create_future_watcher();
-    future_watcher->setFuture(
-        QtConcurrent::run(this, &Daemon::async_wait_for_ready_all<StartReply>, server, vms, status_promise));
+    done_guard.dismiss(); // the operation is done once the instances are ready
+    auto future_watcher = create_future_watcher(done);
+    future_watcher->setFuture(QtConcurrent::run(&instance_wait_pool, this,
+                                                &Daemon::async_wait_for_ready_all<StartReply>, server, vms,
+                                                status_promise));
 }
 catch (const std::exception& e)
 {
@@ -1529,9 +2040,20 @@ catch (const std::exception& e)
 }
 
 void mp::Daemon::stop(const StopRequest* request, grpc::ServerWriter<StopReply>* server,
-                      std::promise<grpc::Status>* status_promise) // clang-format off
+                      std::promise<grpc::Status>* status_promise)
+{
+    schedule_operation(instance_names_of(request->instance_names()), InstanceOperationQueue::Kind::stop,
+                       [this, request, server, status_promise](const auto& done) {
+                           stop_instances(request, server, status_promise, done);
+                       });
+}
+
+void mp::Daemon::stop_instances(const StopRequest* request, grpc::ServerWriter<StopReply>* server,
+                                std::promise<grpc::Status>* status_promise,
+                                const InstanceOperationQueue::Done& done) // clang-format off
 try // clang-format on
 {
+    auto done_guard = sg::make_scope_guard([&done]() noexcept { done(); });
     mpl::ClientLogger<StopReply> logger{mpl::level_from(request->verbosity_level()), *config->logger, server};
 
     auto [instances, status] =
@@ -1558,9 +2080,20 @@ catch (const std::exception& e)
 }
 
 void mp::Daemon::suspend(const SuspendRequest* request, grpc::ServerWriter<SuspendReply>* server,
-                         std::promise<grpc::Status>* status_promise) // clang-format off
+                         std::promise<grpc::Status>* status_promise)
+{
+    schedule_operation(instance_names_of(request->instance_names()), InstanceOperationQueue::Kind::suspend,
+                       [this, request, server, status_promise](const auto& done) {
+                           suspend_instances(request, server, status_promise, done);
+                       });
+}
+
+void mp::Daemon::suspend_instances(const SuspendRequest* request, grpc::ServerWriter<SuspendReply>* server,
+                                   std::promise<grpc::Status>* status_promise,
+                                   const InstanceOperationQueue::Done& done) // clang-format off
 try // clang-format on
 {
+    auto done_guard = sg::make_scope_guard([&done]() noexcept { done(); });
     mpl::ClientLogger<SuspendReply> logger{mpl::level_from(request->verbosity_level()), *config->logger, server};
 
     fmt::memory_buffer errors;
@@ -1604,9 +2137,20 @@ catch (const std::exception& e)
 }
 
 void mp::Daemon::restart(const RestartRequest* request, grpc::ServerWriter<RestartReply>* server,
-                         std::promise<grpc::Status>* status_promise) // clang-format off
+                         std::promise<grpc::Status>* status_promise)
+{
+    schedule_operation(instance_names_of(request->instance_names()), InstanceOperationQueue::Kind::restart,
+                       [this, request, server, status_promise](const auto& done) {
+                           restart_instances(request, server, status_promise, done);
+                       });
+}
+
+void mp::Daemon::restart_instances(const RestartRequest* request, grpc::ServerWriter<RestartReply>* server,
+                                   std::promise<grpc::Status>* status_promise,
+                                   const InstanceOperationQueue::Done& done) // clang-format off
 try // clang-format on
 {
+    auto done_guard = sg::make_scope_guard([&done]() noexcept { done(); });
     mpl::ClientLogger<RestartReply> logger{mpl::level_from(request->verbosity_level()), *config->logger, server};
 
     auto [instances, status] =
@@ -1626,9 +2170,11 @@ try // clang-format on
         return status_promise->set_value(status);
     }
 
-    auto future_watcher = create_future_watcher();
-    future_watcher->setFuture(
-        QtConcurrent::run(this, &Daemon::async_wait_for_ready_all<RestartReply>, server, instances, status_promise));
+    done_guard.dismiss(); // the operation is done once the instances are ready
+    auto future_watcher = create_future_watcher(done);
+    future_watcher->setFuture(QtConcurrent::run(&instance_wait_pool, this,
+                                                &Daemon::async_wait_for_ready_all<RestartReply>, server, instances,
+                                                status_promise));
 }
 catch (const std::exception& e)
 {
@@ -1636,9 +2182,20 @@ catch (const std::exception& e)
 }
 
 void mp::Daemon::delet(const DeleteRequest* request, grpc::ServerWriter<DeleteReply>* server,
-                       std::promise<grpc::Status>* status_promise) // clang-format off
+                       std::promise<grpc::Status>* status_promise)
+{
+    schedule_operation(instance_names_of(request->instance_names()), InstanceOperationQueue::Kind::delet,
+                       [this, request, server, status_promise](const auto& done) {
+                           delete_instances(request, server, status_promise, done);
+                       });
+}
+
+void mp::Daemon::delete_instances(const DeleteRequest* request, grpc::ServerWriter<DeleteReply>* server,
+                                  std::promise<grpc::Status>* status_promise,
+                                  const InstanceOperationQueue::Done& done) // clang-format off
 try // clang-format on
 {
+    auto done_guard = sg::make_scope_guard([&done]() noexcept { done(); });
     mpl::ClientLogger<DeleteReply> logger{mpl::level_from(request->verbosity_level()), *config->logger, server};
 
     const auto [operational_instances_to_delete, trashed_instances_to_delete, status] =
@@ -1647,6 +2204,7 @@ try // clang-format on
     if (status.ok())
     {
         const bool purge = request->purge();
+        WatchReply changes;
 
         for (const auto& name : operational_instances_to_delete)
         {
@@ -1655,14 +2213,23 @@ try // clang-format on
             auto& instance = vm_instances[name];
 
             if (instance->current_state() == VirtualMachine::State::delayed_shutdown)
-                delayed_shutdown_instances.erase(name);
+                erase_delayed_shutdown(name);
 
             instance_mounts.stop_all_mounts_for_instance(name);
             instance->shutdown();
+            guest_telemetry.forget(name);
+            ssh_sessions.drop(name);
 
             if (purge)
                 release_resources(name);
+
+            if (purge)
+                changes.add_removed_instances(name);
             else
+                add_watched_instance(changes, name, mp::InstanceStatus::DELETED);
+
+            std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
+            if (!purge)
             {
                 deleted_instances[name] = std::move(instance);
                 vm_instance_specs[name].deleted = true;
@@ -1677,11 +2244,15 @@ try // clang-format on
             {
                 assert(vm_instance_specs[name].deleted);
                 release_resources(name);
+                changes.add_removed_instances(name);
+
+                std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
                 deleted_instances.erase(name);
             }
         }
 
         persist_instances();
+        notify_watchers(changes);
     }
 
     status_promise->set_value(status);
@@ -1692,9 +2263,20 @@ catch (const std::exception& e)
 }
 
 void mp::Daemon::umount(const UmountRequest* request, grpc::ServerWriter<UmountReply>* server,
-                        std::promise<grpc::Status>* status_promise) // clang-format off
+                        std::promise<grpc::Status>* status_promise)
+{
+    schedule_operation(instance_names_of(request->target_paths()), InstanceOperationQueue::Kind::umount,
+                       [this, request, server, status_promise](const auto& done) {
+                           umount_instances(request, server, status_promise, done);
+                       });
+}
+
+void mp::Daemon::umount_instances(const UmountRequest* request, grpc::ServerWriter<UmountReply>* server,
+                                  std::promise<grpc::Status>* status_promise,
+                                  const InstanceOperationQueue::Done& done) // clang-format off
 try // clang-format on
 {
+    auto done_guard = sg::make_scope_guard([&done]() noexcept { done(); });
     mpl::ClientLogger<UmountReply> logger{mpl::level_from(request->verbosity_level()), *config->logger, server};
 
     fmt::memory_buffer errors;
@@ -1716,6 +2298,8 @@ try // clang-format on
         if (target_path.empty())
         {
             instance_mounts.stop_all_mounts_for_instance(name);
+
+            std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
             mounts.clear();
         }
         else
@@ -1728,7 +2312,10 @@ try // clang-format on
                 }
             }
 
+            std::unique_lock<decltype(instances_mutex)> lock{instances_mutex};
             auto erased = mounts.erase(target_path);
+            lock.unlock();
+
             if (!erased)
             {
                 fmt::format_to(errors, "\"{}\" not found in database\n", target_path);
@@ -1757,6 +2344,74 @@ void mp::Daemon::version(const VersionRequest* request, grpc::ServerWriter<Versi
     status_promise->set_value(grpc::Status::OK);
 }
 
+void mp::Daemon::watch(const WatchRequest* request, WatchQueue* updates,
+                       std::promise<grpc::Status>* status_promise) // clang-format off
+try // clang-format on
+{
+    // The snapshot is taken with watchers locked, so that no change is missed between it and the first notification
+    std::lock_guard<decltype(watchers_mutex)> lock{watchers_mutex};
+
+    WatchReply reply;
+    reply.set_snapshot(true);
+    // The state is the one last recorded, since the backends are not to be asked from this thread
+    for (const auto& snapshot : snapshot_instances({}, /*include_deleted=*/true))
+        add_watched_instance(reply, snapshot.name,
+                             snapshot.deleted ? mp::InstanceStatus::DELETED
+                                              : grpc_instance_status_for(snapshot.specs.state));
+    for (const auto& name : restoring_instance_names())
+        add_watched_instance(reply, name, mp::InstanceStatus::RESTORING);
+
+    updates->push(reply);
+    watchers[updates] = status_promise;
+}
+catch (const std::exception& e)
+{
+    status_promise->set_value(grpc::Status(grpc::StatusCode::FAILED_PRECONDITION, e.what(), ""));
+}
+
+void mp::Daemon::unwatch(WatchQueue* updates)
+{
+    std::lock_guard<decltype(watchers_mutex)> lock{watchers_mutex};
+    auto it = watchers.find(updates);
+    if (it != watchers.end())
+    {
+        it->second->set_value(grpc::Status::OK);
+        watchers.erase(it);
+    }
+}
+
+void mp::Daemon::image_cache(const ImageCacheRequest* request, grpc::ServerWriter<ImageCacheReply>* server,
+                             std::promise<grpc::Status>* status_promise) // clang-format off
+try // clang-format on
+{
+    mpl::ClientLogger<ImageCacheReply> logger{mpl::level_from(request->verbosity_level()), *config->logger, server};
+
+    const auto usage = config->vault->cache_usage();
+
+    ImageCacheReply reply;
+    reply.set_total_size(usage.total_size);
+    reply.set_budget(usage.budget);
+    for (const auto& image : usage.images)
+    {
+        auto entry = reply.add_images();
+        entry->set_id(image.id);
+        entry->set_release(image.release);
+        entry->set_remote_name(image.remote_name);
+        entry->set_size(image.size);
+        entry->set_last_accessed(
+            std::chrono::duration_cast<std::chrono::seconds>(image.last_accessed.time_since_epoch()).count());
+        entry->set_persistent(image.persistent);
+        entry->set_in_use(image.in_use);
+    }
+
+    server->Write(reply);
+    status_promise->set_value(grpc::Status::OK);
+}
+catch (const std::exception& e)
+{
+    status_promise->set_value(grpc::Status(grpc::StatusCode::FAILED_PRECONDITION, e.what(), ""));
+}
+
 void mp::Daemon::on_shutdown()
 {
 }
@@ -1775,31 +2430,54 @@ void mp::Daemon::on_suspend()
 
 void mp::Daemon::on_restart(const std::string& name)
 {
+    notify_watchers(watch_reply_for(name, mp::InstanceStatus::RESTARTING));
+
     auto future_watcher = create_future_watcher();
-    future_watcher->setFuture(QtConcurrent::run(this, &Daemon::async_wait_for_ready_all<StartReply>, nullptr,
+    future_watcher->setFuture(QtConcurrent::run(&instance_wait_pool, this,
+                                                &Daemon::async_wait_for_ready_all<StartReply>, nullptr,
                                                 std::vector<std::string>{name}, nullptr));
 }
 
 void mp::Daemon::persist_state_for(const std::string& name, const VirtualMachine::State& state)
 {
-    vm_instance_specs[name].state = state;
+    {
+        std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
+        vm_instance_specs[name].state = state;
+    }
+    record_observation(name, {state, {}, {}, 0});
     persist_instances();
+    notify_watchers(watch_reply_for(name, grpc_instance_status_for(state)));
 }
 
 void mp::Daemon::update_metadata_for(const std::string& name, const QJsonObject& metadata)
 {
-    vm_instance_specs[name].metadata = metadata;
+    {
+        std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
+        vm_instance_specs[name].metadata = metadata;
+    }
 
     persist_instances();
 }
 
 QJsonObject mp::Daemon::retrieve_metadata_for(const std::string& name)
 {
-    return vm_instance_specs[name].metadata;
+    std::shared_lock<decltype(instances_mutex)> lock{instances_mutex};
+    auto it = vm_instance_specs.find(name);
+    return it != vm_instance_specs.end() ? it->second.metadata : QJsonObject{};
 }
 
+// May be called from any thread. The write happens on the main thread, shortly after the first request since the last
+// write, and covers all the changes made until then.
 void mp::Daemon::persist_instances()
 {
+    if (!instances_dirty.exchange(true))
+        QMetaObject::invokeMethod(&persist_instances_timer, "start", Qt::QueuedConnection);
+}
+
+void mp::Daemon::write_instance_db()
+{
+    instances_dirty = false;
+
     auto vm_spec_to_json = [](const mp::VMSpecs& specs) -> QJsonObject {
         QJsonObject json;
         json.insert("num_cores", specs.num_cores);
@@ -1848,21 +2526,39 @@ void mp::Daemon::persist_instances()
         return json;
     };
     QJsonObject instance_records_json;
-    for (const auto& record : vm_instance_specs)
     {
-        auto key = QString::fromStdString(record.first);
-        instance_records_json.insert(key, vm_spec_to_json(record.second));
+        std::shared_lock<decltype(instances_mutex)> lock{instances_mutex};
+        for (const auto& record : vm_instance_specs)
+        {
+            auto key = QString::fromStdString(record.first);
+            instance_records_json.insert(key, vm_spec_to_json(record.second));
+        }
     }
     QDir data_dir{
         mp::utils::backend_directory_path(config->data_directory, config->factory->get_backend_directory_name())};
-    mp::write_json(instance_records_json, data_dir.filePath(instance_db_name));
+    try
+    {
+        mp::write_json(instance_records_json, data_dir.filePath(instance_db_name));
+    }
+    catch (const std::exception& e)
+    {
+        mpl::log(mpl::Level::error, category, fmt::format("Failed to save the instances: {}", e.what()));
+    }
 }
 
 void mp::Daemon::release_resources(const std::string& instance)
 {
     config->factory->remove_resources_for(instance);
     config->vault->remove(instance);
+
+    {
+        std::lock_guard<decltype(image_info_mutex)> lock{image_info_mutex};
+        instance_image_info.erase(instance);
+    }
+
+    std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
     vm_instance_specs.erase(instance);
+    instance_observations.erase(instance);
 }
 
 std::string mp::Daemon::check_instance_operational(const std::string& instance_name) const
@@ -1887,6 +2583,258 @@ std::string mp::Daemon::check_instance_exists(const std::string& instance_name)
     return {};
 }
 
+auto mp::Daemon::snapshot_instances(const std::vector<std::string>& names, bool include_deleted) const
+    -> std::vector<InstanceSnapshot>
+{
+    std::shared_lock<decltype(instances_mutex)> lock{instances_mutex};
+
+    auto snapshot_of = [this](const std::string& name) {
+        InstanceSnapshot snapshot{name, nullptr, {}, {}, false, false, nullopt};
+
+        auto it = vm_instances.find(name);
+        if (it == vm_instances.end())
+        {
+            it = deleted_instances.find(name);
+            if (it == deleted_instances.end())
+            {
+                snapshot.restoring = restoring_instances.find(name) != restoring_instances.end();
+                return snapshot;
+            }
+
+            snapshot.deleted = true;
+        }
+
+        snapshot.vm = it->second;
+
+        auto spec_it = vm_instance_specs.find(name);
+        if (spec_it != vm_instance_specs.end())
+            snapshot.specs = spec_it->second;
+
+        // Instances not observed yet are taken to be as they were last persisted
+        auto observation_it = instance_observations.find(name);
+        snapshot.observed = observation_it != instance_observations.end()
+                                ? observation_it->second
+                                : InstanceObservation{snapshot.specs.state, {}, {}, 0};
+
+        auto timer_it = delayed_shutdown_instances.find(name);
+        if (timer_it != delayed_shutdown_instances.end())
+        {
+            snapshot.shutdown_time_remaining = timer_it->second->get_time_remaining();
+            if (snapshot.observed.state == VirtualMachine::State::running)
+                snapshot.observed.state = VirtualMachine::State::delayed_shutdown;
+        }
+
+        return snapshot;
+    };
+
+    std::vector<InstanceSnapshot> snapshots;
+    if (names.empty())
+    {
+        // Instances still being restored are left out, as there is nothing to report on them but their name
+        for (const auto& instance : vm_instances)
+            snapshots.push_back(snapshot_of(instance.first));
+
+        if (include_deleted)
+            for (const auto& instance : deleted_instances)
+                snapshots.push_back(snapshot_of(instance.first));
+    }
+    else
+    {
+        for (const auto& name : names)
+            snapshots.push_back(snapshot_of(name));
+    }
+
+    return snapshots;
+}
+
+std::vector<std::string> mp::Daemon::restoring_instance_names() const
+{
+    std::shared_lock<decltype(instances_mutex)> lock{instances_mutex};
+    return {restoring_instances.begin(), restoring_instances.end()};
+}
+
+// Called on the main thread, as it asks the vault and the image hosts
+void mp::Daemon::look_up_image_info(const std::string& name)
+{
+    {
+        std::lock_guard<decltype(image_info_mutex)> lock{image_info_mutex};
+        if (instance_image_info.find(name) != instance_image_info.end())
+            return;
+    }
+
+    try
+    {
+        auto vm_image = fetch_image_for(name, config->factory->fetch_type(), *config->vault);
+        InstanceImageInfo image_info{vm_image.id, vm_image.original_release};
+
+        if (!image_info.id.empty() && image_info.release.empty())
+        {
+            auto vm_image_info = config->image_hosts.back()->info_for_full_hash(image_info.id);
+            image_info.release = vm_image_info.release_title.toStdString();
+        }
+
+        std::lock_guard<decltype(image_info_mutex)> lock{image_info_mutex};
+        instance_image_info[name] = image_info;
+    }
+    catch (const std::exception& e)
+    {
+        // Not cached, so that the lookup is tried again on the next telemetry refresh
+        mpl::log(mpl::Level::warning, category, fmt::format("Cannot fetch image information: {}", e.what()));
+    }
+}
+
+// Empty until the image is looked up
+mp::Daemon::InstanceImageInfo mp::Daemon::image_info_for(const std::string& name)
+{
+    std::lock_guard<decltype(image_info_mutex)> lock{image_info_mutex};
+    auto it = instance_image_info.find(name);
+    return it != instance_image_info.end() ? it->second : InstanceImageInfo{};
+}
+
+void mp::Daemon::notify_watchers(const WatchReply& reply)
+{
+    if (reply.instances().empty() && reply.removed_instances().empty())
+        return;
+
+    // Each client's own thread writes the updates out, so that none of them can hold up the daemon
+    std::lock_guard<decltype(watchers_mutex)> lock{watchers_mutex};
+    for (const auto& watcher : watchers)
+        watcher.first->push(reply);
+}
+
+bool mp::Daemon::erase_delayed_shutdown(const std::string& name)
+{
+    std::unique_ptr<DelayedShutdownTimer> timer;
+    {
+        std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
+        auto it = delayed_shutdown_instances.find(name);
+        if (it == delayed_shutdown_instances.end())
+            return false;
+
+        timer = std::move(it->second);
+        delayed_shutdown_instances.erase(it);
+    }
+
+    // The timer is destroyed here, outside the lock, as cancelling the shutdown talks to the instance
+    return true;
+}
+
+// Called on the main thread, as it asks the backend
+auto mp::Daemon::observe_instance(VirtualMachine& vm) -> InstanceObservation
+{
+    InstanceObservation observation{vm.current_state(), {}, {}, 0};
+    if (mp::utils::is_running(observation.state))
+    {
+        try
+        {
+            observation.ssh_hostname = vm.ssh_hostname(hostname_lookup_timeout);
+            observation.ssh_port = vm.ssh_port();
+            observation.ipv4 = vm.ipv4();
+        }
+        catch (const std::exception& e)
+        {
+            mpl::log(mpl::Level::debug, category, fmt::format("Cannot reach {}: {}", vm.vm_name, e.what()));
+            observation.ssh_hostname.clear();
+        }
+    }
+
+    return observation;
+}
+
+// May be called from any thread. The addresses of an instance that is still running are kept when it could not be
+// reached this time.
+void mp::Daemon::record_observation(const std::string& name, const InstanceObservation& observation)
+{
+    {
+        std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
+        auto& observed = instance_observations[name];
+        if (!mp::utils::is_running(observation.state) || !observation.ssh_hostname.empty())
+            observed = observation;
+        else
+            observed.state = observation.state;
+    }
+    instances_changed.notify_all();
+}
+
+// May be called from any thread, once the instance is reachable. Addresses found as the instance went down are dropped.
+void mp::Daemon::record_addresses(const std::string& name, const InstanceObservation& addresses)
+{
+    {
+        std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
+        auto it = instance_observations.find(name);
+        if (it == instance_observations.end() || !mp::utils::is_running(it->second.state))
+            return;
+
+        it->second.ipv4 = addresses.ipv4;
+        it->second.ssh_hostname = addresses.ssh_hostname;
+        it->second.ssh_port = addresses.ssh_port;
+    }
+    instances_changed.notify_all();
+}
+
+// Called on the main thread once an instance's disk and configuration are ready
+void mp::Daemon::register_instance(const std::string& name, const VirtualMachineDescription& vm_desc)
+{
+    VirtualMachine::ShPtr vm = config->factory->create_virtual_machine(vm_desc, *this);
+
+    {
+        std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
+        vm_instances[name] = std::move(vm);
+        vm_instance_specs[name] = {vm_desc.num_cores,
+                                   vm_desc.mem_size,
+                                   vm_desc.disk_space,
+                                   vm_desc.mac_addr,
+                                   config->ssh_username,
+                                   VirtualMachine::State::off,
+                                   {},
+                                   false,
+                                   QJsonObject()};
+    }
+    preparing_instances.erase(name);
+    look_up_image_info(name);
+
+    persist_instances();
+    notify_watchers(watch_reply_for(name, mp::InstanceStatus::STOPPED));
+}
+
+// Takes down an instance that failed to launch, the way "delete --purge" would
+void mp::Daemon::discard_instance(const std::string& name)
+{
+    preparing_instances.erase(name);
+
+    auto it = vm_instances.find(name);
+    const bool registered = it != vm_instances.end();
+    if (registered)
+    {
+        try
+        {
+            instance_mounts.stop_all_mounts_for_instance(name);
+            it->second->shutdown();
+        }
+        catch (const std::exception& e)
+        {
+            mpl::log(mpl::Level::warning, category, fmt::format("Cannot shut down {}: {}", name, e.what()));
+        }
+
+        guest_telemetry.forget(name);
+        ssh_sessions.drop(name);
+    }
+
+    release_resources(name);
+    {
+        std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
+        vm_instances.erase(name);
+    }
+    persist_instances();
+
+    if (registered)
+    {
+        WatchReply removal;
+        removal.add_removed_instances(name);
+        notify_watchers(removal);
+    }
+}
+
 void mp::Daemon::create_vm(const CreateRequest* request, grpc::ServerWriter<CreateReply>* server,
                            std::promise<grpc::Status>* status_promise, bool start)
 {
@@ -1910,7 +2858,8 @@ void mp::Daemon::create_vm(const CreateRequest* request, grpc::ServerWriter<Crea
                                                       create_error.SerializeAsString()));
     }
 
-    if (preparing_instances.find(name) != preparing_instances.end())
+    if (preparing_instances.find(name) != preparing_instances.end() ||
+        restoring_instances.find(name) != restoring_instances.end())
     {
         CreateError create_error;
         create_error.add_error_codes(CreateError::INSTANCE_EXISTS);
@@ -1932,21 +2881,7 @@ void mp::Daemon::create_vm(const CreateRequest* request, grpc::ServerWriter<Crea
         [this, server, status_promise, name, start, prepare_future_watcher] {
             try
             {
-                auto vm_desc = prepare_future_watcher->future().result();
-
-                vm_instances[name] = config->factory->create_virtual_machine(vm_desc, *this);
-                vm_instance_specs[name] = {vm_desc.num_cores,
-                                           vm_desc.mem_size,
-                                           vm_desc.disk_space,
-                                           vm_desc.mac_addr,
-                                           config->ssh_username,
-                                           VirtualMachine::State::off,
-                                           {},
-                                           false,
-                                           QJsonObject()};
-                preparing_instances.erase(name);
-
-                persist_instances();
+                register_instance(name, prepare_future_watcher->future().result());
 
                 if (start)
                 {
@@ -1963,7 +2898,8 @@ void mp::Daemon::create_vm(const CreateRequest* request, grpc::ServerWriter<Crea
                         config->update_prompt->populate_if_time_to_show(reply.mutable_update_info());
                         server->Write(reply);
                     });
-                    future_watcher->setFuture(QtConcurrent::run(this, &Daemon::async_wait_for_ready_all<LaunchReply>,
+                    future_watcher->setFuture(QtConcurrent::run(&instance_wait_pool, this,
+                                                                &Daemon::async_wait_for_ready_all<LaunchReply>,
                                                                 server, std::vector<std::string>{name},
                                                                 status_promise));
                 }
@@ -1974,104 +2910,138 @@ void mp::Daemon::create_vm(const CreateRequest* request, grpc::ServerWriter<Crea
             }
             catch (const std::exception& e)
             {
-                preparing_instances.erase(name);
-                release_resources(name);
-                vm_instances.erase(name);
-                persist_instances();
+                discard_instance(name);
                 status_promise->set_value(grpc::Status(grpc::StatusCode::FAILED_PRECONDITION, e.what(), ""));
             }
 
             delete prepare_future_watcher;
         });
 
+    auto mac_addr = generate_unused_mac_address(allocated_mac_addrs);
+
     prepare_future_watcher->setFuture(
-        QtConcurrent::run([this, server, request, name, checked_args]() -> VirtualMachineDescription {
+        QtConcurrent::run([this, server, request, name, checked_args, mac_addr]() -> VirtualMachineDescription {
             try
             {
-                auto query = query_from(request, name);
+                return prepare_instance(*config, request, name, checked_args.mem_size, checked_args.disk_space,
+                                        mac_addr, [server](const CreateReply& reply) { return server->Write(reply); });
+            }
+            catch (const std::exception& e)
+            {
+                throw CreateImageException(e.what());
+            }
+        }));
+}
 
-                auto progress_monitor = [server](int progress_type, int percentage) {
-                    CreateReply create_reply;
-                    create_reply.mutable_launch_progress()->set_percent_complete(std::to_string(percentage));
-                    create_reply.mutable_launch_progress()->set_type((CreateProgress::ProgressTypes)progress_type);
-                    return server->Write(create_reply);
-                };
+// Starts instances of the batch until max_parallel of them are booting; called again as each one is done
+void mp::Daemon::boot_next(const std::shared_ptr<LaunchBatch>& batch)
+{
+    while (batch->booting < batch->max_parallel && !batch->to_boot.empty())
+    {
+        auto name = batch->to_boot.front();
+        batch->to_boot.pop_front();
+        ++batch->booting;
 
-                auto prepare_action = [this, server, &name](const VMImage& source_image) -> VMImage {
-                    CreateReply reply;
-                    reply.set_create_message("Preparing image for " + name);
-                    server->Write(reply);
+        // Booting is queued like "start" is, so that other operations on the instance wait for it
+        operation_queue.schedule({name}, InstanceOperationQueue::Kind::start,
+                                 [this, batch, name](const auto& done) { boot_instance(batch, name, done); });
+    }
 
-                    return config->factory->prepare_source_image(source_image);
-                };
+    // Instances that fail right away finish their boot from within the loop above, which may get here first
+    if (batch->booting == 0 && batch->to_boot.empty() && !batch->finished)
+    {
+        batch->finished = true;
 
-                auto fetch_type = config->factory->fetch_type();
+        LaunchReply reply;
+        config->update_prompt->populate_if_time_to_show(reply.mutable_update_info());
+        if (reply.has_update_info())
+            batch->write(reply);
 
-                CreateReply reply;
-                reply.set_create_message("Creating " + name);
-                server->Write(reply);
-                auto vm_image = config->vault->fetch_image(fetch_type, query, prepare_action, progress_monitor);
+        if (batch->errors.empty())
+            return batch->status_promise->set_value(grpc::Status::OK);
 
-                // TODO: make this come from the image host
-                const auto& driver = utils::get_driver_str();
-                mp::MemorySize disk_space;
-                if (driver == "lxd")
-                {
-                    disk_space = *checked_args.disk_space;
-                }
-                else
-                {
-                    disk_space = compute_final_image_size(vm_image, checked_args.disk_space);
-                }
+        fmt::memory_buffer errors;
+        for (const auto& error : batch->errors)
+            fmt::format_to(errors, "{}\n", error);
 
-                reply.set_create_message("Configuring " + name);
-                server->Write(reply);
-                auto vendor_data_cloud_init_config =
-                    make_cloud_init_vendor_config(*config->ssh_key_provider, request->time_zone(), config->ssh_username,
-                                                  config->factory->get_backend_version_string().toStdString());
-                auto meta_data_cloud_init_config = make_cloud_init_meta_config(name);
-                auto user_data_cloud_init_config = YAML::Load(request->cloud_init_user_data());
-                prepare_user_data(user_data_cloud_init_config, vendor_data_cloud_init_config);
-
-                std::string mac_addr;
-                while (true)
-                {
-                    mac_addr = mp::utils::generate_mac_address();
+        batch->status_promise->set_value(grpc::Status(grpc::StatusCode::FAILED_PRECONDITION,
+                                                      "Some instances failed to launch", fmt::to_string(errors)));
+    }
+}
 
-                    auto it = allocated_mac_addrs.find(mac_addr);
-                    if (it == allocated_mac_addrs.end())
-                    {
-                        allocated_mac_addrs.insert(mac_addr);
-                        break;
-                    }
-                }
+void mp::Daemon::boot_instance(const std::shared_ptr<LaunchBatch>& batch, const std::string& name,
+                               const InstanceOperationQueue::Done& done)
+{
+    auto finish = [this, batch, name, done](const std::string& error) {
+        if (!error.empty())
+        {
+            // Failed instances are not kept, as they would hold on to resources that nobody asked for
+            discard_instance(name);
+            batch->errors.push_back(fmt::format("{}: {}", name, error));
+        }
+
+        --batch->booting;
+        done();
+        boot_next(batch);
+    };
 
-                auto vm_desc = to_machine_desc(request, name, checked_args.mem_size, disk_space, mac_addr,
-                                               config->ssh_username, vm_image, meta_data_cloud_init_config,
-                                               user_data_cloud_init_config, vendor_data_cloud_init_config);
+    try
+    {
+        auto it = vm_instances.find(name);
+        if (it == vm_instances.end())
+            throw std::runtime_error("instance was deleted before it started");
 
-                config->factory->prepare_instance_image(vm_image, vm_desc);
+        LaunchReply reply;
+        reply.set_create_message("Starting " + name);
+        batch->write(reply);
 
-                return vm_desc;
-            }
-            catch (const std::exception& e)
-            {
-                throw CreateImageException(e.what());
-            }
-        }));
+        it->second->start();
+    }
+    catch (const std::exception& e)
+    {
+        return finish(e.what());
+    }
+
+    auto boot_future_watcher = new QFutureWatcher<AsyncOperationStatus>();
+    QObject::connect(boot_future_watcher, &QFutureWatcher<AsyncOperationStatus>::finished,
+                     [batch, name, finish, boot_future_watcher] {
+                         auto status = boot_future_watcher->future().result().status;
+                         delete boot_future_watcher;
+
+                         if (status.ok())
+                         {
+                             LaunchReply reply;
+                             reply.set_vm_instance_name(name);
+                             batch->write(reply);
+                         }
+
+                         finish(status.ok() ? std::string{} : status.error_message());
+                     });
+
+    // Progress is not written from the wait, as it would race with the other instances' replies
+    boot_future_watcher->setFuture(QtConcurrent::run(
+        &instance_wait_pool, this, &Daemon::async_wait_for_ready_all<LaunchReply>,
+        static_cast<grpc::ServerWriter<LaunchReply>*>(nullptr), std::vector<std::string>{name},
+        static_cast<std::promise<grpc::Status>*>(nullptr)));
 }
 
 grpc::Status mp::Daemon::reboot_vm(VirtualMachine& vm)
 {
     if (vm.state == VirtualMachine::State::delayed_shutdown)
-        delayed_shutdown_instances.erase(vm.vm_name);
+        erase_delayed_shutdown(vm.vm_name);
 
     if (!mp::utils::is_running(vm.current_state()))
         return grpc::Status{grpc::StatusCode::INVALID_ARGUMENT,
                             fmt::format("instance \"{}\" is not running", vm.vm_name), ""};
 
     mpl::log(mpl::Level::debug, category, fmt::format("Rebooting {}", vm.vm_name));
-    return ssh_reboot(vm.ssh_hostname(), vm.ssh_port(), vm.ssh_username(), *config->ssh_key_provider);
+
+    // The pooled session goes down with the instance, and may be leased by a telemetry probe meanwhile, so the reboot
+    // goes over a session of its own
+    ssh_sessions.drop(vm.vm_name);
+    mp::SSHSession session{vm.ssh_hostname(), vm.ssh_port(), vm_instance_specs.at(vm.vm_name).ssh_username,
+                           *config->ssh_key_provider};
+    return ssh_reboot(session);
 }
 
 grpc::Status mp::Daemon::shutdown_vm(VirtualMachine& vm, const std::chrono::milliseconds delay)
@@ -2084,12 +3054,13 @@ grpc::Status mp::Daemon::shutdown_vm(VirtualMachine& vm, const std::chrono::mill
 
     if (std::none_of(cbegin(skip_states), cend(skip_states), [&state](const auto& st) { return state == st; }))
     {
-        delayed_shutdown_instances.erase(name);
+        erase_delayed_shutdown(name);
 
         mp::optional<mp::SSHSession> session;
         try
         {
-            session = mp::SSHSession{vm.ssh_hostname(), vm.ssh_port(), vm.ssh_username(), *config->ssh_key_provider};
+            session = mp::SSHSession{vm.ssh_hostname(), vm.ssh_port(), vm_instance_specs.at(name).ssh_username,
+                                     *config->ssh_key_provider};
         }
         catch (const std::exception& e)
         {
@@ -2097,14 +3068,20 @@ grpc::Status mp::Daemon::shutdown_vm(VirtualMachine& vm, const std::chrono::mill
                      fmt::format("Cannot open ssh session on \"{}\" shutdown: {}", name, e.what()));
         }
 
-        auto& shutdown_timer = delayed_shutdown_instances[name] = std::make_unique<DelayedShutdownTimer>(
+        auto shutdown_timer = std::make_unique<DelayedShutdownTimer>(
             &vm, std::move(session),
             std::bind(&SSHFSMounts::stop_all_mounts_for_instance, &instance_mounts, std::placeholders::_1));
 
         QObject::connect(shutdown_timer.get(), &DelayedShutdownTimer::finished,
-                         [this, name]() { delayed_shutdown_instances.erase(name); });
+                         [this, name]() { erase_delayed_shutdown(name); });
+
+        auto timer = shutdown_timer.get();
+        {
+            std::lock_guard<decltype(instances_mutex)> lock{instances_mutex};
+            delayed_shutdown_instances[name] = std::move(shutdown_timer);
+        }
 
-        shutdown_timer->start(delay);
+        timer->start(delay);
     }
     else
         mpl::log(mpl::Level::debug, category, fmt::format("instance \"{}\" does not need stopping", name));
@@ -2114,10 +3091,7 @@ grpc::Status mp::Daemon::shutdown_vm(VirtualMachine& vm, const std::chrono::mill
 
 grpc::Status mp::Daemon::cancel_vm_shutdown(const VirtualMachine& vm)
 {
-    auto it = delayed_shutdown_instances.find(vm.vm_name);
-    if (it != delayed_shutdown_instances.end())
-        delayed_shutdown_instances.erase(it);
-    else
+    if (!erase_delayed_shutdown(vm.vm_name))
         mpl::log(mpl::Level::debug, category,
                  fmt::format("no delayed shutdown to cancel on instance \"{}\"", vm.vm_name));
 
@@ -2138,6 +3112,116 @@ grpc::Status mp::Daemon::cmd_vms(const std::vector<std::string>& tgts, std::func
     return grpc::Status::OK;
 }
 
+void mp::Daemon::refresh_guest_telemetry()
+{
+    for (auto it = telemetry_probes.begin(); it != telemetry_probes.end();)
+        it = it->second.isFinished() ? telemetry_probes.erase(it) : std::next(it);
+
+    // The backends are asked here, on the main thread, so that the pool threads only talk to the instances. What they
+    // say is recorded for the requests served off the main thread.
+    for (const auto& snapshot : snapshot_instances({}, /*include_deleted=*/false))
+    {
+        // An instance that is still being probed skips this round, without holding up the others
+        if (telemetry_probes.count(snapshot.name) || !snapshot.vm)
+            continue;
+
+        look_up_image_info(snapshot.name); // in case it could not be looked up before
+
+        const auto observation = observe_instance(*snapshot.vm);
+        record_observation(snapshot.name, observation);
+        if (!mp::utils::is_running(observation.state))
+        {
+            guest_telemetry.forget(snapshot.name);
+            ssh_sessions.drop(snapshot.name);
+            continue;
+        }
+
+        const auto& hostname = observation.ssh_hostname;
+        if (hostname.empty())
+            continue;
+
+        auto probe = [this, name = snapshot.name, hostname, port = observation.ssh_port,
+                      username = snapshot.specs.ssh_username] {
+            try
+            {
+                guest_telemetry.refresh(name, hostname, port, username, telemetry_probe_timeout);
+            }
+            catch (const std::exception& e)
+            {
+                mpl::log(mpl::Level::debug, category,
+                         fmt::format("Cannot gather information from {}: {}", name, e.what()));
+            }
+        };
+        telemetry_probes.emplace(snapshot.name, QtConcurrent::run(&instance_wait_pool, probe));
+    }
+
+    const auto metrics = ssh_sessions.metrics();
+    mpl::log(mpl::Level::trace, category,
+             fmt::format("SSH sessions: {} handshakes, {} saved; {} channels opened in {}us on average, {}us at most",
+                         metrics.handshakes, metrics.handshakes_saved, metrics.channels_opened,
+                         metrics.channels_opened ? metrics.total_channel_open_time.count() / metrics.channels_opened
+                                                 : 0,
+                         metrics.max_channel_open_time.count()));
+}
+
+void mp::Daemon::prefetch_warm_images()
+{
+    QStringList warm_images;
+    try
+    {
+        warm_images = MP_SETTINGS.get(mp::warm_images_key).split(',', QString::SkipEmptyParts);
+    }
+    catch (const std::exception& e)
+    {
+        mpl::log(mpl::Level::warning, category, fmt::format("Cannot read the images to keep warm: {}", e.what()));
+        return;
+    }
+
+    auto prepare_action = [this](const VMImage& source_image) -> VMImage {
+        return config->factory->prepare_source_image(source_image);
+    };
+    auto download_monitor = [this](int, int) { return !shutting_down; };
+
+    for (const auto& image : warm_images)
+    {
+        if (shutting_down)
+            return;
+
+        // Each image is an alias, possibly preceded by its remote, as in "daily:focal"
+        const auto remote_and_alias = image.split(':');
+        const auto remote = remote_and_alias.size() > 1 ? remote_and_alias.first() : QString{};
+        const Query query{"", remote_and_alias.last().toStdString(), false, remote.toStdString(), Query::Type::Alias};
+
+        try
+        {
+            config->vault->prefetch_image(config->factory->fetch_type(), query, prepare_action, download_monitor,
+                                          config->prefetch_bandwidth_limit.in_bytes());
+        }
+        catch (const std::exception& e)
+        {
+            mpl::log(mpl::Level::warning, category, fmt::format("Cannot prefetch {}: {}", image, e.what()));
+        }
+    }
+}
+
+void mp::Daemon::schedule_operation(const std::vector<std::string>& instances, InstanceOperationQueue::Kind kind,
+                                    const InstanceOperationQueue::Operation& operation)
+{
+    // Operations that do not name any instance apply to all of them
+    if (!instances.empty())
+        return operation_queue.schedule(instances, kind, operation);
+
+    std::vector<std::string> all_instances;
+    for (const auto& instance : vm_instances)
+        all_instances.push_back(instance.first);
+    for (const auto& instance : deleted_instances)
+        all_instances.push_back(instance.first);
+    for (const auto& instance : restoring_instances)
+        all_instances.push_back(instance);
+
+    operation_queue.schedule(all_instances, kind, operation);
+}
+
 QFutureWatcher<mp::Daemon::AsyncOperationStatus>*
 mp::Daemon::create_future_watcher(std::function<void()> const& finished_op)
 {
@@ -2160,9 +3244,20 @@ error_string mp::Daemon::async_wait_for_ssh_and_start_mounts_for(const std::stri
     fmt::memory_buffer errors;
     try
     {
-        auto it = vm_instances.find(name);
-        auto vm = it->second;
+        auto ensure_not_shutting_down = [this] {
+            if (shutting_down)
+                throw std::runtime_error("the daemon is shutting down");
+        };
+        ensure_not_shutting_down();
+
+        auto snapshot = snapshot_instances({name}, /*include_deleted=*/false).front();
+        if (!snapshot.vm)
+            throw std::runtime_error(fmt::format("instance \"{}\" does not exist", name));
+
+        auto& vm = snapshot.vm;
         vm->wait_until_ssh_up(up_timeout);
+        ensure_not_shutting_down();
+        record_addresses(name, {VirtualMachine::State::running, vm->ipv4(), vm->ssh_hostname(), vm->ssh_port()});
 
         if (std::is_same<Reply, LaunchReply>::value)
         {
@@ -2173,14 +3268,16 @@ error_string mp::Daemon::async_wait_for_ssh_and_start_mounts_for(const std::stri
                 server->Write(reply);
             }
 
-            mp::utils::wait_for_cloud_init(vm.get(), cloud_init_timeout, *config->ssh_key_provider);
+            mp::utils::wait_for_cloud_init(vm.get(), cloud_init_timeout, *config->ssh_key_provider,
+                                           ensure_not_shutting_down);
         }
 
         std::vector<std::string> invalid_mounts;
-        auto& mounts = vm_instance_specs[name].mounts;
-        auto& vm_specs = vm_instance_specs[name];
-        for (const auto& mount_entry : mounts)
+        const auto& vm_specs = snapshot.specs;
+        for (const auto& mount_entry : vm_specs.mounts)
         {
+            ensure_not_shutting_down();
+
             auto& target_path = mount_entry.first;
             auto& source_path = mount_entry.second.source_path;
             auto& uid_map = mount_entry.second.uid_map;
@@ -2244,8 +3341,8 @@ mp::Daemon::AsyncOperationStatus mp::Daemon::async_wait_for_ready_all(grpc::Serv
             }
             else
             {
-                auto future =
-                    QtConcurrent::run(this, &Daemon::async_wait_for_ssh_and_start_mounts_for<Reply>, name, server);
+                auto future = QtConcurrent::run(&instance_wait_pool, this,
+                                                &Daemon::async_wait_for_ssh_and_start_mounts_for<Reply>, name, server);
                 async_running_futures[name] = future;
                 start_synchronizer.addFuture(future);
             }
@@ -20,22 +20,33 @@
 
 #include "daemon_config.h"
 #include "daemon_rpc.h"
+#include "guest_telemetry_collector.h"
+#include "instance_operation_queue.h"
+#include "watch_queue.h"
 
 #include <multipass/delayed_shutdown_timer.h>
 #include <multipass/memory_size.h>
 #include <multipass/metrics_provider.h>
+#include <multipass/optional.h>
 #include <multipass/sshfs_mount/sshfs_mounts.h>
 #include <multipass/virtual_machine.h>
+#include <multipass/virtual_machine_description.h>
 #include <multipass/vm_status_monitor.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <future>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include <QFutureWatcher>
+#include <QThreadPool>
 
 namespace multipass
 {
@@ -66,11 +77,13 @@ struct MetricsOptInData
 };
 
 struct DaemonConfig;
+class LazyVirtualMachine;
 class Daemon : public QObject, public multipass::VMStatusMonitor
 {
     Q_OBJECT
 public:
     explicit Daemon(std::unique_ptr<const DaemonConfig> config);
+    ~Daemon();
     Daemon(const Daemon&) = delete;
     Daemon& operator=(const Daemon&) = delete;
 
@@ -91,6 +104,9 @@ public slots:
     virtual void launch(const LaunchRequest* request, grpc::ServerWriter<LaunchReply>* reply,
                         std::promise<grpc::Status>* status_promise);
 
+    virtual void launch_many(const LaunchManyRequest* request, grpc::ServerWriter<LaunchReply>* reply,
+                             std::promise<grpc::Status>* status_promise);
+
     virtual void purge(const PurgeRequest* request, grpc::ServerWriter<PurgeReply>* response,
                        std::promise<grpc::Status>* status_promise);
 
@@ -133,18 +149,97 @@ public slots:
     virtual void version(const VersionRequest* request, grpc::ServerWriter<VersionReply>* response,
                          std::promise<grpc::Status>* status_promise);
 
+    virtual void watch(const WatchRequest* request, WatchQueue* updates, std::promise<grpc::Status>* status_promise);
+
+    virtual void unwatch(WatchQueue* updates);
+
+    virtual void image_cache(const ImageCacheRequest* request, grpc::ServerWriter<ImageCacheReply>* response,
+                             std::promise<grpc::Status>* status_promise);
+
 private:
+    // What the backend last said of an instance. Handlers running off the main thread report this, rather than ask the
+    // backends themselves.
+    struct InstanceObservation
+    {
+        VirtualMachine::State state;
+        std::string ipv4;
+        std::string ssh_hostname; // empty while the instance cannot be reached
+        int ssh_port;
+    };
+
+    // Copy of an instance's state, taken under a shared lock so that work running off the main thread can read it
+    struct InstanceSnapshot
+    {
+        std::string name;
+        VirtualMachine::ShPtr vm; // null if the instance does not exist
+        VMSpecs specs;
+        InstanceObservation observed;
+        bool deleted;
+        bool restoring; // the instance exists, but is not restored yet
+        optional<std::chrono::seconds> shutdown_time_remaining;
+    };
+
+    // The image an instance was created from never changes, so this is looked up once per instance
+    struct InstanceImageInfo
+    {
+        std::string id;
+        std::string release;
+    };
+
+    std::vector<InstanceSnapshot> snapshot_instances(const std::vector<std::string>& names,
+                                                     bool include_deleted) const;
+    std::vector<std::string> restoring_instance_names() const;
+    void restore_next_instance();
+    void restore_instance(const std::string& name);
+    VirtualMachine::ShPtr create_backend_vm_for(LazyVirtualMachine& placeholder,
+                                                const VirtualMachineDescription& vm_desc);
+    bool erase_delayed_shutdown(const std::string& name);
+    InstanceObservation observe_instance(VirtualMachine& vm);
+    void record_observation(const std::string& name, const InstanceObservation& observation);
+    void record_addresses(const std::string& name, const InstanceObservation& addresses);
+    void look_up_image_info(const std::string& name);
+    InstanceImageInfo image_info_for(const std::string& name);
+    void notify_watchers(const WatchReply& reply);
     void persist_instances();
+    void write_instance_db();
     void release_resources(const std::string& instance);
     std::string check_instance_operational(const std::string& instance_name) const;
     std::string check_instance_exists(const std::string& instance_name) const;
     void create_vm(const CreateRequest* request, grpc::ServerWriter<CreateReply>* server,
                    std::promise<grpc::Status>* status_promise, bool start);
+    void register_instance(const std::string& name, const VirtualMachineDescription& vm_desc);
+    void discard_instance(const std::string& name);
+    struct LaunchBatch;
+    void boot_next(const std::shared_ptr<LaunchBatch>& batch);
+    void boot_instance(const std::shared_ptr<LaunchBatch>& batch, const std::string& name,
+                       const InstanceOperationQueue::Done& done);
     grpc::Status reboot_vm(VirtualMachine& vm);
     grpc::Status shutdown_vm(VirtualMachine& vm, const std::chrono::milliseconds delay);
     grpc::Status cancel_vm_shutdown(const VirtualMachine& vm);
     grpc::Status cmd_vms(const std::vector<std::string>& tgts, std::function<grpc::Status(VirtualMachine&)> cmd);
     void install_sshfs(VirtualMachine* vm, const std::string& name);
+    void refresh_guest_telemetry();
+    void prefetch_warm_images();
+    void schedule_operation(const std::vector<std::string>& instances, InstanceOperationQueue::Kind kind,
+                            const InstanceOperationQueue::Operation& operation);
+    void mount_instances(const MountRequest* request, grpc::ServerWriter<MountReply>* server,
+                         std::promise<grpc::Status>* status_promise, const InstanceOperationQueue::Done& done);
+    void start_instances(const StartRequest* request, grpc::ServerWriter<StartReply>* server,
+                         std::promise<grpc::Status>* status_promise, const InstanceOperationQueue::Done& done);
+    void stop_instances(const StopRequest* request, grpc::ServerWriter<StopReply>* server,
+                        std::promise<grpc::Status>* status_promise, const InstanceOperationQueue::Done& done);
+    void suspend_instances(const SuspendRequest* request, grpc::ServerWriter<SuspendReply>* server,
+                           std::promise<grpc::Status>* status_promise, const InstanceOperationQueue::Done& done);
+    void restart_instances(const RestartRequest* request, grpc::ServerWriter<RestartReply>* server,
+                           std::promise<grpc::Status>* status_promise, const InstanceOperationQueue::Done& done);
+    void delete_instances(const DeleteRequest* request, grpc::ServerWriter<DeleteReply>* server,
+                          std::promise<grpc::Status>* status_promise, const InstanceOperationQueue::Done& done);
+    void umount_instances(const UmountRequest* request, grpc::ServerWriter<UmountReply>* server,
+                          std::promise<grpc::Status>* status_promise, const InstanceOperationQueue::Done& done);
+    void recover_instances(const RecoverRequest* request, grpc::ServerWriter<RecoverReply>* server,
+                           std::promise<grpc::Status>* status_promise, const InstanceOperationQueue::Done& done);
+    void purge_instances(const PurgeRequest* request, grpc::ServerWriter<PurgeReply>* server,
+                         std::promise<grpc::Status>* status_promise, const InstanceOperationQueue::Done& done);
 
     struct AsyncOperationStatus
     {
@@ -162,12 +257,31 @@ private:
     QFutureWatcher<AsyncOperationStatus>* create_future_watcher(std::function<void()> const& finished_op = []() {});
 
     std::unique_ptr<const DaemonConfig> config;
+    // Clients watching for changes to the instances. Kept ahead of the instances, which report changes as they go.
+    std::mutex watchers_mutex;
+    std::unordered_map<WatchQueue*, std::promise<grpc::Status>*> watchers;
+    // Guards the instance maps below. Modifications take it exclusively, around the modification only; handlers
+    // running off the main thread take it shared while they copy what they need (see snapshot_instances).
+    mutable std::shared_timed_mutex instances_mutex;
     std::unordered_map<std::string, VMSpecs> vm_instance_specs;
     std::unordered_map<std::string, VirtualMachine::ShPtr> vm_instances;
     std::unordered_map<std::string, VirtualMachine::ShPtr> deleted_instances;
     std::unordered_map<std::string, std::unique_ptr<DelayedShutdownTimer>> delayed_shutdown_instances;
+    std::unordered_set<std::string> restoring_instances; // known from the last run, but not restored yet
+    std::unordered_map<std::string, InstanceObservation> instance_observations;
+    // Notified when instances are restored or observed, for handlers waiting on them
+    std::condition_variable_any instances_changed;
     std::unordered_set<std::string> allocated_mac_addrs;
+    // Looked up on the main thread, read from any
+    std::mutex image_info_mutex;
+    std::unordered_map<std::string, InstanceImageInfo> instance_image_info;
+    // Requests to persist the instances that come in close together are served by a single write
+    QTimer persist_instances_timer;
+    std::atomic<bool> instances_dirty{false};
     std::unordered_map<std::string, VMImageHost*> remote_image_host_map;
+    // Read by handlers running on the gRPC threads, so kept ahead of the server, which waits for them as it goes away
+    SSHSessionPool ssh_sessions;
+    GuestTelemetryCollector guest_telemetry;
     DaemonRpc daemon_rpc;
     QTimer source_images_maintenance_task;
     MetricsProvider metrics_provider;
@@ -178,6 +292,18 @@ private:
     std::mutex start_mutex;
     std::unordered_set<std::string> preparing_instances;
     QFuture<void> image_update_future;
+    QTimer image_prefetch_task;
+    QFuture<void> image_prefetch_future;
+    QTimer telemetry_refresh_task;
+    std::unordered_map<std::string, QFuture<void>> telemetry_probes;
+    // Operations on an instance run in order, but do not wait for operations on other instances
+    InstanceOperationQueue operation_queue;
+    std::deque<std::function<void()>> pending_restores;
+    // Set when the daemon goes away, for work still running in the background to give up instead of holding it up
+    std::atomic<bool> shutting_down{false};
+    // Waiting for an instance to come up blocks a thread, so these waits get their own pool, sized for many instances
+    // booting at once. Kept last so that it finishes the waits before the members they use go away.
+    QThreadPool instance_wait_pool;
 };
 } // namespace multipass
 #endif // MULTIPASS_DAEMON_H
@@ -21,10 +21,12 @@
 #include "ubuntu_image_host.h"
 
 #include <multipass/client_cert_store.h>
+#include <multipass/constants.h>
 #include <multipass/logging/log.h>
 #include <multipass/logging/standard_logger.h>
 #include <multipass/name_generator.h>
 #include <multipass/platform.h>
+#include <multipass/settings.h>
 #include <multipass/ssh/openssh_key_provider.h>
 #include <multipass/ssl_cert_provider.h>
 #include <multipass/standard_paths.h>
@@ -132,10 +134,14 @@ std::unique_ptr<const mp::DaemonConfig> mp::DaemonConfigBuilder::build()
             hosts.push_back(image.get());
         }
 
+        if (!image_cache_budget)
+            image_cache_budget = mp::MemorySize{MP_SETTINGS.get(mp::image_cache_budget_key).toStdString()};
+
         vault = factory->create_image_vault(
             hosts, url_downloader.get(),
             mp::utils::backend_directory_path(cache_directory, factory->get_backend_directory_name()),
-            mp::utils::backend_directory_path(data_directory, factory->get_backend_directory_name()), days_to_expire);
+            mp::utils::backend_directory_path(data_directory, factory->get_backend_directory_name()), days_to_expire,
+            *image_cache_budget);
     }
     if (name_generator == nullptr)
         name_generator = mp::make_default_name_generator();
@@ -159,5 +165,6 @@ std::unique_ptr<const mp::DaemonConfig> mp::DaemonConfigBuilder::build()
         std::move(url_downloader), std::move(factory), std::move(image_hosts), std::move(vault),
         std::move(name_generator), std::move(ssh_key_provider), std::move(cert_provider), std::move(client_cert_store),
         std::move(update_prompt), multiplexing_logger, std::move(network_proxy), cache_directory, data_directory,
-        server_address, ssh_username, connection_type, image_refresh_timer});
+        server_address, ssh_username, connection_type, image_refresh_timer, telemetry_refresh_interval,
+        image_prefetch_interval, prefetch_bandwidth_limit});
 }
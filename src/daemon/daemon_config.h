@@ -23,7 +23,9 @@
 #include <multipass/days.h>
 #include <multipass/logging/logger.h>
 #include <multipass/logging/multiplexing_logger.h>
+#include <multipass/memory_size.h>
 #include <multipass/name_generator.h>
+#include <multipass/optional.h>
 #include <multipass/path.h>
 #include <multipass/rpc/multipass.grpc.pb.h>
 #include <multipass/rpc_connection_type.h>
@@ -61,6 +63,9 @@ struct DaemonConfig
     const std::string ssh_username;
     const RpcConnectionType connection_type;
     const std::chrono::hours image_refresh_timer;
+    const std::chrono::seconds telemetry_refresh_interval;
+    const std::chrono::milliseconds image_prefetch_interval;
+    const MemorySize prefetch_bandwidth_limit; // per second
 };
 
 struct DaemonConfigBuilder
@@ -81,7 +86,12 @@ struct DaemonConfigBuilder
     std::string server_address;
     std::string ssh_username;
     multipass::days days_to_expire{14};
+    // Least recently used images are evicted beyond it. Taken from the settings when not given.
+    multipass::optional<multipass::MemorySize> image_cache_budget;
     std::chrono::hours image_refresh_timer{6};
+    std::chrono::seconds telemetry_refresh_interval{10};
+    std::chrono::milliseconds image_prefetch_interval{std::chrono::minutes{5}}; // as often as manifests are refreshed
+    multipass::MemorySize prefetch_bandwidth_limit{"10M"};
     multipass::logging::Level verbosity_level{multipass::logging::Level::info};
     RpcConnectionType connection_type{RpcConnectionType::ssl};
 
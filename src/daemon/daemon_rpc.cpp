@@ -22,6 +22,7 @@
 #include <multipass/logging/log.h>
 #include <multipass/virtual_machine_factory.h>
 
+#include <algorithm>
 #include <chrono>
 #include <stdexcept>
 
@@ -31,6 +32,8 @@ namespace mpl = multipass::logging;
 namespace
 {
 constexpr auto category = "rpc";
+constexpr auto watch_poll_interval = std::chrono::milliseconds(500);
+constexpr auto max_queued_watch_updates = 64u; // beyond which updates are folded together
 
 void throw_if_server_exists(const std::string& address)
 {
@@ -102,6 +105,12 @@ mp::DaemonRpc::DaemonRpc(const std::string& server_address, mp::RpcConnectionTyp
     mpl::log(mpl::Level::info, category, fmt::format("gRPC listening on {}, SSL:{}", server_address, ssl_enabled));
 }
 
+mp::DaemonRpc::~DaemonRpc()
+{
+    // Let long-lived calls such as watch return, since shutting the server down waits for them
+    shutting_down = true;
+}
+
 grpc::Status mp::DaemonRpc::create(grpc::ServerContext* context, const CreateRequest* request,
                                    grpc::ServerWriter<CreateReply>* reply)
 {
@@ -116,6 +125,13 @@ grpc::Status mp::DaemonRpc::launch(grpc::ServerContext* context, const LaunchReq
         std::bind(&DaemonRpc::on_launch, this, request, reply, std::placeholders::_1));
 }
 
+grpc::Status mp::DaemonRpc::launch_many(grpc::ServerContext* context, const LaunchManyRequest* request,
+                                        grpc::ServerWriter<LaunchReply>* reply)
+{
+    return emit_signal_and_wait_for_result(
+        std::bind(&DaemonRpc::on_launch_many, this, request, reply, std::placeholders::_1));
+}
+
 grpc::Status mp::DaemonRpc::purge(grpc::ServerContext* context, const PurgeRequest* request,
                                   grpc::ServerWriter<PurgeReply>* response)
 {
@@ -214,6 +230,39 @@ grpc::Status mp::DaemonRpc::version(grpc::ServerContext* context, const VersionR
         std::bind(&DaemonRpc::on_version, this, request, response, std::placeholders::_1));
 }
 
+grpc::Status mp::DaemonRpc::watch(grpc::ServerContext* context, const WatchRequest* request,
+                                  grpc::ServerWriter<WatchReply>* response)
+{
+    WatchQueue updates{max_queued_watch_updates};
+    std::promise<grpc::Status> status_promise;
+    auto status_future = status_promise.get_future();
+    emit on_watch(request, &updates, &status_promise);
+
+    // The updates are written from here, so that a client that is slow to read holds up nothing else. Nothing is
+    // written while instances are idle, so check every now and then whether the client went away.
+    while (status_future.wait_for(std::chrono::seconds::zero()) != std::future_status::ready)
+    {
+        const auto replies = updates.take(watch_poll_interval);
+        const auto written = std::all_of(replies.cbegin(), replies.cend(),
+                                         [response](const WatchReply& reply) { return response->Write(reply); });
+
+        if (!written || context->IsCancelled() || shutting_down)
+        {
+            emit on_unwatch(&updates);
+            break;
+        }
+    }
+
+    return status_future.get();
+}
+
+grpc::Status mp::DaemonRpc::image_cache(grpc::ServerContext* context, const ImageCacheRequest* request,
+                                        grpc::ServerWriter<ImageCacheReply>* response)
+{
+    return emit_signal_and_wait_for_result(
+        std::bind(&DaemonRpc::on_image_cache, this, request, response, std::placeholders::_1));
+}
+
 grpc::Status mp::DaemonRpc::ping(grpc::ServerContext* context, const PingRequest* request, PingReply* response)
 {
     return grpc::Status::OK;
@@ -19,6 +19,7 @@
 #define MULTIPASS_DAEMON_RPC_H
 
 #include "daemon_config.h"
+#include "watch_queue.h"
 
 #include <multipass/cert_provider.h>
 #include <multipass/rpc/multipass.grpc.pb.h>
@@ -28,6 +29,7 @@
 
 #include <QObject>
 
+#include <atomic>
 #include <future>
 #include <memory>
 
@@ -45,6 +47,7 @@ class DaemonRpc : public QObject, public multipass::Rpc::Service
 public:
     DaemonRpc(const std::string& server_address, multipass::RpcConnectionType type, const CertProvider& cert_provider,
               const CertStore& client_cert_store);
+    ~DaemonRpc();
     DaemonRpc(const DaemonRpc&) = delete;
     DaemonRpc& operator=(const DaemonRpc&) = delete;
 
@@ -53,6 +56,8 @@ signals:
                    std::promise<grpc::Status>* status_promise);
     void on_launch(const LaunchRequest* request, grpc::ServerWriter<LaunchReply>* reply,
                    std::promise<grpc::Status>* status_promise);
+    void on_launch_many(const LaunchManyRequest* request, grpc::ServerWriter<LaunchReply>* reply,
+                        std::promise<grpc::Status>* status_promise);
     void on_purge(const PurgeRequest* request, grpc::ServerWriter<PurgeReply>* response,
                   std::promise<grpc::Status>* status_promise);
     void on_find(const FindRequest* request, grpc::ServerWriter<FindReply>* response,
@@ -81,9 +86,14 @@ signals:
                    std::promise<grpc::Status>* status_promise);
     void on_version(const VersionRequest* request, grpc::ServerWriter<VersionReply>* response,
                     std::promise<grpc::Status>* status_promise);
+    void on_watch(const WatchRequest* request, WatchQueue* updates, std::promise<grpc::Status>* status_promise);
+    void on_unwatch(WatchQueue* updates);
+    void on_image_cache(const ImageCacheRequest* request, grpc::ServerWriter<ImageCacheReply>* response,
+                        std::promise<grpc::Status>* status_promise);
 
 private:
     const std::string server_address;
+    std::atomic<bool> shutting_down{false};
     const std::unique_ptr<grpc::Server> server;
 
 protected:
@@ -91,6 +101,8 @@ protected:
                         grpc::ServerWriter<CreateReply>* reply) override;
     grpc::Status launch(grpc::ServerContext* context, const LaunchRequest* request,
                         grpc::ServerWriter<LaunchReply>* reply) override;
+    grpc::Status launch_many(grpc::ServerContext* context, const LaunchManyRequest* request,
+                             grpc::ServerWriter<LaunchReply>* reply) override;
     grpc::Status purge(grpc::ServerContext* context, const PurgeRequest* request,
                        grpc::ServerWriter<PurgeReply>* response) override;
     grpc::Status find(grpc::ServerContext* context, const FindRequest* request,
@@ -119,6 +131,10 @@ protected:
                         grpc::ServerWriter<UmountReply>* response) override;
     grpc::Status version(grpc::ServerContext* context, const VersionRequest* request,
                          grpc::ServerWriter<VersionReply>* response) override;
+    grpc::Status watch(grpc::ServerContext* context, const WatchRequest* request,
+                       grpc::ServerWriter<WatchReply>* response) override;
+    grpc::Status image_cache(grpc::ServerContext* context, const ImageCacheRequest* request,
+                             grpc::ServerWriter<ImageCacheReply>* response) override;
     grpc::Status ping(grpc::ServerContext* context, const PingRequest* request, PingReply* response) override;
 };
 } // namespace multipass
@@ -33,13 +33,23 @@
 #include <multipass/format.h>
 
 #include <QCryptographicHash>
+#include <QDirIterator>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QUrl>
 #include <QtConcurrent/QtConcurrent>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <unordered_set>
 
 namespace mp = multipass;
 namespace mpl = multipass::logging;
@@ -85,6 +95,7 @@ auto image_to_json(const mp::VMImage& image)
         aliases.append(alias_entry);
     }
     json.insert("aliases", aliases);
+    json.insert("backing_image_path", image.backing_image_path);
 
     return json;
 }
@@ -144,6 +155,8 @@ std::unordered_map<std::string, mp::VaultRecord> load_db(const QString& db_name)
             aliases.push_back(alias);
         }
 
+        auto backing_image_path = image["backing_image_path"].toString();
+
         auto query = record["query"].toObject();
         if (query.isEmpty())
             return {};
@@ -168,7 +181,8 @@ std::unordered_map<std::string, mp::VaultRecord> load_db(const QString& db_name)
         }
 
         reconstructed_records[key] = {
-            {image_path, kernel_path, initrd_path, image_id, original_release, current_release, release_date, aliases},
+            {image_path, kernel_path, initrd_path, image_id, original_release, current_release, release_date, aliases,
+             backing_image_path},
             {"", release.toStdString(), persistent.toBool(), remote_name.toStdString(), query_type},
             last_accessed};
     }
@@ -186,7 +200,9 @@ QString copy(const QString& file_name, const QDir& output_dir)
     QFileInfo info{file_name};
     const auto source_name = info.fileName();
     auto new_path = output_dir.filePath(source_name);
-    QFile::copy(file_name, new_path);
+    if (!mp::platform::copy_file(QFile::encodeName(file_name).constData(), QFile::encodeName(new_path).constData()))
+        throw std::runtime_error(fmt::format("Cannot copy {}: {}", file_name, std::strerror(errno)));
+
     return new_path;
 }
 
@@ -207,18 +223,11 @@ void remove_source_images(const mp::VMImage& source_image, const mp::VMImage& pr
         delete_file(source_image.initrd_path);
 }
 
-void verify_image_download(const mp::Path& image_path, const std::string& image_hash)
+void verify_image_download(const mp::Path& image_path, const QCryptographicHash& hash, const std::string& image_hash)
 {
-    QFile image_file(image_path);
-    if (!image_file.open(QFile::ReadOnly))
-    {
-        throw std::runtime_error("Cannot open image file for computing hash");
-    }
-
-    QCryptographicHash hash(QCryptographicHash::Sha256);
-    if (!hash.addData(&image_file))
+    if (!QFileInfo::exists(image_path))
     {
-        throw std::runtime_error("Cannot read image file to compute hash");
+        throw std::runtime_error("Downloaded image file is missing");
     }
 
     if (hash.result().toHex().toStdString() != image_hash)
@@ -239,6 +248,108 @@ void delete_image_dir(const mp::Path& image_path)
     }
 }
 
+QString image_dir_of(const mp::VMImage& image)
+{
+    return QFileInfo(image.image_path).absolutePath();
+}
+
+qint64 disk_usage(const QString& path)
+{
+    qint64 usage{0};
+    QDirIterator it{path, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories};
+    while (it.hasNext())
+    {
+        it.next();
+        usage += it.fileInfo().size();
+    }
+
+    return usage;
+}
+
+// Reports downloads that run at the same time as one progress, over the bytes of all of them, so that the client
+// doesn't flip between them. They stop together once the monitor says so.
+class CombinedProgress
+{
+public:
+    CombinedProgress(const mp::ProgressMonitor& monitor, int download_type)
+        : monitor{monitor}, download_type{download_type}
+    {
+    }
+
+    // Downloads are all added before any of them starts. Those of unknown size count for nothing, as there is no
+    // telling how far along they are.
+    mp::ProgressMonitor add(int64_t size)
+    {
+        sizes.push_back(std::max(size, int64_t{0}));
+        downloaded.push_back(0);
+
+        return [this, index = sizes.size() - 1](int, int progress) { return report(index, progress); };
+    }
+
+private:
+    bool report(std::size_t index, int progress)
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        if (cancelled)
+            return false;
+
+        if (progress >= 0)
+            downloaded[index] = sizes[index] * progress / 100;
+
+        const auto total = std::accumulate(sizes.cbegin(), sizes.cend(), int64_t{0});
+        const auto done = std::accumulate(downloaded.cbegin(), downloaded.cend(), int64_t{0});
+        cancelled = !monitor(download_type, total > 0 ? static_cast<int>((100 * done + total / 2) / total) : -1);
+
+        return !cancelled;
+    }
+
+    const mp::ProgressMonitor monitor;
+    const int download_type;
+    std::vector<int64_t> sizes;
+    std::vector<int64_t> downloaded;
+    bool cancelled{false};
+    std::mutex mutex;
+};
+
+// Holds the image download back, so that it averages no more than bytes_per_second until something waits on it
+mp::ProgressMonitor make_throttled_monitor(const mp::ProgressMonitor& monitor, int64_t size, int64_t bytes_per_second,
+                                          std::shared_ptr<std::atomic_bool> waited_on)
+{
+    if (bytes_per_second <= 0 || size <= 0)
+        return monitor;
+
+    const auto start = std::chrono::steady_clock::now();
+    return [monitor, size, bytes_per_second, waited_on, start](int download_type, int progress) {
+        if (download_type == mp::LaunchProgress::IMAGE && progress > 0 && !*waited_on)
+        {
+            const auto due = start + std::chrono::milliseconds(size * progress / 100 * 1000 / bytes_per_second);
+
+            // Short naps keep the download from timing out, and let it speed up soon after it is waited on. It gets
+            // called again for as long as data keeps coming.
+            constexpr std::chrono::steady_clock::duration max_nap = std::chrono::milliseconds(500);
+            const auto now = std::chrono::steady_clock::now();
+            if (now < due)
+                std::this_thread::sleep_for(std::min(due - now, max_nap));
+        }
+
+        return monitor(download_type, progress);
+    };
+}
+
+// Lowers the calling thread's disk priority for as long as it exists
+class BackgroundIOPriority
+{
+public:
+    BackgroundIOPriority()
+    {
+        mp::platform::set_background_io_priority(true);
+    }
+    ~BackgroundIOPriority()
+    {
+        mp::platform::set_background_io_priority(false);
+    }
+};
+
 class DeleteOnException
 {
 public:
@@ -260,7 +371,8 @@ private:
 } // namespace
 
 mp::DefaultVMImageVault::DefaultVMImageVault(std::vector<VMImageHost*> image_hosts, URLDownloader* downloader,
-                                             mp::Path cache_dir_path, mp::Path data_dir_path, mp::days days_to_expire)
+                                             mp::Path cache_dir_path, mp::Path data_dir_path, mp::days days_to_expire,
+                                             const CreateOverlay& create_overlay, const MemorySize& cache_size_budget)
     : image_hosts{image_hosts},
       url_downloader{downloader},
       cache_dir{QDir(cache_dir_path).filePath("vault")},
@@ -268,6 +380,8 @@ mp::DefaultVMImageVault::DefaultVMImageVault(std::vector<VMImageHost*> image_hos
       instances_dir(data_dir.filePath("instances")),
       images_dir(cache_dir.filePath("images")),
       days_to_expire{days_to_expire},
+      create_overlay{create_overlay},
+      cache_size_budget{cache_size_budget},
       prepared_image_records{load_db(cache_dir.filePath(image_db_name))},
       instance_image_records{load_db(data_dir.filePath(instance_db_name))}
 {
@@ -278,6 +392,13 @@ mp::DefaultVMImageVault::DefaultVMImageVault(std::vector<VMImageHost*> image_hos
             remote_image_host_map[remote] = image_host;
         }
     }
+
+    for (const auto& record : instance_image_records)
+    {
+        const auto& backing_image_path = record.second.image.backing_image_path;
+        if (!backing_image_path.isEmpty())
+            ++backing_image_refs[backing_image_path.toStdString()];
+    }
 }
 
 mp::DefaultVMImageVault::~DefaultVMImageVault()
@@ -325,8 +446,12 @@ mp::VMImage mp::DefaultVMImageVault::fetch_image(const FetchType& fetch_type, co
         {
             auto info = get_kernel_query_info(query.name);
 
-            source_image =
-                fetch_kernel_and_initrd(info, source_image, QFileInfo(source_image.image_path).absoluteDir(), monitor);
+            CombinedProgress progress{monitor, LaunchProgress::KERNEL};
+            const auto kernel_monitor = progress.add(url_downloader->content_length(info.kernel_location));
+            const auto initrd_monitor = progress.add(url_downloader->content_length(info.initrd_location));
+
+            source_image = fetch_kernel_and_initrd(info, source_image, QFileInfo(source_image.image_path).absoluteDir(),
+                                                   kernel_monitor, initrd_monitor);
         }
 
         vm_image = prepare(source_image);
@@ -400,7 +525,8 @@ mp::VMImage mp::DefaultVMImageVault::fetch_image(const FetchType& fetch_type, co
                 // Had to use std::bind here to workaround the 5 allowable function arguments constraint of
                 // QtConcurrent::run()
                 future = QtConcurrent::run(std::bind(&DefaultVMImageVault::download_and_prepare_source_image, this,
-                                                     info, source_image, image_dir, fetch_type, prepare, monitor));
+                                                     info, source_image, image_dir, fetch_type, prepare, monitor,
+                                                     true));
 
                 in_progress_image_fetches[id] = future;
             }
@@ -424,27 +550,29 @@ mp::VMImage mp::DefaultVMImageVault::fetch_image(const FetchType& fetch_type, co
             std::lock_guard<decltype(fetch_mutex)> lock{fetch_mutex};
             if (!query.name.empty())
             {
-                for (auto& record : prepared_image_records)
+                // The id is the image's hash, so an image reached through another remote is just as good. It comes
+                // before older images under the same alias, which a prefetch may have left behind.
+                auto record = prepared_image_records.find(id);
+                if (record == prepared_image_records.end())
+                    record = std::find_if(prepared_image_records.begin(), prepared_image_records.end(),
+                                          [&query](const auto& other) {
+                                              const auto& aliases = other.second.image.aliases;
+                                              return other.second.query.remote_name == query.remote_name &&
+                                                     std::find(aliases.cbegin(), aliases.cend(), query.release) !=
+                                                         aliases.cend();
+                                          });
+
+                if (record != prepared_image_records.end())
                 {
-                    if (record.second.query.remote_name != query.remote_name)
-                        continue;
-
-                    const auto aliases = record.second.image.aliases;
-                    if (id == record.first ||
-                        std::find(aliases.cbegin(), aliases.cend(), query.release) != aliases.cend())
+                    const auto prepared_image = record->second.image;
+                    try
+                    {
+                        return finalize_image_records(query, prepared_image, record->first);
+                    }
+                    catch (const std::exception& e)
                     {
-                        const auto prepared_image = record.second.image;
-                        try
-                        {
-                            return finalize_image_records(query, prepared_image, record.first);
-                        }
-                        catch (const std::exception& e)
-                        {
-                            mpl::log(mpl::Level::warning, category,
-                                     fmt::format("Cannot create instance image: {}", e.what()));
-
-                            break;
-                        }
+                        mpl::log(mpl::Level::warning, category,
+                                 fmt::format("Cannot create instance image: {}", e.what()));
                     }
                 }
             }
@@ -454,16 +582,21 @@ mp::VMImage mp::DefaultVMImageVault::fetch_image(const FetchType& fetch_type, co
             {
                 monitor(LaunchProgress::WAITING, -1);
                 future = *running_future;
+
+                auto prefetch = prefetches_waited_on.find(id);
+                if (prefetch != prefetches_waited_on.end())
+                    *prefetch->second = true;
             }
             else
             {
-                const auto image_dir =
-                    mp::utils::make_dir(images_dir, QString("%1-%2").arg(info.release).arg(info.version));
+                // Images are kept under their hash, which is what their id is
+                const auto image_dir = mp::utils::make_dir(images_dir, info.id);
 
                 // Had to use std::bind here to workaround the 5 allowable function arguments constraint of
                 // QtConcurrent::run()
                 future = QtConcurrent::run(std::bind(&DefaultVMImageVault::download_and_prepare_source_image, this,
-                                                     info, source_image, image_dir, fetch_type, prepare, monitor));
+                                                     info, source_image, image_dir, fetch_type, prepare, monitor,
+                                                     false));
 
                 in_progress_image_fetches[id] = future;
             }
@@ -491,10 +624,19 @@ mp::VMImage mp::DefaultVMImageVault::fetch_image(const FetchType& fetch_type, co
 
 void mp::DefaultVMImageVault::remove(const std::string& name)
 {
+    std::lock_guard<decltype(fetch_mutex)> lock{fetch_mutex};
     const auto& name_entry = instance_image_records.find(name);
     if (name_entry == instance_image_records.end())
         return;
 
+    const auto& backing_image_path = name_entry->second.image.backing_image_path;
+    if (!backing_image_path.isEmpty())
+    {
+        auto refs = backing_image_refs.find(backing_image_path.toStdString());
+        if (refs != backing_image_refs.end() && --refs->second <= 0)
+            backing_image_refs.erase(refs);
+    }
+
     QDir instance_dir{instances_dir};
     if (instance_dir.cd(QString::fromStdString(name)))
         instance_dir.removeRecursively();
@@ -513,37 +655,92 @@ void mp::DefaultVMImageVault::prune_expired_images()
     std::vector<decltype(prepared_image_records)::key_type> expired_keys;
     std::lock_guard<decltype(fetch_mutex)> lock{fetch_mutex};
 
+    // Images with the same contents share a directory, which is only removed along with the last of them
+    std::unordered_map<std::string, int> image_dir_refs;
+    std::unordered_set<std::string> image_paths;
+    for (const auto& record : prepared_image_records)
+    {
+        ++image_dir_refs[image_dir_of(record.second.image).toStdString()];
+        image_paths.insert(QFileInfo(record.second.image.image_path).absoluteFilePath().toStdString());
+    }
+
+    auto evict = [this, &image_dir_refs](const std::string& key) {
+        const auto image_path = prepared_image_records[key].image.image_path;
+        auto refs = image_dir_refs.find(QFileInfo(image_path).absolutePath().toStdString());
+        if (refs != image_dir_refs.end() && --refs->second <= 0)
+        {
+            delete_image_dir(image_path);
+            image_dir_refs.erase(refs);
+        }
+
+        prepared_image_records.erase(key);
+    };
+
     for (const auto& record : prepared_image_records)
     {
         // Expire source images if they aren't persistent and haven't been accessed in 14 days
         if (record.second.query.query_type == Query::Type::Alias && !record.second.query.persistent &&
             record.second.last_accessed + days_to_expire <= std::chrono::system_clock::now())
         {
+            if (backs_instance_images(image_dir_of(record.second.image)))
+            {
+                mpl::log(mpl::Level::debug, category,
+                         fmt::format("Source image {} is expired, but instances are still based on it. Keeping it.",
+                                     record.second.query.release));
+                continue;
+            }
+
             mpl::log(
                 mpl::Level::info, category,
                 fmt::format("Source image {} is expired. Removing it from the cache.", record.second.query.release));
             expired_keys.push_back(record.first);
-            delete_image_dir(record.second.image.image_path);
         }
     }
 
+    for (const auto& key : expired_keys)
+        evict(key);
+
     // Remove any image directories that have no corresponding database entry
     for (const auto& entry : images_dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot))
     {
-        if (std::find_if(prepared_image_records.cbegin(), prepared_image_records.cend(),
-                         [&entry](const std::pair<std::string, VaultRecord>& record) {
-                             return record.second.image.image_path.contains(entry.absoluteFilePath());
-                         }) == prepared_image_records.cend())
+        const auto entry_path = entry.absoluteFilePath();
+        if (image_dir_refs.find(entry_path.toStdString()) == image_dir_refs.end() &&
+            image_paths.find(entry_path.toStdString()) == image_paths.end() && !backs_instance_images(entry_path))
         {
             mpl::log(mpl::Level::info, category,
-                     fmt::format("Source image {} is no longer valid. Removing it from the cache.",
-                                 entry.absoluteFilePath()));
-            delete_image_dir(entry.absoluteFilePath());
+                     fmt::format("Source image {} is no longer valid. Removing it from the cache.", entry_path));
+            delete_image_dir(entry_path);
         }
     }
 
-    for (const auto& key : expired_keys)
-        prepared_image_records.erase(key);
+    // Then remove the least recently used images until the cache fits its budget
+    const auto budget = cache_size_budget.in_bytes();
+    if (budget > 0)
+    {
+        auto total_size = disk_usage(images_dir.absolutePath());
+
+        std::vector<std::pair<std::chrono::system_clock::time_point, std::string>> candidates;
+        for (const auto& record : prepared_image_records)
+        {
+            if (!record.second.query.persistent && !backs_instance_images(image_dir_of(record.second.image)))
+                candidates.emplace_back(record.second.last_accessed, record.first);
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        for (auto it = candidates.cbegin(); it != candidates.cend() && total_size > budget; ++it)
+        {
+            const auto image_dir = image_dir_of(prepared_image_records[it->second].image);
+            const auto image_size = disk_usage(image_dir);
+
+            mpl::log(mpl::Level::info, category,
+                     fmt::format("Removing least recently used source image {} to keep the cache under {} bytes.",
+                                 prepared_image_records[it->second].query.release, budget));
+            evict(it->second);
+
+            if (!QFileInfo::exists(image_dir))
+                total_size -= image_size;
+        }
+    }
 
     persist_image_records();
 }
@@ -553,7 +750,7 @@ void mp::DefaultVMImageVault::update_images(const FetchType& fetch_type, const P
 {
     mpl::log(mpl::Level::debug, category, "Checking for images to update…");
 
-    std::vector<decltype(prepared_image_records)::key_type> keys_to_update;
+    std::vector<std::pair<decltype(prepared_image_records)::key_type, std::string>> keys_to_update; // with new ids
     for (const auto& record : prepared_image_records)
     {
         if (record.second.query.query_type == Query::Type::Alias &&
@@ -564,7 +761,7 @@ void mp::DefaultVMImageVault::update_images(const FetchType& fetch_type, const P
                 auto info = info_for(record.second.query);
                 if (info.id.toStdString() != record.first)
                 {
-                    keys_to_update.push_back(record.first);
+                    keys_to_update.emplace_back(record.first, info.id.toStdString());
                 }
             }
             catch (const mp::UnsupportedImageException& e)
@@ -574,17 +771,33 @@ void mp::DefaultVMImageVault::update_images(const FetchType& fetch_type, const P
         }
     }
 
-    for (const auto& key : keys_to_update)
+    for (const auto& update : keys_to_update)
     {
+        const auto& key = update.first;
+        const auto& new_id = update.second;
         const auto& record = prepared_image_records[key];
         mpl::log(mpl::Level::info, category, fmt::format("Updating {} source image to latest", record.query.release));
         try
         {
-            fetch_image(fetch_type, record.query, prepare, monitor);
+            bool prefetched;
+            {
+                std::lock_guard<decltype(fetch_mutex)> lock{fetch_mutex};
+                prefetched = prepared_image_records.find(new_id) != prepared_image_records.end();
+            }
 
-            // Remove old image
+            if (!prefetched)
+                fetch_image(fetch_type, record.query, prepare, monitor);
+
+            // Remove old image, unless instances are still based on it or another image has the same contents. Its
+            // directory is then removed by prune_expired_images() once the last of them is gone.
             std::lock_guard<decltype(fetch_mutex)> lock{fetch_mutex};
-            delete_image_dir(record.image.image_path);
+            const auto image_dir = image_dir_of(record.image);
+            auto same_dir = [&key, &image_dir](const auto& other) {
+                return other.first != key && image_dir_of(other.second.image) == image_dir;
+            };
+            if (std::none_of(prepared_image_records.cbegin(), prepared_image_records.cend(), same_dir) &&
+                !backs_instance_images(image_dir))
+                delete_image_dir(record.image.image_path);
             prepared_image_records.erase(key);
             persist_image_records();
         }
@@ -596,9 +809,59 @@ void mp::DefaultVMImageVault::update_images(const FetchType& fetch_type, const P
     }
 }
 
+void mp::DefaultVMImageVault::prefetch_image(const FetchType& fetch_type, const Query& query,
+                                             const PrepareAction& prepare, const ProgressMonitor& monitor,
+                                             int64_t bytes_per_second)
+{
+    const auto info = info_for(query);
+    const auto id = info.id.toStdString();
+    QFuture<VMImage> future;
+
+    {
+        std::lock_guard<decltype(fetch_mutex)> lock{fetch_mutex};
+        if (prepared_image_records.find(id) != prepared_image_records.end() || get_image_future(id))
+            return;
+
+        mpl::log(mpl::Level::info, category, fmt::format("Prefetching {} {}", query.release, info.version));
+
+        auto waited_on = std::make_shared<std::atomic_bool>(false);
+        const auto throttled_monitor = make_throttled_monitor(monitor, info.size, bytes_per_second, waited_on);
+        const auto image_dir = mp::utils::make_dir(images_dir, info.id);
+
+        future = QtConcurrent::run([this, info, image_dir, fetch_type, prepare, throttled_monitor] {
+            const BackgroundIOPriority io_priority;
+            optional<VMImage> source_image{nullopt};
+            return download_and_prepare_source_image(info, source_image, image_dir, fetch_type, prepare,
+                                                     throttled_monitor, false);
+        });
+
+        in_progress_image_fetches[id] = future;
+        prefetches_waited_on[id] = waited_on;
+    }
+
+    try
+    {
+        auto prepared_image = future.result();
+        std::lock_guard<decltype(fetch_mutex)> lock{fetch_mutex};
+        in_progress_image_fetches.erase(id);
+        prefetches_waited_on.erase(id);
+
+        Query prefetch_query{query};
+        prefetch_query.name = "";
+        finalize_image_records(prefetch_query, prepared_image, id);
+    }
+    catch (const std::exception&)
+    {
+        std::lock_guard<decltype(fetch_mutex)> lock{fetch_mutex};
+        in_progress_image_fetches.erase(id);
+        prefetches_waited_on.erase(id);
+        throw;
+    }
+}
+
 mp::VMImage mp::DefaultVMImageVault::download_and_prepare_source_image(
     const VMImageInfo& info, mp::optional<VMImage>& existing_source_image, const QDir& image_dir,
-    const FetchType& fetch_type, const PrepareAction& prepare, const ProgressMonitor& monitor)
+    const FetchType& fetch_type, const PrepareAction& prepare, const ProgressMonitor& monitor, bool address_by_contents)
 {
     VMImage source_image;
     auto id = info.id.toStdString();
@@ -620,27 +883,56 @@ mp::VMImage mp::DefaultVMImageVault::download_and_prepare_source_image(
         }
     }
 
+    // Compressed images are decoded as they come down, so that only the decoded image lands on disk
+    const auto compressed = source_image.image_path.endsWith(".xz");
+    if (compressed)
+        source_image.image_path.chop(3);
+
     DeleteOnException image_file{source_image.image_path};
 
     try
     {
-        url_downloader->download_to(info.image_location, source_image.image_path, info.size, LaunchProgress::IMAGE,
-                                    monitor);
-
-        if (info.verify)
+        // The kernel and initrd come down alongside the image
+        CombinedProgress progress{monitor, LaunchProgress::IMAGE};
+        const auto download_monitor = progress.add(info.size);
+        std::future<VMImage> kernel_and_initrd;
+        if (fetch_type == FetchType::ImageKernelAndInitrd)
         {
-            monitor(LaunchProgress::VERIFY, -1);
-            verify_image_download(source_image.image_path, id);
+            const auto kernel_monitor = progress.add(url_downloader->content_length(info.kernel_location));
+            const auto initrd_monitor = progress.add(url_downloader->content_length(info.initrd_location));
+            kernel_and_initrd = std::async(std::launch::async, &DefaultVMImageVault::fetch_kernel_and_initrd, this,
+                                           std::cref(info), source_image, std::cref(image_dir), kernel_monitor,
+                                           initrd_monitor);
         }
 
-        if (fetch_type == FetchType::ImageKernelAndInitrd)
+        // The image is hashed as it is downloaded, so that verifying or filing it doesn't need to read it again
+        QCryptographicHash hash{QCryptographicHash::Sha256};
+        const auto digest = info.verify || address_by_contents ? &hash : nullptr;
+        if (compressed)
         {
-            source_image = fetch_kernel_and_initrd(info, source_image, image_dir, monitor);
+            XzImageDecoder::StreamDecoder xz_decoder{source_image.image_path};
+            url_downloader->download_stream(info.image_location,
+                                            [&xz_decoder](const QByteArray& data) { xz_decoder.decode(data); },
+                                            info.size, LaunchProgress::IMAGE, download_monitor, digest);
+            xz_decoder.finish();
+        }
+        else
+        {
+            url_downloader->download_to(info.image_location, source_image.image_path, info.size,
+                                        LaunchProgress::IMAGE, download_monitor, digest);
         }
 
-        if (source_image.image_path.endsWith(".xz"))
+        if (info.verify)
+            verify_image_download(source_image.image_path, hash, id);
+
+        if (kernel_and_initrd.valid())
+            source_image = kernel_and_initrd.get();
+
+        if (address_by_contents)
         {
-            source_image = extract_downloaded_image(source_image, monitor);
+            auto cached_image = file_under_contents(source_image, hash.result().toHex(), fetch_type);
+            if (cached_image)
+                return *cached_image;
         }
 
         auto prepared_image = prepare(source_image);
@@ -658,6 +950,54 @@ mp::VMImage mp::DefaultVMImageVault::download_and_prepare_source_image(
     }
 }
 
+// Moves a downloaded image to the directory named after the hash of its contents, so that the same contents are only
+// kept once however they were reached. Gives back the image already prepared from them, if there is one.
+mp::optional<mp::VMImage> mp::DefaultVMImageVault::file_under_contents(VMImage& source_image, const QString& content_id,
+                                                                       const FetchType& fetch_type)
+{
+    std::lock_guard<decltype(fetch_mutex)> lock{fetch_mutex};
+    const auto download_dir = image_dir_of(source_image);
+    const auto content_dir = images_dir.absoluteFilePath(content_id);
+    if (download_dir == content_dir)
+        return nullopt;
+
+    if (QFileInfo::exists(content_dir))
+    {
+        for (const auto& record : prepared_image_records)
+        {
+            auto cached_image = record.second.image;
+            if (image_dir_of(cached_image) == content_dir &&
+                (fetch_type == FetchType::ImageOnly || !cached_image.kernel_path.isEmpty()))
+            {
+                mpl::log(mpl::Level::debug, category,
+                         fmt::format("{} has the same contents as a cached image", source_image.image_path));
+                QDir(download_dir).removeRecursively();
+
+                cached_image.id = source_image.id;
+                cached_image.release_date = source_image.release_date;
+                return cached_image;
+            }
+        }
+
+        // The same contents are still being prepared elsewhere, so keep this download where it is
+        return nullopt;
+    }
+
+    if (!QDir().rename(download_dir, content_dir))
+    {
+        mpl::log(mpl::Level::warning, category, fmt::format("Cannot move {} to {}", download_dir, content_dir));
+        return nullopt;
+    }
+
+    for (auto path : {&source_image.image_path, &source_image.kernel_path, &source_image.initrd_path})
+    {
+        if (!path->isEmpty())
+            *path = QDir(content_dir).filePath(filename_for(*path));
+    }
+
+    return nullopt;
+}
+
 mp::VMImage mp::DefaultVMImageVault::extract_image_from(const std::string& instance_name, const VMImage& source_image,
                                                         const ProgressMonitor& monitor)
 {
@@ -676,20 +1016,6 @@ mp::VMImage mp::DefaultVMImageVault::extract_image_from(const std::string& insta
     return image;
 }
 
-mp::VMImage mp::DefaultVMImageVault::extract_downloaded_image(const VMImage& source_image,
-                                                              const ProgressMonitor& monitor)
-{
-    VMImage image{source_image};
-    XzImageDecoder xz_decoder(image.image_path);
-    auto image_path = image.image_path.remove(".xz");
-
-    xz_decoder.decode_to(image_path, monitor);
-    delete_file(source_image.image_path);
-    image.image_path = image_path;
-
-    return image;
-}
-
 mp::VMImage mp::DefaultVMImageVault::image_instance_from(const std::string& instance_name,
                                                          const VMImage& prepared_image)
 {
@@ -706,8 +1032,43 @@ mp::VMImage mp::DefaultVMImageVault::image_instance_from(const std::string& inst
             {}};
 }
 
+mp::VMImage mp::DefaultVMImageVault::overlay_instance_from(const std::string& instance_name,
+                                                           const VMImage& prepared_image)
+{
+    if (!QFileInfo::exists(prepared_image.image_path))
+        throw std::runtime_error(fmt::format("{} missing", prepared_image.image_path));
+
+    auto name = QString::fromStdString(instance_name);
+    auto output_dir = mp::utils::make_dir(instances_dir, name);
+    auto overlay_path = output_dir.filePath(filename_for(prepared_image.image_path));
+
+    create_overlay(prepared_image.image_path, overlay_path);
+    ++backing_image_refs[prepared_image.image_path.toStdString()];
+
+    return {overlay_path,
+            copy(prepared_image.kernel_path, output_dir),
+            copy(prepared_image.initrd_path, output_dir),
+            prepared_image.id,
+            prepared_image.original_release,
+            prepared_image.current_release,
+            prepared_image.release_date,
+            {},
+            prepared_image.image_path};
+}
+
+// Expects fetch_mutex to be held
+bool mp::DefaultVMImageVault::backs_instance_images(const Path& image_dir) const
+{
+    const auto dir_prefix = QDir(image_dir).absolutePath() + "/";
+    return std::any_of(backing_image_refs.cbegin(), backing_image_refs.cend(), [&dir_prefix](const auto& refs) {
+        return QFileInfo(QString::fromStdString(refs.first)).absoluteFilePath().startsWith(dir_prefix);
+    });
+}
+
 mp::VMImage mp::DefaultVMImageVault::fetch_kernel_and_initrd(const VMImageInfo& info, const VMImage& source_image,
-                                                             const QDir& image_dir, const ProgressMonitor& monitor)
+                                                             const QDir& image_dir,
+                                                             const ProgressMonitor& kernel_monitor,
+                                                             const ProgressMonitor& initrd_monitor)
 {
     auto image{source_image};
 
@@ -715,8 +1076,14 @@ mp::VMImage mp::DefaultVMImageVault::fetch_kernel_and_initrd(const VMImageInfo&
     image.initrd_path = image_dir.filePath(filename_for(info.initrd_location));
     DeleteOnException kernel_file{image.kernel_path};
     DeleteOnException initrd_file{image.initrd_path};
-    url_downloader->download_to(info.kernel_location, image.kernel_path, -1, LaunchProgress::KERNEL, monitor);
-    url_downloader->download_to(info.initrd_location, image.initrd_path, -1, LaunchProgress::INITRD, monitor);
+
+    auto kernel = std::async(std::launch::async, [this, &info, &image, &kernel_monitor] {
+        url_downloader->download_to(info.kernel_location, image.kernel_path, -1, LaunchProgress::KERNEL,
+                                    kernel_monitor, nullptr);
+    });
+    url_downloader->download_to(info.initrd_location, image.initrd_path, -1, LaunchProgress::INITRD, initrd_monitor,
+                                nullptr);
+    kernel.get();
 
     return image;
 }
@@ -739,7 +1106,8 @@ mp::VMImage mp::DefaultVMImageVault::finalize_image_records(const Query& query,
 
     if (!query.name.empty())
     {
-        vm_image = image_instance_from(query.name, prepared_image);
+        vm_image = create_overlay ? overlay_instance_from(query.name, prepared_image)
+                                  : image_instance_from(query.name, prepared_image);
         instance_image_records[query.name] = {vm_image, query, std::chrono::system_clock::now()};
     }
 
@@ -754,6 +1122,25 @@ mp::VMImage mp::DefaultVMImageVault::finalize_image_records(const Query& query,
     return vm_image;
 }
 
+mp::VMImageVault::CacheUsage mp::DefaultVMImageVault::cache_usage()
+{
+    std::lock_guard<decltype(fetch_mutex)> lock{fetch_mutex};
+
+    CacheUsage usage;
+    usage.total_size = disk_usage(images_dir.absolutePath());
+    usage.budget = cache_size_budget.in_bytes();
+
+    for (const auto& record : prepared_image_records)
+    {
+        const auto image_dir = image_dir_of(record.second.image);
+        usage.images.push_back({record.first, record.second.query.release, record.second.query.remote_name,
+                                disk_usage(image_dir), record.second.last_accessed, record.second.query.persistent,
+                                backs_instance_images(image_dir)});
+    }
+
+    return usage;
+}
+
 mp::VMImageInfo mp::DefaultVMImageVault::info_for(const mp::Query& query)
 {
     if (!query.remote_name.empty())
@@ -800,7 +1187,17 @@ void persist_records(const T& records, const QString& path)
         auto key = QString::fromStdString(record.first);
         json_records.insert(key, record_to_json(record.second));
     }
-    mp::write_json(json_records, path);
+
+    // The images are in place whether or not their records could be saved, so failing here would only lose track of
+    // them for the rest of this run as well
+    try
+    {
+        mp::write_json(json_records, path);
+    }
+    catch (const std::exception& e)
+    {
+        mpl::log(mpl::Level::error, category, fmt::format("Failed to save the image records: {}", e.what()));
+    }
 }
 } // namespace
 
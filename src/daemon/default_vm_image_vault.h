@@ -19,6 +19,7 @@
 #define MULTIPASS_DEFAULT_VM_IMAGE_VAULT_H
 
 #include <multipass/days.h>
+#include <multipass/memory_size.h>
 #include <multipass/optional.h>
 #include <multipass/path.h>
 #include <multipass/query.h>
@@ -29,6 +30,8 @@
 #include <QDir>
 #include <QFuture>
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
@@ -47,8 +50,15 @@ public:
 class DefaultVMImageVault final : public VMImageVault
 {
 public:
+    // Creates an image at overlay_path that only holds what changes on top of backing_image_path
+    using CreateOverlay = std::function<void(const Path& backing_image_path, const Path& overlay_path)>;
+
+    // Without create_overlay, instance images are full copies of the prepared images. Without a cache_size_budget,
+    // images are only removed once they expire.
     DefaultVMImageVault(std::vector<VMImageHost*> image_host, URLDownloader* downloader, multipass::Path cache_dir_path,
-                        multipass::Path data_dir_path, multipass::days days_to_expire);
+                        multipass::Path data_dir_path, multipass::days days_to_expire,
+                        const CreateOverlay& create_overlay = nullptr,
+                        const MemorySize& cache_size_budget = MemorySize{});
     ~DefaultVMImageVault();
 
     VMImage fetch_image(const FetchType& fetch_type, const Query& query, const PrepareAction& prepare,
@@ -58,17 +68,24 @@ public:
     void prune_expired_images() override;
     void update_images(const FetchType& fetch_type, const PrepareAction& prepare,
                        const ProgressMonitor& monitor) override;
+    CacheUsage cache_usage() override;
+    void prefetch_image(const FetchType& fetch_type, const Query& query, const PrepareAction& prepare,
+                        const ProgressMonitor& monitor, int64_t bytes_per_second) override;
 
 private:
     VMImage image_instance_from(const std::string& name, const VMImage& prepared_image);
+    VMImage overlay_instance_from(const std::string& name, const VMImage& prepared_image);
+    bool backs_instance_images(const Path& image_dir) const;
     VMImage download_and_prepare_source_image(const VMImageInfo& info, optional<VMImage>& existing_source_image,
                                               const QDir& image_dir, const FetchType& fetch_type,
-                                              const PrepareAction& prepare, const ProgressMonitor& monitor);
+                                              const PrepareAction& prepare, const ProgressMonitor& monitor,
+                                              bool address_by_contents);
+    optional<VMImage> file_under_contents(VMImage& source_image, const QString& content_id,
+                                          const FetchType& fetch_type);
     VMImage extract_image_from(const std::string& instance_name, const VMImage& source_image,
                                const ProgressMonitor& monitor);
-    VMImage extract_downloaded_image(const VMImage& source_image, const ProgressMonitor& monitor);
     VMImage fetch_kernel_and_initrd(const VMImageInfo& info, const VMImage& source_image, const QDir& image_dir,
-                                    const ProgressMonitor& monitor);
+                                    const ProgressMonitor& kernel_monitor, const ProgressMonitor& initrd_monitor);
     optional<QFuture<VMImage>> get_image_future(const std::string& id);
     VMImage finalize_image_records(const Query& query, const VMImage& prepared_image, const std::string& id);
     VMImageInfo info_for(const Query& query);
@@ -83,12 +100,17 @@ private:
     const QDir instances_dir;
     const QDir images_dir;
     const days days_to_expire;
+    const CreateOverlay create_overlay;
+    const MemorySize cache_size_budget;
     std::mutex fetch_mutex;
 
     std::unordered_map<std::string, VaultRecord> prepared_image_records;
     std::unordered_map<std::string, VaultRecord> instance_image_records;
     std::unordered_map<std::string, VMImageHost*> remote_image_host_map;
+    std::unordered_map<std::string, int> backing_image_refs; // number of instance images on top of each image
     std::unordered_map<std::string, QFuture<VMImage>> in_progress_image_fetches;
+    // Set once something waits on the prefetch, which then stops holding back
+    std::unordered_map<std::string, std::shared_ptr<std::atomic_bool>> prefetches_waited_on;
 };
 }
 #endif // MULTIPASS_DEFAULT_VM_IMAGE_VAULT_H
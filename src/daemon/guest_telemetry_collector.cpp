@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guest_telemetry_collector.h"
+
+#include <multipass/logging/log.h>
+#include <multipass/utils.h>
+
+#include <multipass/format.h>
+
+#include <sstream>
+
+namespace mp = multipass;
+namespace mpl = multipass::logging;
+
+namespace
+{
+constexpr auto category = "telemetry";
+
+// Prints one "key=value" line per item, so that a failing item leaves the others intact
+constexpr auto telemetry_cmd =
+    "echo \"load=$(cut -d ' ' -f1-3 /proc/loadavg)\"; "
+    "free -b | awk 'NR == 2 { print \"memory_usage=\" $3; print \"memory_total=\" $2 }'; "
+    "df --output=used,size -B1 `awk '$2 == \"/\" { print $1 }' /proc/mounts` | "
+    "awk 'NR == 2 { print \"disk_usage=\" $1; print \"disk_total=\" $2 }'; "
+    "echo \"release=$(lsb_release -ds 2>/dev/null)\"";
+
+mp::GuestTelemetry parse_telemetry(const std::string& output)
+{
+    mp::GuestTelemetry telemetry;
+    const std::unordered_map<std::string, std::string*> fields{{"load", &telemetry.load},
+                                                               {"memory_usage", &telemetry.memory_usage},
+                                                               {"memory_total", &telemetry.memory_total},
+                                                               {"disk_usage", &telemetry.disk_usage},
+                                                               {"disk_total", &telemetry.disk_total},
+                                                               {"release", &telemetry.current_release}};
+
+    std::istringstream stream{output};
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        auto separator = line.find('=');
+        if (separator == std::string::npos)
+            continue;
+
+        auto field = fields.find(line.substr(0, separator));
+        if (field != fields.end())
+        {
+            auto value = line.substr(separator + 1);
+            *field->second = mp::utils::trim_end(value);
+        }
+    }
+
+    for (const auto& field : fields)
+        if (field.second->empty())
+            mpl::log(mpl::Level::debug, category, fmt::format("no value gathered for '{}'", field.first));
+
+    telemetry.timestamp = std::chrono::system_clock::now();
+    return telemetry;
+}
+} // namespace
+
+mp::GuestTelemetryCollector::GuestTelemetryCollector(SSHSessionPool& session_pool) : session_pool{session_pool}
+{
+}
+
+mp::GuestTelemetry mp::GuestTelemetryCollector::refresh(const std::string& name, const std::string& hostname, int port,
+                                                        const std::string& username, std::chrono::milliseconds timeout)
+{
+    auto lease = session_pool.lease(name, hostname, port, username);
+
+    auto process = [&lease, &name]() {
+        try
+        {
+            return lease.exec(telemetry_cmd);
+        }
+        catch (const std::exception& e)
+        {
+            // The pooled session may have been dropped by the instance without us noticing, so try once more
+            mpl::log(mpl::Level::debug, category, fmt::format("reconnecting to {}: {}", name, e.what()));
+            lease.reconnect();
+            return lease.exec(telemetry_cmd);
+        }
+    }();
+
+    // Waiting for the command to finish first bounds the read, which would otherwise wait on the instance for good
+    process.exit_code(timeout);
+    auto output = process.read_std_output();
+
+    auto result = parse_telemetry(output);
+
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    telemetry[name] = result;
+
+    return result;
+}
+
+mp::optional<mp::GuestTelemetry> mp::GuestTelemetryCollector::cached(const std::string& name) const
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    auto it = telemetry.find(name);
+    if (it == telemetry.end())
+        return nullopt;
+
+    return it->second;
+}
+
+void mp::GuestTelemetryCollector::forget(const std::string& name)
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    telemetry.erase(name);
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MULTIPASS_GUEST_TELEMETRY_COLLECTOR_H
+#define MULTIPASS_GUEST_TELEMETRY_COLLECTOR_H
+
+#include <multipass/optional.h>
+#include <multipass/ssh/ssh_session_pool.h>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace multipass
+{
+struct GuestTelemetry
+{
+    std::string load;
+    std::string memory_usage;
+    std::string memory_total;
+    std::string disk_usage;
+    std::string disk_total;
+    std::string current_release;
+    std::chrono::system_clock::time_point timestamp;
+};
+
+/*
+ * GuestTelemetryCollector - gathers load, memory, disk and release information from running instances
+ *
+ * Everything is gathered with a single command, over the instance's pooled SSH session. The last result for each
+ * instance is cached, so that it can be served without reaching the instance. The command is given up on after the
+ * timeout passed to refresh(), for an unresponsive instance not to hold the caller. This class is thread-safe.
+ */
+class GuestTelemetryCollector
+{
+public:
+    explicit GuestTelemetryCollector(SSHSessionPool& session_pool);
+
+    GuestTelemetry refresh(const std::string& name, const std::string& hostname, int port, const std::string& username,
+                           std::chrono::milliseconds timeout = std::chrono::seconds(10));
+    optional<GuestTelemetry> cached(const std::string& name) const;
+    void forget(const std::string& name);
+
+private:
+    SSHSessionPool& session_pool;
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, GuestTelemetry> telemetry;
+};
+} // namespace multipass
+#endif // MULTIPASS_GUEST_TELEMETRY_COLLECTOR_H
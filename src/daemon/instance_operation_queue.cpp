@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "instance_operation_queue.h"
+
+#include <algorithm>
+
+namespace mp = multipass;
+
+namespace
+{
+bool runs_alongside_its_kind(mp::InstanceOperationQueue::Kind kind)
+{
+    using Kind = mp::InstanceOperationQueue::Kind;
+    return kind == Kind::start || kind == Kind::stop || kind == Kind::suspend;
+}
+} // namespace
+
+void mp::InstanceOperationQueue::schedule(const std::vector<std::string>& instances, Kind kind,
+                                          const Operation& operation)
+{
+    auto entry = std::make_shared<Entry>(Entry{instances, kind, operation, false, false});
+
+    for (const auto& instance : entry->instances)
+        queues[instance].push_back(entry);
+
+    if (can_run(entry))
+        run(entry);
+}
+
+bool mp::InstanceOperationQueue::is_busy(const std::string& instance) const
+{
+    return queues.find(instance) != queues.end();
+}
+
+bool mp::InstanceOperationQueue::can_run(const EntryPtr& entry) const
+{
+    for (const auto& instance : entry->instances)
+    {
+        for (const auto& ahead : queues.at(instance))
+        {
+            if (ahead == entry)
+                break;
+
+            if (!ahead->running || ahead->kind != entry->kind || !runs_alongside_its_kind(entry->kind))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+void mp::InstanceOperationQueue::run(const EntryPtr& entry)
+{
+    entry->running = true;
+
+    try
+    {
+        entry->operation([this, entry] { finish(entry); });
+    }
+    catch (...)
+    {
+        finish(entry);
+        throw;
+    }
+}
+
+void mp::InstanceOperationQueue::finish(const EntryPtr& entry)
+{
+    if (entry->finished)
+        return;
+
+    entry->finished = true;
+
+    std::vector<EntryPtr> candidates;
+    for (const auto& instance : entry->instances)
+    {
+        auto it = queues.find(instance);
+        if (it == queues.end())
+            continue;
+
+        auto& queue = it->second;
+        queue.erase(std::remove(queue.begin(), queue.end(), entry), queue.end());
+
+        if (queue.empty())
+            queues.erase(it);
+        else
+            std::copy_if(queue.cbegin(), queue.cend(), std::back_inserter(candidates),
+                         [](const EntryPtr& waiting) { return !waiting->running; });
+    }
+
+    // Running an operation may finish others synchronously, so check each candidate again just before starting it
+    for (const auto& candidate : candidates)
+        if (!candidate->running && !candidate->finished && can_run(candidate))
+            run(candidate);
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MULTIPASS_INSTANCE_OPERATION_QUEUE_H
+#define MULTIPASS_INSTANCE_OPERATION_QUEUE_H
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace multipass
+{
+/*
+ * InstanceOperationQueue - orders the operations on each instance
+ *
+ * An operation starts once every operation scheduled before it on any of its instances is done, so operations on the
+ * same instance run in the order they were requested while operations on other instances are not held up. Operations
+ * that can safely be repeated (start, stop, suspend) start alongside running operations of the same kind instead of
+ * waiting for them. The queue only orders operations: each one still does its own work and reports its own result,
+ * nothing is merged.
+ *
+ * Operations may finish asynchronously: they get a callback to invoke when they are done. This class is not
+ * thread-safe and is meant to be used from the daemon's main thread.
+ */
+class InstanceOperationQueue
+{
+public:
+    enum class Kind
+    {
+        start,
+        stop,
+        suspend,
+        restart,
+        mount,
+        umount,
+        delet,
+        recover,
+        purge,
+        restore
+    };
+
+    using Done = std::function<void()>;
+    using Operation = std::function<void(const Done&)>;
+
+    void schedule(const std::vector<std::string>& instances, Kind kind, const Operation& operation);
+    bool is_busy(const std::string& instance) const;
+
+private:
+    struct Entry
+    {
+        std::vector<std::string> instances;
+        Kind kind;
+        Operation operation;
+        bool running;
+        bool finished;
+    };
+    using EntryPtr = std::shared_ptr<Entry>;
+
+    bool can_run(const EntryPtr& entry) const;
+    void run(const EntryPtr& entry);
+    void finish(const EntryPtr& entry);
+
+    std::unordered_map<std::string, std::deque<EntryPtr>> queues;
+};
+} // namespace multipass
+#endif // MULTIPASS_INSTANCE_OPERATION_QUEUE_H
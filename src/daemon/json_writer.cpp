@@ -19,16 +19,22 @@
 
 #include "json_writer.h"
 
-#include <QFile>
+#include <multipass/format.h>
+
 #include <QJsonDocument>
+#include <QSaveFile>
+
+#include <stdexcept>
 
 namespace mp = multipass;
 
+// The file is written under a temporary name and synced to disk, then renamed over the old one. A crash leaves either
+// the old or the new contents, never a mix of them.
 void mp::write_json(const QJsonObject& root, QString file_name)
 {
     QJsonDocument doc{root};
     auto raw_json = doc.toJson();
-    QFile db_file{file_name};
-    db_file.open(QIODevice::ReadWrite | QIODevice::Truncate);
-    db_file.write(raw_json);
+    QSaveFile db_file{file_name};
+    if (!db_file.open(QIODevice::WriteOnly) || db_file.write(raw_json) != raw_json.size() || !db_file.commit())
+        throw std::runtime_error(fmt::format("cannot write \"{}\": {}", file_name, db_file.errorString()));
 }
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "lazy_virtual_machine.h"
+
+#include <multipass/exceptions/start_exception.h>
+#include <multipass/format.h>
+
+namespace mp = multipass;
+
+mp::LazyVirtualMachine::LazyVirtualMachine(State state, const std::string& vm_name, const std::string& username,
+                                           const BackendCreator& create_backend)
+    : VirtualMachine{state, vm_name}, username{username}, create_backend{create_backend}
+{
+}
+
+void mp::LazyVirtualMachine::stop()
+{
+    if (auto vm = backend())
+        vm->stop();
+}
+
+void mp::LazyVirtualMachine::start()
+{
+    // The backend's machine takes this one's place, which may drop the last other reference to it
+    auto self = weak_from_this().lock();
+
+    auto vm = backend();
+    if (!vm)
+    {
+        vm = create_backend(*this);
+
+        std::lock_guard<decltype(backend_mutex)> lock{backend_mutex};
+        backend_vm = vm;
+    }
+
+    vm->start();
+}
+
+void mp::LazyVirtualMachine::shutdown()
+{
+    if (auto vm = backend())
+        vm->shutdown();
+}
+
+void mp::LazyVirtualMachine::suspend()
+{
+    if (auto vm = backend())
+        vm->suspend();
+}
+
+mp::VirtualMachine::State mp::LazyVirtualMachine::current_state()
+{
+    if (auto vm = backend())
+        return vm->current_state();
+
+    return state;
+}
+
+int mp::LazyVirtualMachine::ssh_port()
+{
+    if (auto vm = backend())
+        return vm->ssh_port();
+
+    return 22;
+}
+
+std::string mp::LazyVirtualMachine::ssh_hostname(std::chrono::milliseconds timeout)
+{
+    if (auto vm = backend())
+        return vm->ssh_hostname(timeout);
+
+    throw_not_running();
+}
+
+std::string mp::LazyVirtualMachine::ssh_username()
+{
+    return username;
+}
+
+std::string mp::LazyVirtualMachine::ipv4()
+{
+    if (auto vm = backend())
+        return vm->ipv4();
+
+    return "UNKNOWN";
+}
+
+std::string mp::LazyVirtualMachine::ipv6()
+{
+    if (auto vm = backend())
+        return vm->ipv6();
+
+    return {};
+}
+
+void mp::LazyVirtualMachine::wait_until_ssh_up(std::chrono::milliseconds timeout)
+{
+    if (auto vm = backend())
+        return vm->wait_until_ssh_up(timeout);
+
+    throw_not_running();
+}
+
+void mp::LazyVirtualMachine::ensure_vm_is_running()
+{
+    if (auto vm = backend())
+        return vm->ensure_vm_is_running();
+
+    throw_not_running();
+}
+
+void mp::LazyVirtualMachine::update_state()
+{
+    if (auto vm = backend())
+        vm->update_state();
+}
+
+mp::VirtualMachine::ShPtr mp::LazyVirtualMachine::backend() const
+{
+    std::lock_guard<decltype(backend_mutex)> lock{backend_mutex};
+    return backend_vm;
+}
+
+void mp::LazyVirtualMachine::throw_not_running() const
+{
+    throw StartException(vm_name, fmt::format("instance \"{}\" is not running", vm_name));
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MULTIPASS_LAZY_VIRTUAL_MACHINE_H
+#define MULTIPASS_LAZY_VIRTUAL_MACHINE_H
+
+#include <multipass/virtual_machine.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace multipass
+{
+/*
+ * LazyVirtualMachine - stands in for a stopped or suspended instance until it is first started
+ *
+ * The backend's virtual machine, and the host resources that come with it (tap devices, libvirt domains, LXD
+ * lookups), are only created on the first start. Until then, this reports the state the instance was left in and has
+ * nothing to do to stop, shut down or suspend it. Afterwards, everything is forwarded to the backend's machine.
+ *
+ * Creating the backend's machine is expected to put it in place of this one wherever the instance is kept, so this
+ * must be owned by a shared pointer, that start() holds on to while it runs.
+ */
+class LazyVirtualMachine final : public VirtualMachine, public std::enable_shared_from_this<LazyVirtualMachine>
+{
+public:
+    using BackendCreator = std::function<VirtualMachine::ShPtr(LazyVirtualMachine&)>;
+
+    LazyVirtualMachine(State state, const std::string& vm_name, const std::string& username,
+                       const BackendCreator& create_backend);
+
+    void stop() override;
+    void start() override;
+    void shutdown() override;
+    void suspend() override;
+    State current_state() override;
+    int ssh_port() override;
+    std::string ssh_hostname(std::chrono::milliseconds timeout) override;
+    std::string ssh_username() override;
+    std::string ipv4() override;
+    std::string ipv6() override;
+    void wait_until_ssh_up(std::chrono::milliseconds timeout) override;
+    void ensure_vm_is_running() override;
+    void update_state() override;
+
+    VirtualMachine::ShPtr backend() const; // null until the instance is started
+
+private:
+    [[noreturn]] void throw_not_running() const;
+
+    const std::string username;
+    const BackendCreator create_backend;
+    mutable std::mutex backend_mutex;
+    VirtualMachine::ShPtr backend_vm;
+};
+} // namespace multipass
+#endif // MULTIPASS_LAZY_VIRTUAL_MACHINE_H
@@ -28,7 +28,7 @@
 #include <QUrl>
 
 #include <algorithm>
-#include <unordered_set>
+#include <iterator>
 
 namespace mp = multipass;
 
@@ -36,13 +36,15 @@ namespace
 {
 constexpr auto index_path = "streams/v1/index.json";
 
-auto download_manifest(const QString& host_url, mp::URLDownloader* url_downloader)
+// When asked whether the manifest changed since it was last downloaded and it did not, it is not read again
+auto download_manifest(const QString& host_url, mp::URLDownloader* url_downloader, bool* not_modified)
 {
     auto json_index = url_downloader->download({host_url + index_path});
     auto index = mp::SimpleStreamsIndex::fromJson(json_index);
 
-    auto json_manifest = url_downloader->download({host_url + index.manifest_path});
-    return mp::SimpleStreamsManifest::fromJson(json_manifest, host_url);
+    const QUrl manifest_url{host_url + index.manifest_path};
+    return not_modified ? url_downloader->download_if_modified(manifest_url, *not_modified)
+                        : url_downloader->download(manifest_url);
 }
 
 mp::VMImageInfo with_location_fully_resolved(const QString& host_url, const mp::VMImageInfo& info)
@@ -77,33 +79,29 @@ mp::UbuntuVMImageHost::UbuntuVMImageHost(std::vector<std::pair<std::string, std:
 {
 }
 
+mp::UbuntuVMImageHost::~UbuntuVMImageHost()
+{
+    wait_for_manifest_update();
+}
+
 mp::optional<mp::VMImageInfo> mp::UbuntuVMImageHost::info_for(const Query& query)
 {
     auto key = key_from(query.release);
-    mp::SimpleStreamsManifest* manifest;
     const VMImageInfo* info{nullptr};
 
     auto remote_name = query.remote_name.empty() ? release_remote : query.remote_name;
 
-    manifest = manifest_from(remote_name);
+    auto manifest = manifest_from(remote_name);
     match_alias(key, &info, *manifest);
 
     if (!info)
     {
-        int num_matches = 0;
-
-        auto predicate = [&](const VMImageInfo& entry) {
-            auto partial_match = false;
-            if (entry.id.startsWith(key))
-            {
-                info = &entry;
-                partial_match = true;
-            }
-            return partial_match;
-        };
-        num_matches += std::count_if(manifest->products.begin(), manifest->products.end(), predicate);
-        if (num_matches > 1)
+        const auto matches = manifest->products_with_id_prefix(key);
+        if (std::distance(matches.first, matches.second) > 1)
             throw std::runtime_error(fmt::format("Too many images matching \"{}\"", query.release));
+
+        if (matches.first != matches.second)
+            info = *matches.first;
     }
 
     if (info)
@@ -122,12 +120,11 @@ std::vector<mp::VMImageInfo> mp::UbuntuVMImageHost::all_info_for(const Query& qu
     std::vector<mp::VMImageInfo> images;
 
     auto key = key_from(query.release);
-    mp::SimpleStreamsManifest* manifest;
     const VMImageInfo* info{nullptr};
 
     auto remote_name = query.remote_name.empty() ? release_remote : query.remote_name;
 
-    manifest = manifest_from(remote_name);
+    auto manifest = manifest_from(remote_name);
     match_alias(key, &info, *manifest);
 
     if (info)
@@ -139,16 +136,15 @@ std::vector<mp::VMImageInfo> mp::UbuntuVMImageHost::all_info_for(const Query& qu
     }
     else
     {
-        std::unordered_set<std::string> found_hashes;
-
-        for (const auto& entry : manifest->products)
+        // Products of the same id come one after the other here, so only the first one that is supported is taken
+        const auto matches = manifest->products_with_id_prefix(key);
+        for (auto it = matches.first; it != matches.second; ++it)
         {
-            if (entry.id.startsWith(key) && (entry.supported || query.allow_unsupported) &&
-                found_hashes.find(entry.id.toStdString()) == found_hashes.end())
+            const auto& entry = **it;
+            if ((entry.supported || query.allow_unsupported) && (images.empty() || images.back().id != entry.id))
             {
                 images.push_back(
                     with_location_fully_resolved(QString::fromStdString(remote_url_from(remote_name)), entry));
-                found_hashes.insert(entry.id.toStdString());
             }
         }
     }
@@ -161,15 +157,11 @@ std::vector<mp::VMImageInfo> mp::UbuntuVMImageHost::all_info_for(const Query& qu
 
 mp::VMImageInfo mp::UbuntuVMImageHost::info_for_full_hash_impl(const std::string& full_hash)
 {
-    for (const auto& manifest : manifests)
+    const auto id = QString::fromStdString(full_hash);
+    for (const auto& manifest : current_manifests())
     {
-        for (const auto& product : manifest.second->products)
-        {
-            if (product.id.toStdString() == full_hash)
-            {
-                return with_location_fully_resolved(QString::fromStdString(remote_url_from(manifest.first)), product);
-            }
-        }
+        if (const auto product = manifest.second->product_with_id(id))
+            return with_location_fully_resolved(QString::fromStdString(remote_url_from(manifest.first)), *product);
     }
 
     throw std::runtime_error(fmt::format("Unable to find an image matching hash \"{}\"", full_hash));
@@ -197,7 +189,7 @@ std::vector<mp::VMImageInfo> mp::UbuntuVMImageHost::all_images_for(const std::st
 
 void mp::UbuntuVMImageHost::for_each_entry_do_impl(const Action& action)
 {
-    for (const auto& manifest : manifests)
+    for (const auto& manifest : current_manifests())
     {
         for (const auto& product : manifest.second->products)
         {
@@ -219,48 +211,84 @@ std::vector<std::string> mp::UbuntuVMImageHost::supported_remotes()
     return supported_remotes;
 }
 
-void mp::UbuntuVMImageHost::fetch_manifests()
+bool mp::UbuntuVMImageHost::fetch_manifests()
 {
+    const auto current = current_manifests();
+    auto current_manifest_of = [&current](const std::string& remote_name) {
+        auto it = std::find_if(current.cbegin(), current.cend(),
+                               [&remote_name](const auto& element) { return element.first == remote_name; });
+        return it != current.cend() ? it->second : nullptr;
+    };
+
+    Manifests fetched;
+    bool reached_any{false};
     for (const auto& remote : remotes)
     {
+        auto keep_current = [&fetched, &current_manifest_of, &remote] {
+            if (auto manifest = current_manifest_of(remote.first))
+                fetched.emplace_back(remote.first, manifest);
+        };
+
         try
         {
-            manifests.emplace_back(
-                std::make_pair(remote.first, download_manifest(QString::fromStdString(remote.second), url_downloader)));
+            const auto host_url = QString::fromStdString(remote.second);
+            auto manifest = current_manifest_of(remote.first);
+            bool not_modified{false};
+            auto json_manifest = download_manifest(host_url, url_downloader, manifest ? &not_modified : nullptr);
+            reached_any = true;
+
+            // A manifest that did not change since it was last parsed is kept as it was
+            if (not_modified)
+            {
+                fetched.emplace_back(remote.first, manifest);
+                continue;
+            }
+
+            fetched.emplace_back(remote.first, mp::SimpleStreamsManifest::fromJson(json_manifest, host_url));
         }
         catch (mp::EmptyManifestException& /* e */)
         {
+            reached_any = true;
             on_manifest_empty(fmt::format("Did not find any supported products in \"{}\"", remote.first));
         }
         catch (mp::GenericManifestException& e)
         {
             on_manifest_update_failure(e.what());
+            keep_current();
         }
         catch (mp::DownloadException& e)
         {
             on_manifest_update_failure(e.what());
+            keep_current();
         }
     }
+
+    const auto available = reached_any || !fetched.empty();
+
+    std::lock_guard<decltype(manifests_mutex)> lock{manifests_mutex};
+    manifests = std::move(fetched);
+
+    return available;
 }
 
-void mp::UbuntuVMImageHost::clear()
+auto mp::UbuntuVMImageHost::current_manifests() -> Manifests
 {
-    manifests.clear();
+    std::lock_guard<decltype(manifests_mutex)> lock{manifests_mutex};
+    return manifests;
 }
 
-mp::SimpleStreamsManifest* mp::UbuntuVMImageHost::manifest_from(const std::string& remote)
+std::shared_ptr<mp::SimpleStreamsManifest> mp::UbuntuVMImageHost::manifest_from(const std::string& remote)
 {
     update_manifests();
 
+    std::lock_guard<decltype(manifests_mutex)> lock{manifests_mutex};
     auto it = std::find_if(manifests.begin(), manifests.end(),
-                           [&remote](const std::pair<std::string, std::unique_ptr<SimpleStreamsManifest>>& element) {
-                               return element.first == remote;
-                           });
+                           [&remote](const auto& element) { return element.first == remote; });
 
     if (it == manifests.cend())
         throw std::runtime_error(fmt::format("Remote \"{}\" is unknown or unreachable.", remote));
 
-    return it->second.get();
+    return it->second;
 }
 
 void mp::UbuntuVMImageHost::match_alias(const QString& key, const VMImageInfo** info,
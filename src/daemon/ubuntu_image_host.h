@@ -23,6 +23,8 @@
 
 #include <QString>
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -38,6 +40,7 @@ class UbuntuVMImageHost final : public CommonVMImageHost
 public:
     UbuntuVMImageHost(std::vector<std::pair<std::string, std::string>> remotes, URLDownloader* downloader,
                       std::chrono::seconds manifest_time_to_live);
+    ~UbuntuVMImageHost() override;
 
     optional<VMImageInfo> info_for(const Query& query) override;
     std::vector<VMImageInfo> all_info_for(const Query& query) override;
@@ -47,13 +50,17 @@ public:
 protected:
     void for_each_entry_do_impl(const Action& action) override;
     VMImageInfo info_for_full_hash_impl(const std::string& full_hash) override;
-    void fetch_manifests() override;
-    void clear() override;
+    bool fetch_manifests() override;
 
 private:
-    SimpleStreamsManifest* manifest_from(const std::string& remote);
+    using Manifests = std::vector<std::pair<std::string, std::shared_ptr<SimpleStreamsManifest>>>;
+
+    Manifests current_manifests();
+    std::shared_ptr<SimpleStreamsManifest> manifest_from(const std::string& remote);
     void match_alias(const QString& key, const VMImageInfo** info, const SimpleStreamsManifest& manifest);
-    std::vector<std::pair<std::string, std::unique_ptr<SimpleStreamsManifest>>> manifests;
+    // Readers hold on to the manifests they got, which updates swap for new ones instead of changing them
+    Manifests manifests;
+    std::mutex manifests_mutex;
     URLDownloader* const url_downloader;
     std::vector<std::pair<std::string, std::string>> remotes;
     std::string remote_url_from(const std::string& remote_name);
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "watch_queue.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace mp = multipass;
+
+namespace
+{
+void remove_instance(google::protobuf::RepeatedPtrField<mp::ListVMInstance>& instances, const std::string& name)
+{
+    auto it = std::find_if(instances.begin(), instances.end(),
+                           [&name](const mp::ListVMInstance& instance) { return instance.name() == name; });
+    if (it != instances.end())
+        instances.erase(it);
+}
+
+void remove_name(google::protobuf::RepeatedPtrField<std::string>& names, const std::string& name)
+{
+    auto it = std::find(names.begin(), names.end(), name);
+    if (it != names.end())
+        names.erase(it);
+}
+
+// What the client ends up with is the same as if it had read both replies, as later changes to an instance replace
+// the earlier ones
+void fold_into(mp::WatchReply& earlier, const mp::WatchReply& later)
+{
+    for (const auto& instance : later.instances())
+    {
+        remove_instance(*earlier.mutable_instances(), instance.name());
+        remove_name(*earlier.mutable_removed_instances(), instance.name());
+        earlier.add_instances()->CopyFrom(instance);
+    }
+
+    for (const auto& name : later.removed_instances())
+    {
+        remove_instance(*earlier.mutable_instances(), name);
+        remove_name(*earlier.mutable_removed_instances(), name);
+        earlier.add_removed_instances(name);
+    }
+}
+} // namespace
+
+mp::WatchQueue::WatchQueue(std::size_t capacity) : capacity{std::max<std::size_t>(capacity, 1)}
+{
+}
+
+void mp::WatchQueue::push(const WatchReply& reply)
+{
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        if (replies.size() < capacity)
+            replies.push_back(reply);
+        else
+            fold_into(replies.back(), reply);
+    }
+
+    replies_queued.notify_one();
+}
+
+std::vector<mp::WatchReply> mp::WatchQueue::take(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<decltype(mutex)> lock{mutex};
+    replies_queued.wait_for(lock, timeout, [this] { return !replies.empty(); });
+
+    std::vector<WatchReply> taken{std::make_move_iterator(replies.begin()), std::make_move_iterator(replies.end())};
+    replies.clear();
+
+    return taken;
+}
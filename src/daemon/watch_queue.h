@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MULTIPASS_WATCH_QUEUE_H
+#define MULTIPASS_WATCH_QUEUE_H
+
+#include <multipass/rpc/multipass.grpc.pb.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace multipass
+{
+/*
+ * WatchQueue - the updates on their way to one client watching the instances
+ *
+ * The daemon queues updates as instances change and the thread serving the client writes them out, so that a client
+ * that is slow to read holds up nothing but its own updates. Once the queue is full, further updates are folded into
+ * the last one queued, where each instance keeps only its latest status. This class is thread-safe.
+ */
+class WatchQueue
+{
+public:
+    explicit WatchQueue(std::size_t capacity);
+
+    void push(const WatchReply& reply);
+    // Waits up to timeout for updates to be queued, and hands over all those queued so far
+    std::vector<WatchReply> take(std::chrono::milliseconds timeout);
+
+private:
+    const std::size_t capacity;
+    std::deque<WatchReply> replies;
+    std::mutex mutex;
+    std::condition_variable replies_queued;
+};
+} // namespace multipass
+#endif // MULTIPASS_WATCH_QUEUE_H
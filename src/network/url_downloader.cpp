@@ -22,16 +22,24 @@
 #include <multipass/format.h>
 #include <multipass/logging/log.h>
 
+#include <QCryptographicHash>
 #include <QDir>
 #include <QEventLoop>
 #include <QFile>
 #include <QNetworkAccessManager>
 #include <QNetworkDiskCache>
 #include <QNetworkReply>
+#include <QThreadStorage>
 #include <QTimer>
 #include <QUrl>
 
+#include <algorithm>
+#include <exception>
+#include <functional>
 #include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace mp = multipass;
 namespace mpl = multipass::logging;
@@ -39,6 +47,16 @@ namespace mpl = multipass::logging;
 namespace
 {
 constexpr auto category = "url downloader";
+constexpr auto part_suffix = ".part";
+constexpr auto validator_suffix = ".validator";
+constexpr auto max_download_attempts = 5;
+constexpr std::chrono::milliseconds first_retry_delay{1000};
+constexpr qint64 min_segmented_download_size{64 * 1024 * 1024};
+constexpr int num_download_segments{4}; // stays below the connections that Qt opens to a host at once
+// Once this much of a file is waiting to be read, Qt stops reading from the connection. A download that its monitor
+// holds back then holds back the server too, instead of piling up in memory.
+constexpr qint64 file_read_buffer_size{4 * 1024 * 1024};
+constexpr std::size_t max_network_managers_per_thread{4};
 
 auto make_network_manager(const mp::Path& cache_dir_path)
 {
@@ -56,6 +74,46 @@ auto make_network_manager(const mp::Path& cache_dir_path)
     return manager;
 }
 
+// Managers outlive the requests they make, so each reply has to be let go of once done with
+struct LaterDeleter
+{
+    void operator()(QObject* object) const
+    {
+        object->deleteLater();
+    }
+};
+using ReplyHandle = std::unique_ptr<QNetworkReply, LaterDeleter>;
+
+// A manager keeps its connections open after a request, so that later requests to the same host skip connecting
+// and the TLS handshake. Managers only work on the thread that made them, so each thread keeps a few of its own,
+// one per cache, which go away with the thread.
+QNetworkAccessManager* network_manager_for(const mp::Path& cache_dir_path)
+{
+    using Managers = std::vector<std::pair<mp::Path, std::unique_ptr<QNetworkAccessManager>>>; // least recent first
+    static QThreadStorage<Managers> thread_managers;
+
+    auto& managers = thread_managers.localData();
+    auto it = std::find_if(managers.begin(), managers.end(),
+                           [&cache_dir_path](const auto& entry) { return entry.first == cache_dir_path; });
+
+    if (it != managers.end())
+    {
+        // The cache would stop caching anything if its directory went away in the meantime
+        auto network_cache = static_cast<QNetworkDiskCache*>(it->second->cache());
+        if (network_cache && !QDir{cache_dir_path}.exists())
+            network_cache->setCacheDirectory(cache_dir_path);
+
+        std::rotate(it, std::next(it), managers.end());
+        return managers.back().second.get();
+    }
+
+    if (managers.size() == max_network_managers_per_thread)
+        managers.erase(managers.begin());
+
+    managers.emplace_back(cache_dir_path, make_network_manager(cache_dir_path));
+    return managers.back().second.get();
+}
+
 auto get_network_cache_data(QAbstractNetworkCache* network_cache, const QUrl& url)
 {
     auto contents = network_cache->data(url);
@@ -64,21 +122,271 @@ auto get_network_cache_data(QAbstractNetworkCache* network_cache, const QUrl& ur
     return data;
 }
 
-template <typename ProgressAction, typename DownloadAction, typename ErrorAction, typename Time>
-QByteArray download(QNetworkAccessManager* manager, const Time& timeout, QUrl const& url, ProgressAction&& on_progress,
-                    DownloadAction&& on_download, ErrorAction&& on_error, const std::atomic_bool& abort_download)
+auto make_request(const QUrl& url)
 {
-    QEventLoop event_loop;
-    QTimer download_timeout;
-    download_timeout.setInterval(timeout);
-
     QNetworkRequest request{url};
     request.setRawHeader("Connection", "Keep-Alive");
     request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
+    // Requests to the same host then share a single connection, where the server speaks HTTP/2
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, url.scheme() == "https");
     request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
     request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+    return request;
+}
+
+// What identifies the version of the remote file, for a later request to resume downloading only that version
+QByteArray validator_from(QNetworkReply* reply)
+{
+    auto validator = reply->rawHeader("ETag");
+    return validator.isEmpty() ? reply->rawHeader("Last-Modified") : validator;
+}
 
-    auto reply = manager->get(request);
+QByteArray read_validator(const QString& validator_name)
+{
+    QFile validator_file{validator_name};
+    return validator_file.open(QIODevice::ReadOnly) ? validator_file.readAll() : QByteArray{};
+}
+
+void write_validator(const QString& validator_name, const QByteArray& validator)
+{
+    // Without a validator, there is no telling whether what was downloaded is still good
+    QFile validator_file{validator_name};
+    if (validator.isEmpty() || !validator_file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        validator_file.write(validator) != validator.size())
+        validator_file.remove();
+}
+
+// Errors that another attempt may not run into: dropped connections, timeouts and servers that are having trouble
+bool is_transient(QNetworkReply* reply)
+{
+    const auto error = reply->error();
+    return (error > QNetworkReply::NoError && error < QNetworkReply::ProxyConnectionRefusedError) ||
+           (error >= QNetworkReply::InternalServerError && error <= QNetworkReply::UnknownServerError);
+}
+
+bool wait_unless_aborted(std::chrono::milliseconds delay, const std::atomic_bool& abort_download)
+{
+    const auto deadline = std::chrono::steady_clock::now() + delay;
+    while (!abort_download && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    return !abort_download;
+}
+
+bool accepts_ranges(QNetworkAccessManager* manager, std::chrono::milliseconds timeout, const QUrl& url, qint64 size)
+{
+    QEventLoop event_loop;
+    QTimer::singleShot(timeout, &event_loop, &QEventLoop::quit);
+
+    auto reply = manager->head(make_request(url));
+    QObject::connect(reply, &QNetworkReply::finished, &event_loop, &QEventLoop::quit);
+    event_loop.exec();
+
+    const auto accepted = reply->isFinished() && reply->error() == QNetworkReply::NoError &&
+                          reply->rawHeader("Accept-Ranges") == "bytes" &&
+                          reply->header(QNetworkRequest::ContentLengthHeader).toLongLong() == size;
+    reply->abort();
+    reply->deleteLater();
+
+    return accepted;
+}
+
+struct Segment
+{
+    qint64 next; // where the next byte received goes
+    qint64 end;  // one past the segment's last byte
+    int attempts{0};
+    QNetworkReply* reply{nullptr};
+};
+
+// Downloads the file in several ranges at once, each written where it goes in the file. Returns false if the server
+// doesn't send the ranges it is asked for, in which case the file is of no use.
+template <typename ProgressAction>
+bool download_segments(QNetworkAccessManager* manager, std::chrono::milliseconds timeout, const QUrl& url, QFile& file,
+                       qint64 size, ProgressAction&& on_progress, QCryptographicHash* digest,
+                       const std::atomic_bool& abort_download)
+{
+    if (!file.resize(size))
+        throw std::runtime_error(fmt::format("cannot allocate {}: {}", file.fileName(), file.errorString()));
+
+    std::vector<Segment> segments;
+    const auto segment_size = (size + num_download_segments - 1) / num_download_segments;
+    for (qint64 begin = 0; begin < size; begin += segment_size)
+        segments.push_back({begin, std::min(begin + segment_size, size)});
+
+    QEventLoop event_loop;
+    QTimer download_timeout;
+    download_timeout.setInterval(timeout);
+
+    auto remaining = segments.size();
+    qint64 bytes_received{0}, bytes_hashed{0};
+    bool ranges_refused{false}, give_up{false};
+    std::string failure;
+
+    // The segments come in out of order, so the digest takes in the start of the file as it fills in. What the first
+    // unfinished segment receives is hashed as it arrives, and what is further on is read back once it joins up.
+    auto hash = [&](const QByteArray& data, qint64 position) {
+        if (!digest)
+            return true;
+
+        if (position == bytes_hashed)
+        {
+            digest->addData(data);
+            bytes_hashed += data.size();
+        }
+
+        auto contiguous = size;
+        for (const auto& segment : segments)
+            if (segment.next < segment.end)
+            {
+                contiguous = segment.next;
+                break;
+            }
+
+        if (bytes_hashed < contiguous && !file.seek(bytes_hashed))
+            return false;
+
+        while (bytes_hashed < contiguous)
+        {
+            const auto chunk = file.read(std::min(contiguous - bytes_hashed, file_read_buffer_size));
+            if (chunk.isEmpty())
+                return false;
+
+            digest->addData(chunk);
+            bytes_hashed += chunk.size();
+        }
+
+        return true;
+    };
+
+    auto abort_all = [&segments] {
+        for (auto& segment : segments)
+            if (segment.reply)
+                segment.reply->abort();
+    };
+    auto quit_when_idle = [&segments, &event_loop] {
+        if (std::none_of(segments.cbegin(), segments.cend(), [](const auto& segment) { return segment.reply; }))
+            event_loop.quit();
+    };
+
+    // Any segment that stalls for as long as the timeout has them all start over from where they are
+    QObject::connect(&download_timeout, &QTimer::timeout, [&] {
+        download_timeout.stop();
+        abort_all();
+    });
+
+    std::function<void(Segment&)> start;
+    start = [&](Segment& segment) {
+        auto request = make_request(url);
+        // Each segment needs a connection of its own to download alongside the others
+        request.setAttribute(QNetworkRequest::Http2AllowedAttribute, false);
+        request.setRawHeader("Range", QString("bytes=%1-%2").arg(segment.next).arg(segment.end - 1).toLatin1());
+        auto reply = segment.reply = manager->get(request);
+        reply->setReadBufferSize(file_read_buffer_size);
+        download_timeout.start();
+
+        QObject::connect(reply, &QNetworkReply::readyRead, [&, reply] {
+            // A server that sends the whole file doesn't do ranges. Other answers are errors, dealt with once they end.
+            const auto status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            if (abort_download || status == 200)
+            {
+                ranges_refused = !abort_download;
+                abort_all();
+                return;
+            }
+
+            if (status != 206)
+                return;
+
+            const auto data = reply->read(segment.end - segment.next);
+            if (!file.seek(segment.next) || file.write(data) != data.size())
+            {
+                failure = fmt::format("error writing image: {}", file.errorString());
+                give_up = true;
+                abort_all();
+                return;
+            }
+
+            const auto position = segment.next;
+            segment.next += data.size();
+            bytes_received += data.size();
+            download_timeout.start();
+
+            if (!hash(data, position))
+            {
+                failure = fmt::format("cannot hash {}: {}", file.fileName(), file.errorString());
+                give_up = true;
+                abort_all();
+                return;
+            }
+
+            if (!on_progress(bytes_received))
+            {
+                give_up = true;
+                abort_all();
+            }
+        });
+
+        QObject::connect(reply, &QNetworkReply::finished, [&, reply] {
+            reply->deleteLater();
+            segment.reply = nullptr;
+
+            if (reply->error() == QNetworkReply::NoError && segment.next == segment.end)
+            {
+                if (--remaining == 0)
+                    event_loop.quit();
+                return;
+            }
+
+            if (!ranges_refused && !give_up && !abort_download &&
+                (reply->error() == QNetworkReply::NoError || is_transient(reply)) &&
+                ++segment.attempts < max_download_attempts)
+            {
+                const auto delay = first_retry_delay * (1 << (segment.attempts - 1));
+                mpl::log(mpl::Level::warning, category,
+                         fmt::format("cannot download part of {}: {}; retrying in {}ms", url.toString(),
+                                     reply->errorString(), delay.count()));
+                QTimer::singleShot(delay, &event_loop, [&] { start(segment); });
+                return;
+            }
+
+            if (failure.empty())
+                failure = reply->errorString().toStdString();
+            abort_all();
+            quit_when_idle();
+        });
+    };
+
+    for (auto& segment : segments)
+        start(segment);
+    event_loop.exec();
+
+    if (ranges_refused)
+        return false;
+
+    if (abort_download)
+        throw mp::AbortedDownloadException{failure};
+
+    if (remaining > 0)
+        throw mp::DownloadException{url.toString().toStdString(), failure};
+
+    return true;
+}
+
+template <typename ProgressAction, typename DownloadAction, typename ErrorAction, typename Time>
+QByteArray download(QNetworkAccessManager* manager, const Time& timeout, const QNetworkRequest& request,
+                    ProgressAction&& on_progress, DownloadAction&& on_download, ErrorAction&& on_error,
+                    const std::atomic_bool& abort_download, qint64 read_buffer_size = 0,
+                    bool* copy_is_current = nullptr)
+{
+    QEventLoop event_loop;
+    QTimer download_timeout;
+    download_timeout.setInterval(timeout);
+
+    const auto url = request.url();
+    ReplyHandle reply_handle{manager->get(request)};
+    auto reply = reply_handle.get();
+    reply->setReadBufferSize(read_buffer_size);
 
     QObject::connect(reply, &QNetworkReply::finished, &event_loop, &QEventLoop::quit);
     QObject::connect(reply, &QNetworkReply::downloadProgress, [&](qint64 bytes_received, qint64 bytes_total) {
@@ -94,7 +402,7 @@ QByteArray download(QNetworkAccessManager* manager, const Time& timeout, QUrl co
     event_loop.exec();
     if (reply->error() != QNetworkReply::NoError)
     {
-        on_error();
+        on_error(reply);
 
         const auto msg = reply->errorString().toStdString();
 
@@ -106,6 +414,16 @@ QByteArray download(QNetworkAccessManager* manager, const Time& timeout, QUrl co
         else
             throw mp::DownloadException{url.toString().toStdString(), download_timeout.isActive() ? msg : "Network timeout"};
     }
+
+    // The server answers 304 when the cached copy is current, which Qt usually hands over itself, as if from the cache
+    if (copy_is_current)
+    {
+        *copy_is_current = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304 ||
+                           reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
+        if (*copy_is_current)
+            return {};
+    }
+
     return reply->readAll();
 }
 } // namespace
@@ -120,75 +438,317 @@ mp::URLDownloader::URLDownloader(const mp::Path& cache_dir, std::chrono::millise
 }
 
 void mp::URLDownloader::download_to(const QUrl& url, const QString& file_name, int64_t size, const int download_type,
-                                    const mp::ProgressMonitor& monitor)
+                                    const mp::ProgressMonitor& monitor, QCryptographicHash* digest)
 {
-    auto manager{make_network_manager(cache_dir_path)};
+    auto manager = network_manager_for(cache_dir_path);
+
+    // The download goes to a .part file, along with what identifies the version of the remote file. If it fails, it
+    // then carries on from where it stopped, whether on retry or the next time the same file is downloaded.
+    const auto part_name = file_name + part_suffix;
+    const auto validator_name = part_name + validator_suffix;
+    auto validator = read_validator(validator_name);
+
+    QFile file{part_name};
+    const auto resuming = !validator.isEmpty() && file.exists();
+    file.open(resuming ? QIODevice::ReadWrite : QIODevice::ReadWrite | QIODevice::Truncate);
+    if (resuming && digest)
+        digest->addData(&file);
+    file.seek(file.size());
+
+    auto restart = [&] {
+        file.resize(0);
+        file.seek(0);
+        if (digest)
+            digest->reset();
+        validator.clear();
+        QFile::remove(validator_name);
+    };
 
-    QFile file{file_name};
-    file.open(QIODevice::ReadWrite | QIODevice::Truncate);
+    auto move_into_place = [&] {
+        file.close();
+        QFile::remove(file_name);
+        if (!QFile::rename(part_name, file_name))
+            throw std::runtime_error(fmt::format("cannot move {} into place", part_name));
+        QFile::remove(validator_name);
+    };
 
-    auto progress_monitor = [&monitor, download_type, size](QNetworkReply* reply, qint64 bytes_received,
-                                                            qint64 bytes_total) {
-        if (bytes_received == 0)
-            return;
+    // Large files come down in several parts at once, which gets around mirrors limiting each connection's speed.
+    // Those parts can't be resumed later, as there is no telling which of them made it.
+    if (!resuming && size >= min_segmented_download_size && accepts_ranges(manager, timeout, url, size))
+    {
+        auto on_progress = [&monitor, download_type, size](qint64 bytes_received) {
+            return monitor(download_type, (100 * bytes_received + size / 2) / size);
+        };
 
-        if (bytes_total == -1 && size > 0)
-            bytes_total = size;
+        if (download_segments(manager, timeout, url, file, size, on_progress, digest, abort_download))
+            return move_into_place();
 
-        auto progress = (size < 0) ? size : (100 * bytes_received + bytes_total / 2) / bytes_total;
-        if (!monitor(download_type, progress))
+        mpl::log(mpl::Level::debug, category, fmt::format("{} can't be downloaded in parts", url.toString()));
+        restart();
+    }
+
+    for (int attempt = 1;; ++attempt)
+    {
+        if (validator.isEmpty() && file.size() > 0) // there's no asking for the rest of the same file
+            restart();
+
+        qint64 offset{file.size()};
+        bool first_chunk{true}, give_up{false}, retryable{false};
+
+        auto request = make_request(url);
+        if (offset > 0)
         {
-            reply->abort();
+            request.setRawHeader("Range", "bytes=" + QByteArray::number(offset) + "-");
+            request.setRawHeader("If-Range", validator);
+            mpl::log(mpl::Level::debug, category, fmt::format("resuming {} from byte {}", url.toString(), offset));
         }
-    };
 
-    auto on_download = [this, &file](QNetworkReply* reply, QTimer& download_timeout) {
-        if (abort_download)
+        auto progress_monitor = [&monitor, &offset, &give_up, download_type, size](
+                                    QNetworkReply* reply, qint64 bytes_received, qint64 bytes_total) {
+            if (bytes_received == 0)
+                return;
+
+            // Progress is over the whole file, including what a previous attempt already got
+            bytes_received += offset;
+            if (bytes_total != -1)
+                bytes_total += offset;
+            else if (size > 0)
+                bytes_total = size;
+
+            // Without a size to go by, there is no telling how far along the download is
+            auto progress = bytes_total > 0 ? (100 * bytes_received + bytes_total / 2) / bytes_total : -1;
+            if (!monitor(download_type, progress))
+            {
+                give_up = true;
+                reply->abort();
+            }
+        };
+
+        auto on_download = [&](QNetworkReply* reply, QTimer& download_timeout) {
+            if (abort_download)
+            {
+                reply->abort();
+                return;
+            }
+
+            if (download_timeout.isActive())
+                download_timeout.stop();
+            else
+                return;
+
+            if (first_chunk)
+            {
+                first_chunk = false;
+
+                // The server sends the whole file instead of the rest of it when it changed or can't send ranges
+                const auto status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+                if (offset > 0 && status != 206)
+                {
+                    restart();
+                    offset = 0;
+                }
+
+                validator = validator_from(reply);
+                write_validator(validator_name, validator);
+            }
+
+            const auto data = reply->readAll();
+            if (file.write(data) < 0)
+            {
+                mpl::log(mpl::Level::error, category, fmt::format("error writing image: {}", file.errorString()));
+                give_up = true;
+                reply->abort();
+            }
+            else if (digest)
+            {
+                digest->addData(data);
+            }
+            download_timeout.start();
+        };
+
+        auto on_error = [&](QNetworkReply* reply) {
+            // The part we have doesn't fit the remote file anymore, so the next attempt starts over
+            const auto status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            const auto range_not_satisfiable = status == 416;
+            if (range_not_satisfiable)
+                restart();
+
+            retryable = !give_up && (range_not_satisfiable || is_transient(reply));
+        };
+
+        try
         {
-            reply->abort();
-            return;
+            ::download(manager, timeout, request, progress_monitor, on_download, on_error, abort_download,
+                       file_read_buffer_size);
+            break;
         }
+        catch (const mp::DownloadException& e)
+        {
+            if (!retryable || attempt == max_download_attempts)
+                throw;
 
-        if (download_timeout.isActive())
-            download_timeout.stop();
-        else
-            return;
+            const auto delay = first_retry_delay * (1 << (attempt - 1));
+            mpl::log(mpl::Level::warning, category, fmt::format("{}; retrying in {}ms", e.what(), delay.count()));
+            if (!wait_unless_aborted(delay, abort_download))
+                throw mp::AbortedDownloadException{e.what()};
+        }
+    }
+
+    move_into_place();
+}
+
+void mp::URLDownloader::download_stream(const QUrl& url, const DataConsumer& consume, int64_t size,
+                                        const int download_type, const mp::ProgressMonitor& monitor,
+                                        QCryptographicHash* digest)
+{
+    auto manager = network_manager_for(cache_dir_path);
 
-        if (file.write(reply->readAll()) < 0)
+    // What was handed over can't be taken back, so a retry asks for the rest of the same version of the file and
+    // skips what it already got if the server sends all of it again
+    qint64 delivered{0};
+    QByteArray validator;
+    std::exception_ptr consume_error;
+
+    for (int attempt = 1;; ++attempt)
+    {
+        qint64 position{0}; // where the next byte received is in the file
+        bool first_chunk{true}, give_up{false}, retryable{false};
+
+        auto request = make_request(url);
+        if (delivered > 0)
         {
-            mpl::log(mpl::Level::error, category, fmt::format("error writing image: {}", file.errorString()));
-            reply->abort();
+            request.setRawHeader("Range", "bytes=" + QByteArray::number(delivered) + "-");
+            request.setRawHeader("If-Range", validator);
+            mpl::log(mpl::Level::debug, category, fmt::format("resuming {} from byte {}", url.toString(), delivered));
         }
-        download_timeout.start();
-    };
 
-    auto on_error = [&file]() { file.remove(); };
+        auto progress_monitor = [&monitor, &position, &give_up, download_type, size](
+                                    QNetworkReply* reply, qint64 bytes_received, qint64 bytes_total) {
+            if (bytes_received == 0)
+                return;
 
-    ::download(manager.get(), timeout, url, progress_monitor, on_download, on_error, abort_download);
+            const auto progress = (size < 0) ? size : (100 * std::min<qint64>(position, size) + size / 2) / size;
+            if (!monitor(download_type, progress))
+            {
+                give_up = true;
+                reply->abort();
+            }
+        };
+
+        auto on_download = [&](QNetworkReply* reply, QTimer& download_timeout) {
+            if (abort_download)
+            {
+                reply->abort();
+                return;
+            }
+
+            if (download_timeout.isActive())
+                download_timeout.stop();
+            else
+                return;
+
+            if (first_chunk)
+            {
+                first_chunk = false;
+
+                const auto status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+                if (status == 206)
+                    position = delivered;
+                else if (delivered > 0 && validator_from(reply) != validator)
+                {
+                    mpl::log(mpl::Level::error, category, fmt::format("{} changed while downloading", url.toString()));
+                    give_up = true;
+                    reply->abort();
+                    return;
+                }
+
+                validator = validator_from(reply);
+            }
+
+            auto data = reply->readAll();
+            const auto already_delivered = std::min<qint64>(std::max<qint64>(delivered - position, 0), data.size());
+            position += data.size();
+            data.remove(0, already_delivered);
+
+            if (!data.isEmpty())
+            {
+                try
+                {
+                    consume(data);
+                }
+                catch (...)
+                {
+                    consume_error = std::current_exception();
+                    give_up = true;
+                    reply->abort();
+                    return;
+                }
+
+                if (digest)
+                    digest->addData(data);
+                delivered += data.size();
+            }
+            download_timeout.start();
+        };
+
+        auto on_error = [&](QNetworkReply* reply) {
+            // Without a validator, there is no asking for the rest of the same file
+            retryable = !give_up && (delivered == 0 || !validator.isEmpty()) && is_transient(reply);
+        };
+
+        try
+        {
+            ::download(manager, timeout, request, progress_monitor, on_download, on_error, abort_download,
+                       file_read_buffer_size);
+            return;
+        }
+        catch (const mp::DownloadException& e)
+        {
+            if (consume_error)
+                std::rethrow_exception(consume_error);
+
+            if (!retryable || attempt == max_download_attempts)
+                throw;
+
+            const auto delay = first_retry_delay * (1 << (attempt - 1));
+            mpl::log(mpl::Level::warning, category, fmt::format("{}; retrying in {}ms", e.what(), delay.count()));
+            if (!wait_unless_aborted(delay, abort_download))
+                throw mp::AbortedDownloadException{e.what()};
+        }
+    }
 }
 
 QByteArray mp::URLDownloader::download(const QUrl& url)
 {
-    auto manager{make_network_manager(cache_dir_path)};
+    return download_validating_copy(url, nullptr);
+}
+
+QByteArray mp::URLDownloader::download_if_modified(const QUrl& url, bool& not_modified)
+{
+    return download_validating_copy(url, &not_modified);
+}
+
+QByteArray mp::URLDownloader::download_validating_copy(const QUrl& url, bool* not_modified)
+{
+    if (not_modified)
+        *not_modified = false;
+
+    auto manager = network_manager_for(cache_dir_path);
 
     auto network_cache = manager->cache();
     auto metadata = network_cache->metaData(url);
 
+    // With a copy at hand, the server only sends the file again if it changed, and otherwise answers 304 in a
+    // single round trip, in which case the copy is what is returned
+    auto request = make_request(url);
     if (metadata.isValid())
     {
-        try
-        {
-            if (last_modified(url) == metadata.lastModified())
-            {
-                return get_network_cache_data(network_cache, url);
-            }
-        }
-        catch (const std::exception& e)
+        for (const auto& header : metadata.rawHeaders())
         {
-            mpl::log(
-                mpl::Level::info, category,
-                fmt::format("Cannot get last modified date for {}: {}. Using cached data.", url.toString(), e.what()));
-            return get_network_cache_data(network_cache, url);
+            if (header.first.toLower() == "etag")
+                request.setRawHeader("If-None-Match", header.second);
+            else if (header.first.toLower() == "last-modified")
+                request.setRawHeader("If-Modified-Since", header.second);
         }
     }
 
@@ -206,8 +766,24 @@ QByteArray mp::URLDownloader::download(const QUrl& url)
 
     try
     {
-        return ::download(manager.get(), timeout, url, [](QNetworkReply*, qint64, qint64) {}, on_download, [] {},
-                          abort_download);
+        bool copy_is_current{false};
+        auto data = ::download(manager, timeout, request, [](QNetworkReply*, qint64, qint64) {}, on_download,
+                               [](QNetworkReply*) {}, abort_download, 0, &copy_is_current);
+        if (!copy_is_current)
+            return data;
+
+        // The copy may have gone from the cache in the meantime, in which case there is nothing to validate
+        if (!network_cache->metaData(url).isValid())
+            return ::download(manager, timeout, make_request(url), [](QNetworkReply*, qint64, qint64) {}, on_download,
+                              [](QNetworkReply*) {}, abort_download);
+
+        if (not_modified)
+        {
+            *not_modified = true;
+            return {};
+        }
+
+        return get_network_cache_data(network_cache, url);
     }
     catch (const std::exception& e)
     {
@@ -227,14 +803,12 @@ QByteArray mp::URLDownloader::download(const QUrl& url)
 
 QDateTime mp::URLDownloader::last_modified(const QUrl& url)
 {
-    auto manager{make_network_manager(cache_dir_path)};
+    auto manager = network_manager_for(cache_dir_path);
 
     QEventLoop event_loop;
 
-    QNetworkRequest request{url};
-    request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
-
-    auto reply = manager->head(request);
+    ReplyHandle reply_handle{manager->head(make_request(url))};
+    auto reply = reply_handle.get();
     QObject::connect(reply, &QNetworkReply::finished, &event_loop, &QEventLoop::quit);
 
     event_loop.exec();
@@ -258,6 +832,27 @@ QDateTime mp::URLDownloader::last_modified(const QUrl& url)
     return reply->header(QNetworkRequest::LastModifiedHeader).toDateTime();
 }
 
+int64_t mp::URLDownloader::content_length(const QUrl& url)
+{
+    auto manager = network_manager_for(cache_dir_path);
+
+    QEventLoop event_loop;
+    QTimer::singleShot(timeout, &event_loop, &QEventLoop::quit);
+
+    ReplyHandle reply_handle{manager->head(make_request(url))};
+    auto reply = reply_handle.get();
+    QObject::connect(reply, &QNetworkReply::finished, &event_loop, &QEventLoop::quit);
+
+    event_loop.exec();
+
+    bool known{false};
+    const auto length = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong(&known);
+    const auto answered = reply->isFinished() && reply->error() == QNetworkReply::NoError && known;
+    reply->abort();
+
+    return answered ? length : -1;
+}
+
 void mp::URLDownloader::abort_all_downloads()
 {
     abort_download = true;
@@ -197,3 +197,16 @@ QString mp::LibVirtVirtualMachineFactory::get_backend_version_string()
     mpl::log(mpl::Level::error, logging_category, "Failed to determine libvirtd version.");
     return QString("libvirt-unknown");
 }
+
+mp::VMImageVault::UPtr mp::LibVirtVirtualMachineFactory::create_image_vault(std::vector<mp::VMImageHost*> image_hosts,
+                                                                            mp::URLDownloader* downloader,
+                                                                            const mp::Path& cache_dir_path,
+                                                                            const mp::Path& data_dir_path,
+                                                                            const mp::days& days_to_expire,
+                                                                            const mp::MemorySize& cache_size_budget)
+{
+    // Instance images are qcow2 overlays of the cached images, rather than copies of them
+    return std::make_unique<mp::DefaultVMImageVault>(image_hosts, downloader, cache_dir_path, data_dir_path,
+                                                     days_to_expire, mp::backend::create_qcow2_overlay,
+                                                     cache_size_budget);
+}
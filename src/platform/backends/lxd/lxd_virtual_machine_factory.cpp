@@ -122,7 +122,9 @@ mp::VMImageVault::UPtr mp::LXDVirtualMachineFactory::create_image_vault(std::vec
                                                                         mp::URLDownloader* downloader,
                                                                         const mp::Path& cache_dir_path,
                                                                         const mp::Path& data_dir_path,
-                                                                        const mp::days& days_to_expire)
+                                                                        const mp::days& days_to_expire,
+                                                                        const mp::MemorySize& cache_size_budget)
 {
+    // LXD keeps the images itself, so the budget of multipass' image cache doesn't apply
     return std::make_unique<mp::LXDVMImageVault>(image_hosts, manager.get(), base_url, days_to_expire);
 }
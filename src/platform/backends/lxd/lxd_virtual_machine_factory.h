@@ -50,7 +50,7 @@ public:
     QString get_backend_version_string() override;
     VMImageVault::UPtr create_image_vault(std::vector<VMImageHost*> image_hosts, URLDownloader* downloader,
                                           const Path& cache_dir_path, const Path& data_dir_path,
-                                          const days& days_to_expire) override;
+                                          const days& days_to_expire, const MemorySize& cache_size_budget) override;
 
 private:
     NetworkAccessManager::UPtr manager;
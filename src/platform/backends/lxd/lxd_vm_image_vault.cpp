@@ -284,6 +284,44 @@ void mp::LXDVMImageVault::update_images(const FetchType& fetch_type, const Prepa
     }
 }
 
+void mp::LXDVMImageVault::prefetch_image(const FetchType& fetch_type, const Query& query, const PrepareAction& prepare,
+                                         const ProgressMonitor& monitor, int64_t bytes_per_second)
+{
+    // LXD fetches images for instances itself, and refreshes those it has in update_images()
+    mpl::log(mpl::Level::debug, category, fmt::format("Not prefetching {}: LXD manages its own images", query.release));
+}
+
+// LXD keeps its own images, so there is no budget to report
+mp::VMImageVault::CacheUsage mp::LXDVMImageVault::cache_usage()
+{
+    QJsonObject json_reply;
+
+    try
+    {
+        json_reply = lxd_request(manager, "GET", QUrl(QString("%1/images?recursion=1").arg(base_url.toString())));
+    }
+    catch (const LXDNotFoundException&)
+    {
+        return {};
+    }
+
+    CacheUsage usage;
+    for (const auto image : json_reply["metadata"].toArray())
+    {
+        auto image_info = image.toObject();
+        auto last_used = std::chrono::system_clock::time_point(std::chrono::milliseconds(
+            QDateTime::fromString(image_info["last_used_at"].toString(), Qt::ISODateWithMs).toMSecsSinceEpoch()));
+        auto size = static_cast<int64_t>(image_info["size"].toDouble());
+
+        usage.images.push_back({image_info["fingerprint"].toString().toStdString(),
+                                image_info["properties"].toObject()["release"].toString().toStdString(),
+                                "", size, last_used, false, false});
+        usage.total_size += size;
+    }
+
+    return usage;
+}
+
 mp::VMImageInfo mp::LXDVMImageVault::info_for(const mp::Query& query)
 {
     if (!query.remote_name.empty())
@@ -47,6 +47,9 @@ public:
     void prune_expired_images() override;
     void update_images(const FetchType& fetch_type, const PrepareAction& prepare,
                        const ProgressMonitor& monitor) override;
+    CacheUsage cache_usage() override;
+    void prefetch_image(const FetchType& fetch_type, const Query& query, const PrepareAction& prepare,
+                        const ProgressMonitor& monitor, int64_t bytes_per_second) override;
 
 private:
     VMImageInfo info_for(const Query& query);
@@ -43,6 +43,9 @@ public:
     void prepare_instance_image(const VMImage& instance_image, const VirtualMachineDescription& desc) override;
     void hypervisor_health_check() override;
     QString get_backend_version_string() override;
+    VMImageVault::UPtr create_image_vault(std::vector<VMImageHost*> image_hosts, URLDownloader* downloader,
+                                          const Path& cache_dir_path, const Path& data_dir_path,
+                                          const days& days_to_expire, const MemorySize& cache_size_budget) override;
 
 private:
     const QString bridge_name;
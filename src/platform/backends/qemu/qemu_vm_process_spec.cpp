@@ -223,6 +223,7 @@ profile %1 flags=(attach_disconnected) {
   # Disk images
   %6 rwk,  # QCow2 filesystem image
   %7 rk,   # cloud-init ISO
+  %8
 }
     )END");
 
@@ -243,8 +244,12 @@ profile %1 flags=(attach_disconnected) {
         firmware = "/usr/share/seabios/*";
     }
 
+    QString backing_image_rule; // read access to the image that the instance's image is an overlay of, if any
+    if (!desc.image.backing_image_path.isEmpty())
+        backing_image_rule = QString("%1 rk,  # QCow2 backing image").arg(desc.image.backing_image_path);
+
     return profile_template.arg(apparmor_profile_name(), signal_peer, firmware, root_dir, program(),
-                                desc.image.image_path, desc.cloud_init_iso);
+                                desc.image.image_path, desc.cloud_init_iso, backing_image_rule);
 }
 
 QString mp::QemuVMProcessSpec::identifier() const
@@ -45,10 +45,10 @@ public:
 
     VMImageVault::UPtr create_image_vault(std::vector<VMImageHost*> image_hosts, URLDownloader* downloader,
                                           const Path& cache_dir_path, const Path& data_dir_path,
-                                          const days& days_to_expire) override
+                                          const days& days_to_expire, const MemorySize& cache_size_budget) override
     {
         return std::make_unique<DefaultVMImageVault>(image_hosts, downloader, cache_dir_path, data_dir_path,
-                                                     days_to_expire);
+                                                     days_to_expire, nullptr, cache_size_budget);
     };
 };
 } // namespace multipass
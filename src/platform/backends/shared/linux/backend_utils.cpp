@@ -27,6 +27,7 @@
 #include <multipass/format.h>
 
 #include <QCoreApplication>
+#include <QFileInfo>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QProcess>
@@ -183,6 +184,23 @@ mp::Path mp::backend::convert_to_qcow_if_necessary(const mp::Path& image_path)
     }
 }
 
+void mp::backend::create_qcow2_overlay(const mp::Path& backing_image_path, const mp::Path& overlay_path)
+{
+    // The backing file is referred to by its absolute path, so that the overlay can be used from anywhere
+    auto qemuimg_create_spec = std::make_unique<mp::QemuImgProcessSpec>(
+        QStringList{"create", "-f", "qcow2", "-F", "qcow2", "-b", QFileInfo{backing_image_path}.absoluteFilePath(),
+                    overlay_path});
+    auto qemuimg_create_process = MP_PROCFACTORY.create_process(std::move(qemuimg_create_spec));
+
+    auto process_state = qemuimg_create_process->execute();
+    if (!process_state.completed_successfully())
+    {
+        throw std::runtime_error(fmt::format("Cannot create instance image: qemu-img failed ({}) with output:\n{}",
+                                             process_state.failure_message(),
+                                             qemuimg_create_process->read_all_standard_error()));
+    }
+}
+
 QString mp::backend::cpu_arch()
 {
     const QHash<QString, QString> cpu_to_arch{{"x86_64", "x86_64"}, {"arm", "arm"},   {"arm64", "aarch64"},
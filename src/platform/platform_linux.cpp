@@ -37,6 +37,16 @@
 #include "shared/sshfs_server_process_spec.h"
 #include <disabled_update_prompt.h>
 
+#include <algorithm>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
 namespace mp = multipass;
 namespace mpl = multipass::logging;
 namespace mu = multipass::utils;
@@ -45,6 +55,78 @@ namespace
 {
 constexpr auto autostart_filename = "multipass.gui.autostart.desktop";
 
+class FileDescriptor
+{
+public:
+    explicit FileDescriptor(int fd) : fd{fd}
+    {
+    }
+
+    ~FileDescriptor()
+    {
+        if (fd >= 0)
+        {
+            const auto saved_errno = errno; // keep the error that made us give up
+            ::close(fd);
+            errno = saved_errno;
+        }
+    }
+
+    const int fd;
+};
+
+// Copies the given range in the kernel while it can, and through a buffer once it can't
+bool copy_range(int source_fd, int dest_fd, off_t offset, off_t length, bool& in_kernel)
+{
+    std::vector<char> buffer;
+    while (length > 0)
+    {
+        if (in_kernel)
+        {
+            loff_t source_offset{offset}, dest_offset{offset};
+            const auto copied = ::syscall(SYS_copy_file_range, source_fd, &source_offset, dest_fd, &dest_offset,
+                                          static_cast<size_t>(length), 0u);
+            if (copied > 0)
+            {
+                offset += copied;
+                length -= copied;
+                continue;
+            }
+
+            if (copied == 0)
+                return true; // the source is shorter than it was
+
+            if (errno == EINTR)
+                continue;
+
+            if (errno != ENOSYS && errno != EXDEV && errno != EINVAL && errno != EOPNOTSUPP)
+                return false;
+
+            in_kernel = false;
+        }
+
+        buffer.resize(1 << 20);
+        const auto num_read = ::pread(source_fd, buffer.data(), std::min<off_t>(length, buffer.size()), offset);
+        if (num_read < 0 && errno == EINTR)
+            continue;
+        if (num_read <= 0)
+            return num_read == 0;
+
+        for (ssize_t num_written = 0; num_written < num_read;)
+        {
+            const auto written = ::pwrite(dest_fd, buffer.data() + num_written, num_read - num_written,
+                                          offset + num_written);
+            if (written < 0 && errno != EINTR)
+                return false;
+            num_written += std::max<ssize_t>(written, 0);
+        }
+
+        offset += num_read;
+        length -= num_read;
+    }
+
+    return true;
+}
 } // namespace
 
 std::map<QString, QString> mp::platform::extra_settings_defaults()
@@ -152,6 +234,59 @@ bool mp::platform::link(const char* target, const char* link)
     return ::link(target, link) == 0;
 }
 
+bool mp::platform::copy_file(const char* source, const char* destination)
+{
+    FileDescriptor source_file{::open(source, O_RDONLY | O_CLOEXEC)};
+    if (source_file.fd < 0)
+        return false;
+
+    struct stat source_stat;
+    if (::fstat(source_file.fd, &source_stat) < 0)
+        return false;
+
+    FileDescriptor dest_file{::open(destination, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, source_stat.st_mode & 0777)};
+    if (dest_file.fd < 0)
+        return false;
+
+    // Sharing the source's extents makes the copy instant, on filesystems that allow it (e.g. btrfs, XFS)
+    if (::ioctl(dest_file.fd, FICLONE, source_file.fd) == 0)
+        return true;
+
+    // Otherwise, only the extents that hold data are copied, so that the source's holes stay holes
+    bool in_kernel{true};
+    off_t data{0};
+    while (data < source_stat.st_size)
+    {
+        data = ::lseek(source_file.fd, data, SEEK_DATA);
+        if (data < 0 && errno == ENXIO)
+            break; // only a hole is left
+
+        if (data < 0 && errno == EINVAL) // the filesystem can't tell where the holes are
+            return copy_range(source_file.fd, dest_file.fd, 0, source_stat.st_size, in_kernel);
+
+        const auto hole = data < 0 ? data : ::lseek(source_file.fd, data, SEEK_HOLE);
+        if (hole < 0 || !copy_range(source_file.fd, dest_file.fd, data, hole - data, in_kernel))
+            return false;
+
+        data = hole;
+    }
+
+    // Covers a trailing hole
+    return ::ftruncate(dest_file.fd, source_stat.st_size) == 0;
+}
+
+bool mp::platform::set_background_io_priority(bool background)
+{
+    // From linux/ioprio.h, which isn't part of the exported headers everywhere
+    constexpr auto ioprio_who_process = 1;
+    constexpr auto ioprio_class_shift = 13;
+    constexpr auto ioprio_class_idle = 3;
+
+    // Without a class, the priority follows the thread's niceness again
+    const auto priority = background ? ioprio_class_idle << ioprio_class_shift : 0;
+    return ::syscall(SYS_ioprio_set, ioprio_who_process, 0, priority) == 0; // 0 is the calling thread
+}
+
 bool mp::platform::is_alias_supported(const std::string& alias, const std::string& remote)
 {
     return true;
@@ -39,6 +39,7 @@ mp::DefaultUpdatePrompt::~DefaultUpdatePrompt() = default;
 
 bool mp::DefaultUpdatePrompt::is_time_to_show()
 {
+    std::lock_guard<decltype(last_shown_mutex)> lock{last_shown_mutex};
     return monitor->get_new_release() && last_shown + ::notify_user_frequency < std::chrono::system_clock::now();
 }
 
@@ -51,6 +52,8 @@ void mp::DefaultUpdatePrompt::populate(mp::UpdateInfo* update_info)
         update_info->set_url(new_release->url.toEncoded());
         update_info->set_title(new_release->title.toStdString());
         update_info->set_description(new_release->description.toStdString());
+
+        std::lock_guard<decltype(last_shown_mutex)> lock{last_shown_mutex};
         last_shown = std::chrono::system_clock::now();
     }
 }
@@ -21,6 +21,7 @@
 #include <multipass/update_prompt.h>
 #include <chrono>
 #include <memory>
+#include <mutex>
 
 namespace multipass
 {
@@ -41,6 +42,7 @@ public:
 
 private:
     std::unique_ptr<NewReleaseMonitor> monitor;
+    std::mutex last_shown_mutex; // prompts are populated from the daemon's request threads
     std::chrono::system_clock::time_point last_shown;
 };
 } // namespace multipass
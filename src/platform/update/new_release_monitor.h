@@ -26,6 +26,8 @@
 #include <QString>
 #include <QTimer>
 
+#include <mutex>
+
 namespace multipass
 {
 class LatestReleaseChecker;
@@ -58,6 +60,7 @@ private slots:
 
 private:
     const QString current_version, update_url;
+    mutable std::mutex new_release_mutex; // the release is read from the daemon's request threads
     optional<NewReleaseInfo> new_release;
     QTimer refresh_timer;
 
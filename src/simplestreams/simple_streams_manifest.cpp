@@ -26,6 +26,8 @@
 #include <multipass/exceptions/manifest_exceptions.h>
 #include <multipass/utils.h>
 
+#include <algorithm>
+
 namespace mp = multipass;
 
 namespace
@@ -89,6 +91,10 @@ std::unique_ptr<mp::SimpleStreamsManifest> mp::SimpleStreamsManifest::fromJson(c
     if (arch.isEmpty())
         throw mp::GenericManifestException("Unsupported cloud image architecture");
 
+    // Reading the setting goes to disk, so it is done once rather than for every version of every product
+    const auto driver = utils::get_driver_str();
+    const auto lxd = driver == "lxd";
+
     std::vector<VMImageInfo> products;
     for (const auto& value : manifest_products)
     {
@@ -112,19 +118,17 @@ std::unique_ptr<mp::SimpleStreamsManifest> mp::SimpleStreamsManifest::fromJson(c
         for (auto it = versions.constBegin(); it != versions.constEnd(); ++it)
         {
             const auto version_string = it.key();
-            const auto version = versions[version_string].toObject();
+            const auto version = it.value().toObject();
             const auto items = version["items"].toObject();
             if (items.isEmpty())
                 continue;
 
-            const auto& driver = utils::get_driver_str();
-
             QJsonObject image;
             QString sha256, image_location, kernel_location, initrd_location;
             int size = -1;
 
             // TODO: make this a VM factory call with a preference list
-            if (driver == "lxd")
+            if (lxd)
             {
                 image = items["lxd.tar.xz"].toObject();
                 sha256 = image["combined_disk1-img_sha256"].toString();
@@ -159,6 +163,10 @@ std::unique_ptr<mp::SimpleStreamsManifest> mp::SimpleStreamsManifest::fromJson(c
         throw mp::EmptyManifestException("No supported products found.");
 
     QMap<QString, const VMImageInfo*> map;
+    QHash<QString, const VMImageInfo*> by_id;
+    ProductIndex sorted_by_id;
+    by_id.reserve(static_cast<int>(products.size()));
+    sorted_by_id.reserve(products.size());
 
     for (const auto& product : products)
     {
@@ -167,8 +175,30 @@ std::unique_ptr<mp::SimpleStreamsManifest> mp::SimpleStreamsManifest::fromJson(c
         {
             map[alias] = &product;
         }
+
+        if (!by_id.contains(product.id))
+            by_id.insert(product.id, &product);
+        sorted_by_id.push_back(&product);
     }
 
-    return std::unique_ptr<SimpleStreamsManifest>(
-        new SimpleStreamsManifest{updated, std::move(products), std::move(map)});
+    std::stable_sort(sorted_by_id.begin(), sorted_by_id.end(),
+                     [](const VMImageInfo* a, const VMImageInfo* b) { return a->id < b->id; });
+
+    return std::unique_ptr<SimpleStreamsManifest>(new SimpleStreamsManifest{
+        updated, std::move(products), std::move(map), std::move(by_id), std::move(sorted_by_id)});
+}
+
+auto mp::SimpleStreamsManifest::product_with_id(const QString& id) const -> const VMImageInfo*
+{
+    return products_by_id.value(id, nullptr);
+}
+
+auto mp::SimpleStreamsManifest::products_with_id_prefix(const QString& prefix) const -> ProductRange
+{
+    const auto begin = std::lower_bound(products_sorted_by_id.cbegin(), products_sorted_by_id.cend(), prefix,
+                                        [](const VMImageInfo* product, const QString& id) { return product->id < id; });
+    const auto end = std::find_if(begin, products_sorted_by_id.cend(),
+                                  [&prefix](const VMImageInfo* product) { return !product->id.startsWith(prefix); });
+
+    return {begin, end};
 }
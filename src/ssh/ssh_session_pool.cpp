@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <multipass/ssh/ssh_session_pool.h>
+
+#include <algorithm>
+
+namespace mp = multipass;
+
+mp::SSHSessionPool::Lease::Lease(SSHSessionPool& pool, std::shared_ptr<Entry> entry,
+                                 std::unique_lock<std::mutex> entry_lock)
+    : pool{&pool}, entry{std::move(entry)}, entry_lock{std::move(entry_lock)}
+{
+}
+
+mp::SSHProcess mp::SSHSessionPool::Lease::exec(const std::string& cmd)
+{
+    const auto start = std::chrono::steady_clock::now();
+    auto process = entry->session->exec(cmd);
+    pool->record_channel_open(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+
+    return process;
+}
+
+mp::SSHSession& mp::SSHSessionPool::Lease::session()
+{
+    return *entry->session;
+}
+
+void mp::SSHSessionPool::Lease::reconnect()
+{
+    pool->connect(*entry);
+}
+
+mp::SSHSessionPool::SSHSessionPool(const SSHKeyProvider& key_provider) : key_provider{key_provider}
+{
+}
+
+mp::SSHSessionPool::Lease mp::SSHSessionPool::lease(const std::string& name, const std::string& hostname, int port,
+                                                    const std::string& username)
+{
+    std::shared_ptr<Entry> entry;
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        auto& pooled = entries[name];
+        if (!pooled)
+            pooled = std::make_shared<Entry>();
+        entry = pooled;
+    }
+
+    std::unique_lock<std::mutex> entry_lock{entry->mutex};
+
+    const bool reusable = entry->session && entry->hostname == hostname && entry->port == port &&
+                          entry->username == username && ssh_is_connected(*entry->session);
+
+    entry->hostname = hostname;
+    entry->port = port;
+    entry->username = username;
+
+    if (reusable)
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        ++current_metrics.handshakes_saved;
+    }
+    else
+    {
+        connect(*entry);
+    }
+
+    return {*this, std::move(entry), std::move(entry_lock)};
+}
+
+// Does not wait for a lease of the session to be over: the lease keeps the entry, which disconnects as it goes away
+void mp::SSHSessionPool::drop(const std::string& name)
+{
+    std::shared_ptr<Entry> entry; // the last reference unless leased, so the session disconnects outside the pool's lock
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    auto it = entries.find(name);
+    if (it == entries.end())
+        return;
+
+    entry = std::move(it->second);
+    entries.erase(it);
+}
+
+mp::SSHSessionPool::Metrics mp::SSHSessionPool::metrics() const
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    return current_metrics;
+}
+
+// Expects the entry's lock to be held
+void mp::SSHSessionPool::connect(Entry& entry)
+{
+    entry.session = nullopt;
+    entry.session.emplace(entry.hostname, entry.port, entry.username, key_provider);
+
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    ++current_metrics.handshakes;
+}
+
+void mp::SSHSessionPool::record_channel_open(std::chrono::microseconds time)
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    ++current_metrics.channels_opened;
+    current_metrics.total_channel_open_time += time;
+    current_metrics.max_channel_open_time = std::max(current_metrics.max_channel_open_time, time);
+}
@@ -16,6 +16,8 @@
  */
 
 #include <multipass/constants.h>
+#include <multipass/exceptions/invalid_memory_size_exception.h>
+#include <multipass/memory_size.h>
 #include <multipass/platform.h>
 #include <multipass/settings.h>
 #include <multipass/standard_paths.h>
@@ -23,6 +25,7 @@
 
 #include <QDir>
 #include <QKeySequence>
+#include <QRegularExpression>
 #include <QSettings>
 
 #include <algorithm>
@@ -53,7 +56,9 @@ std::map<QString, QString> make_defaults()
     auto ret = std::map<QString, QString>{{mp::petenv_key, petenv_name},
                                           {mp::driver_key, mp::platform::default_driver()},
                                           {mp::autostart_key, autostart_default},
-                                          {mp::hotkey_key, default_hotkey()}};
+                                          {mp::hotkey_key, default_hotkey()},
+                                          {mp::warm_images_key, QStringLiteral("")},
+                                          {mp::image_cache_budget_key, mp::image_cache_budget_default}};
 
     for(const auto& [k, v] : mp::platform::extra_settings_defaults())
         ret.insert_or_assign(k, v);
@@ -146,6 +151,38 @@ QString interpret_bool(QString val)
         return val;
 }
 
+QString interpret_image_list(const QString& key, const QString& val)
+{ // a comma-separated list of images, each an alias with an optional remote, as in "focal,daily:groovy"
+    static const QRegularExpression image_regex{QStringLiteral("^([\\w.-]+:)?[\\w.-]+$")};
+
+    QStringList images;
+    for (const auto& image : val.split(',', QString::SkipEmptyParts))
+    {
+        const auto trimmed = image.trimmed();
+        if (!image_regex.match(trimmed).hasMatch())
+            throw mp::InvalidSettingsException(key, val, QStringLiteral("Invalid image \"%1\"").arg(trimmed));
+
+        images << trimmed;
+    }
+
+    return images.join(',');
+}
+
+QString interpret_size(const QString& key, const QString& val)
+{
+    const auto trimmed = val.trimmed();
+    try
+    {
+        mp::MemorySize{trimmed.toStdString()};
+    }
+    catch (const mp::InvalidMemorySizeException&)
+    {
+        throw mp::InvalidSettingsException(key, val, QStringLiteral("Invalid size, try \"20G\" or \"0\" for no limit"));
+    }
+
+    return trimmed;
+}
+
 } // namespace
 
 mp::Settings::Settings(const Singleton<Settings>::PrivatePass& pass)
@@ -209,6 +246,10 @@ void multipass::Settings::set_aux(const QString& key, QString val) // work with
         throw InvalidSettingsException(key, val, "Invalid flag, try \"true\" or \"false\"");
     else if (key == winterm_key || key == hotkey_key)
         val = mp::platform::interpret_setting(key, val);
+    else if (key == warm_images_key)
+        val = interpret_image_list(key, val);
+    else if (key == image_cache_budget_key)
+        val = interpret_size(key, val);
 
     auto settings = persistent_settings(key);
     checked_set(*settings, key, val, mutex);
@@ -221,10 +221,12 @@ void mp::utils::wait_until_ssh_up(VirtualMachine* virtual_machine, std::chrono::
 }
 
 void mp::utils::wait_for_cloud_init(mp::VirtualMachine* virtual_machine, std::chrono::milliseconds timeout,
-                                    const mp::SSHKeyProvider& key_provider)
+                                    const mp::SSHKeyProvider& key_provider,
+                                    std::function<void()> const& ensure_still_wanted)
 {
-    auto action = [virtual_machine, &key_provider] {
+    auto action = [virtual_machine, &key_provider, &ensure_still_wanted] {
         virtual_machine->ensure_vm_is_running();
+        ensure_still_wanted();
         try
         {
             mp::SSHSession session{virtual_machine->ssh_hostname(), virtual_machine->ssh_port(),
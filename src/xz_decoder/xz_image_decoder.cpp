@@ -21,12 +21,211 @@
 
 #include <multipass/format.h>
 
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <mutex>
 #include <vector>
 
 namespace mp = multipass;
 
 namespace
 {
+constexpr auto max_size = 65536u;
+constexpr qint64 stream_header_size{12}; // as is the stream footer
+constexpr size_t sparse_block_size{4096};
+
+struct Block
+{
+    qint64 offset;            // where the block is in the xz file
+    qint64 unpadded_size;     // as the index has it, i.e. without the padding that follows the block
+    qint64 uncompressed_size;
+    qint64 decoded_offset;    // where the block's data goes in the decoded file
+};
+
+qint64 padded(qint64 size)
+{
+    return (size + 3) & ~qint64{3};
+}
+
+bool is_zero(const uint8_t* data, size_t size)
+{
+    // Comparing the data with itself, one byte on, makes use of the C library's vectorized memcmp
+    return size == 0 || (data[0] == 0 && std::memcmp(data, data + 1, size - 1) == 0);
+}
+
+uint32_t crc32_of(const QByteArray& data)
+{
+    return xz_crc32(reinterpret_cast<const uint8_t*>(data.constData()), data.size(), 0);
+}
+
+uint32_t read_uint32(const char* data)
+{
+    const auto bytes = reinterpret_cast<const uint8_t*>(data);
+    return bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+}
+
+QByteArray uint32_bytes(uint32_t value)
+{
+    QByteArray bytes;
+    for (int i = 0; i < 4; ++i, value >>= 8)
+        bytes += static_cast<char>(value & 0xff);
+    return bytes;
+}
+
+// Variable-length integers, as xz stores them: 7 bits per byte, least significant first
+bool read_vli(const QByteArray& data, int end, int& pos, qint64& value)
+{
+    value = 0;
+    for (int shift = 0; pos < end && shift < 63; shift += 7)
+    {
+        const auto byte = static_cast<uint8_t>(data[pos++]);
+        value |= static_cast<qint64>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+QByteArray vli_bytes(qint64 value)
+{
+    QByteArray bytes;
+    for (; value >= 0x80; value >>= 7)
+        bytes += static_cast<char>((value & 0x7f) | 0x80);
+    bytes += static_cast<char>(value);
+    return bytes;
+}
+
+// Finds each block from the index at the end of the file. Files that can't be split into blocks, e.g. because they
+// hold several streams, get none.
+std::vector<Block> read_block_index(QFile& xz_file)
+{
+    const auto file_size = xz_file.size();
+    if (file_size < 2 * stream_header_size)
+        return {};
+
+    xz_file.seek(0);
+    const auto stream_header = xz_file.read(stream_header_size);
+    xz_file.seek(file_size - stream_header_size);
+    const auto stream_footer = xz_file.read(stream_header_size);
+
+    if (stream_header.size() != stream_header_size || stream_footer.size() != stream_header_size ||
+        !stream_footer.endsWith("YZ") || stream_footer.mid(8, 2) != stream_header.mid(6, 2) ||
+        crc32_of(stream_footer.mid(4, 6)) != read_uint32(stream_footer.constData()))
+        return {};
+
+    const auto index_size = (read_uint32(stream_footer.constData() + 4) + qint64{1}) * 4;
+    const auto index_offset = file_size - stream_header_size - index_size;
+    if (index_offset < stream_header_size)
+        return {};
+
+    xz_file.seek(index_offset);
+    const auto index = xz_file.read(index_size);
+    const int records_end = index.size() - 4;
+    if (index.size() != index_size || index[0] != '\0' ||
+        crc32_of(index.left(records_end)) != read_uint32(index.constData() + records_end))
+        return {};
+
+    int pos{1};
+    qint64 num_blocks;
+    if (!read_vli(index, records_end, pos, num_blocks))
+        return {};
+
+    std::vector<Block> blocks;
+    qint64 offset{stream_header_size}, decoded_offset{0};
+    for (qint64 i = 0; i < num_blocks; ++i)
+    {
+        Block block{offset, 0, 0, decoded_offset};
+        if (!read_vli(index, records_end, pos, block.unpadded_size) ||
+            !read_vli(index, records_end, pos, block.uncompressed_size))
+            return {};
+
+        blocks.push_back(block);
+        offset += padded(block.unpadded_size);
+        decoded_offset += block.uncompressed_size;
+    }
+
+    // Blocks that don't add up to the index leave the file to be decoded in one go, which sorts out what it holds
+    return offset == index_offset ? blocks : std::vector<Block>{};
+}
+
+// Wraps a block in a stream of its own, with an index of just that block, so that it can be decoded by itself
+QByteArray stream_for(const QByteArray& stream_header, const QByteArray& block_data, const Block& block)
+{
+    QByteArray index(1, '\0');
+    index += vli_bytes(1) + vli_bytes(block.unpadded_size) + vli_bytes(block.uncompressed_size);
+    index.append(padded(index.size()) - index.size(), '\0');
+    index += uint32_bytes(crc32_of(index));
+
+    auto stream_footer = uint32_bytes(index.size() / 4 - 1) + stream_header.mid(6, 2);
+    stream_footer = uint32_bytes(crc32_of(stream_footer)) + stream_footer + "YZ";
+
+    return stream_header + block_data + index + stream_footer;
+}
+
+void decode_blocks(QFile& xz_file, const std::vector<Block>& blocks, const mp::Path& decoded_image_path,
+                   const mp::ProgressMonitor& monitor)
+{
+    xz_file.seek(0);
+    const auto stream_header = xz_file.read(stream_header_size);
+    const auto file_size = xz_file.size();
+
+    // Each block is written where it goes, so the decoded file is given its full size first
+    QFile decoded_file{decoded_image_path};
+    const auto decoded_size = blocks.back().decoded_offset + blocks.back().uncompressed_size;
+    if (!decoded_file.open(QIODevice::WriteOnly) || !decoded_file.resize(decoded_size))
+        throw std::runtime_error(fmt::format("failed to open {} for writing", decoded_file.fileName()));
+    decoded_file.close();
+
+    std::mutex mutex;
+    std::exception_ptr error;
+    qint64 total_bytes_extracted{0};
+
+    std::vector<QFuture<void>> decodes;
+    for (const auto& block : blocks)
+    {
+        decodes.push_back(QtConcurrent::run([&, block] {
+            try
+            {
+                {
+                    std::lock_guard<decltype(mutex)> lock{mutex};
+                    if (error)
+                        return;
+                }
+
+                QFile block_file{xz_file.fileName()};
+                if (!block_file.open(QIODevice::ReadOnly) || !block_file.seek(block.offset))
+                    throw std::runtime_error(fmt::format("failed to open {} for reading", block_file.fileName()));
+                const auto block_data = block_file.read(padded(block.unpadded_size));
+
+                mp::XzImageDecoder::StreamDecoder decoder{decoded_image_path, block.decoded_offset};
+                decoder.decode(stream_for(stream_header, block_data, block));
+                decoder.finish();
+
+                std::lock_guard<decltype(mutex)> lock{mutex};
+                total_bytes_extracted += block_data.size();
+                auto progress = (total_bytes_extracted / (float)file_size) * 100;
+                monitor(mp::LaunchProgress::EXTRACT, progress);
+            }
+            catch (...)
+            {
+                std::lock_guard<decltype(mutex)> lock{mutex};
+                if (!error)
+                    error = std::current_exception();
+            }
+        }));
+    }
+
+    for (auto& decode : decodes)
+        decode.waitForFinished();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
 bool verify_decode(const xz_ret& ret)
 {
     switch (ret)
@@ -54,8 +253,7 @@ bool verify_decode(const xz_ret& ret)
 }
 } // namespace
 
-mp::XzImageDecoder::XzImageDecoder(const Path& xz_file_path)
-    : xz_file{xz_file_path}, xz_decoder{xz_dec_init(XZ_DYNALLOC, 1u << 26), xz_dec_end}
+mp::XzImageDecoder::XzImageDecoder(const Path& xz_file_path) : xz_file{xz_file_path}
 {
     xz_crc32_init();
     xz_crc64_init();
@@ -66,50 +264,107 @@ void mp::XzImageDecoder::decode_to(const Path& decoded_image_path, const Progres
     if (!xz_file.open(QIODevice::ReadOnly))
         throw std::runtime_error(fmt::format("failed to open {} for reading", xz_file.fileName()));
 
-    QFile decoded_file{decoded_image_path};
-    if (!decoded_file.open(QIODevice::WriteOnly))
+    const auto blocks = read_block_index(xz_file);
+    if (blocks.size() > 1)
+        return decode_blocks(xz_file, blocks, decoded_image_path, monitor);
+
+    xz_file.seek(0);
+    StreamDecoder decoder{decoded_image_path};
+
+    const auto file_size = xz_file.size();
+    qint64 total_bytes_extracted{0};
+
+    QByteArray read_data;
+    while (!(read_data = xz_file.read(max_size)).isEmpty())
+    {
+        decoder.decode(read_data);
+
+        total_bytes_extracted += read_data.size();
+        auto progress = (total_bytes_extracted / (float)file_size) * 100;
+        monitor(LaunchProgress::EXTRACT, progress);
+    }
+
+    decoder.finish();
+}
+
+mp::XzImageDecoder::StreamDecoder::StreamDecoder(const Path& decoded_file_path)
+    : StreamDecoder{decoded_file_path, 0, QIODevice::WriteOnly}
+{
+}
+
+mp::XzImageDecoder::StreamDecoder::StreamDecoder(const Path& decoded_file_path, qint64 offset)
+    : StreamDecoder{decoded_file_path, offset, QIODevice::ReadWrite}
+{
+}
+
+mp::XzImageDecoder::StreamDecoder::StreamDecoder(const Path& decoded_file_path, qint64 offset,
+                                                 QIODevice::OpenMode mode)
+    : decoded_file{decoded_file_path},
+      xz_decoder{xz_dec_init(XZ_DYNALLOC, 1u << 26), xz_dec_end},
+      write_data(max_size)
+{
+    xz_crc32_init();
+    xz_crc64_init();
+
+    if (!decoded_file.open(mode) || !decoded_file.seek(offset))
         throw std::runtime_error(fmt::format("failed to open {} for writing", decoded_file.fileName()));
+}
+
+void mp::XzImageDecoder::StreamDecoder::decode(const QByteArray& data)
+{
+    // Anything after the end of the stream is of no interest
+    if (stream_ended)
+        return;
 
     struct xz_buf decode_buf
     {
     };
-    const auto max_size = 65536u;
+    decode_buf.in = reinterpret_cast<const uint8_t*>(data.constData());
+    decode_buf.in_pos = 0;
+    decode_buf.in_size = data.size();
+    decode_buf.out = write_data.data();
+    decode_buf.out_size = write_data.size();
 
-    std::vector<char> read_data, write_data;
-    read_data.reserve(max_size);
-    write_data.reserve(max_size);
+    // A full output buffer may leave decoded data behind, even once all the input is taken
+    do
+    {
+        decode_buf.out_pos = 0;
+        stream_ended = !verify_decode(xz_dec_run(xz_decoder.get(), &decode_buf));
 
-    decode_buf.in = reinterpret_cast<unsigned char*>(read_data.data());
-    decode_buf.in_pos = 0;
-    decode_buf.in_size = 0;
-    decode_buf.out = reinterpret_cast<unsigned char*>(write_data.data());
-    decode_buf.out_pos = 0;
-    decode_buf.out_size = max_size;
+        write(decode_buf.out_pos);
+    } while (!stream_ended && (decode_buf.in_pos < decode_buf.in_size || decode_buf.out_pos == decode_buf.out_size));
+}
 
-    const auto file_size = xz_file.size();
-    qint64 total_bytes_extracted{0};
+void mp::XzImageDecoder::StreamDecoder::finish()
+{
+    if (!stream_ended)
+        throw std::runtime_error("xz file is corrupt");
 
-    while (true)
+    // Zeros skipped at the end only count once the file is made to reach past them
+    if (decoded_file.size() < decoded_file.pos() && !decoded_file.resize(decoded_file.pos()))
+        throw std::runtime_error(
+            fmt::format("failed to write to {}: {}", decoded_file.fileName(), decoded_file.errorString()));
+
+    decoded_file.close();
+}
+
+// Runs of zeros, which make up most of a raw image, are skipped over rather than written, which leaves holes in the
+// file where the filesystem supports them
+void mp::XzImageDecoder::StreamDecoder::write(size_t size)
+{
+    for (size_t pos = 0; pos < size; pos += sparse_block_size)
     {
-        if (decode_buf.in_pos == decode_buf.in_size)
-        {
-            decode_buf.in_size = xz_file.read(read_data.data(), max_size);
-            decode_buf.in_pos = 0;
-            total_bytes_extracted += decode_buf.in_size;
-            auto progress = (total_bytes_extracted / (float)file_size) * 100;
-            monitor(LaunchProgress::EXTRACT, progress);
-        }
-
-        if (!verify_decode(xz_dec_run(xz_decoder.get(), &decode_buf)))
-        {
-            decoded_file.write(write_data.data(), decode_buf.out_pos);
-            return;
-        }
-
-        if (decode_buf.out_pos == max_size)
-        {
-            decoded_file.write(write_data.data(), decode_buf.out_pos);
-            decode_buf.out_pos = 0;
-        }
+        const auto data = write_data.data() + pos;
+        const auto length = std::min(size - pos, sparse_block_size);
+
+        bool written;
+        if (is_zero(data, length))
+            written = decoded_file.seek(decoded_file.pos() + length);
+        else
+            written = decoded_file.write(reinterpret_cast<const char*>(data), length) == static_cast<qint64>(length);
+
+        if (!written)
+            throw std::runtime_error(
+                fmt::format("failed to write to {}: {}", decoded_file.fileName(), decoded_file.errorString()));
     }
 }
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "file_operations.h"
+
+#include <multipass/simple_streams_manifest.h>
+#include <multipass/utils.h>
+
+#include <fmt/format.h>
+
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace mp = multipass;
+namespace mpt = multipass::test;
+
+/*
+ * Times the parts of SimpleStreamsManifest::fromJson on a manifest the size of a real stream, grown out of the
+ * products in tests/test_data/good_manifest.json. It weighs up two things:
+ * - reading the driver setting once per version, as fromJson used to, against the whole parse;
+ * - building the QJsonDocument, which is all a streaming parser could save, against the whole parse.
+ * It also times the parse of the manifests shipped in tests/test_data, as they are.
+ *
+ * Usage: simple_streams_manifest_benchmark [products per architecture] [versions per product]
+ */
+namespace
+{
+constexpr auto runs = 11;
+constexpr auto parses_per_run = 1000; // the shipped manifests are small enough to parse in microseconds
+const std::vector<QString> arches{"amd64", "arm64", "armhf", "i386", "ppc64el", "s390x"};
+const std::vector<const char*> shipped_manifests{"good_manifest.json", "releases/multiple_versions_manifest.json",
+                                                 "daily/daily_manifest.json"};
+
+// Copies each product of the template manifest for every architecture, with as many versions as asked for
+QByteArray grow_manifest(const QByteArray& template_json, int products_per_arch, int versions_per_product)
+{
+    auto manifest = QJsonDocument::fromJson(template_json).object();
+    const auto template_products = manifest["products"].toObject();
+    const auto template_keys = template_products.keys();
+
+    QJsonObject products;
+    for (const auto& arch : arches)
+    {
+        for (auto i = 0; i < products_per_arch; ++i)
+        {
+            const auto& key = template_keys.at(i % template_keys.size());
+            auto product = template_products[key].toObject();
+            product["arch"] = arch;
+
+            const auto template_versions = product["versions"].toObject();
+            const auto template_version = template_versions.begin().value();
+
+            QJsonObject versions;
+            for (auto j = 0; j < versions_per_product; ++j)
+                versions[QString{"%1.%2"}.arg(template_versions.begin().key()).arg(j, 3, 10, QChar{'0'})] =
+                    template_version;
+            product["versions"] = versions;
+
+            products[QString{"%1:%2:%3"}.arg(key).arg(i).arg(arch)] = product;
+        }
+    }
+    manifest["products"] = products;
+
+    return QJsonDocument{manifest}.toJson(QJsonDocument::Compact);
+}
+
+// The median time of a few runs, in milliseconds
+double median_ms(const std::function<void()>& action)
+{
+    std::vector<double> times;
+    for (auto i = 0; i < runs; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        action();
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    std::nth_element(times.begin(), times.begin() + runs / 2, times.end());
+    return times[runs / 2];
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("multipass_benchmarks");
+
+    const auto products_per_arch = argc > 1 ? std::stoi(argv[1]) : 40;
+    const auto versions_per_product = argc > 2 ? std::stoi(argv[2]) : 30;
+
+    const auto json = grow_manifest(mpt::load_test_file("good_manifest.json"), products_per_arch, versions_per_product);
+    const auto versions = mp::SimpleStreamsManifest::fromJson(json, "")->products.size();
+
+    const auto parse = median_ms([&json] { mp::SimpleStreamsManifest::fromJson(json, ""); });
+    const auto document = median_ms([&json] { QJsonDocument::fromJson(json); });
+    const auto driver_reads = median_ms([versions] {
+        for (auto i = 0u; i < versions; ++i)
+            mp::utils::get_driver_str();
+    });
+
+    std::cout << fmt::format("manifest: {:.1f} MiB, {} products, {} versions for this architecture\n",
+                             json.size() / (1024.0 * 1024.0), products_per_arch * arches.size(), versions)
+              << fmt::format("parse, reading the driver once: {:8.2f} ms\n", parse)
+              << fmt::format("reading the driver per version: {:8.2f} ms, {:.1f}x the parse\n", driver_reads,
+                             driver_reads / parse)
+              << fmt::format("building the QJsonDocument:     {:8.2f} ms, {:.0f}% of the parse\n", document,
+                             100 * document / parse);
+
+    for (const auto file_name : shipped_manifests)
+    {
+        const auto shipped = mpt::load_test_file(file_name);
+        try
+        {
+            const auto shipped_parse = median_ms([&shipped] {
+                for (auto i = 0; i < parses_per_run; ++i)
+                    mp::SimpleStreamsManifest::fromJson(shipped, "");
+            });
+
+            std::cout << fmt::format("{:<41} {:8.2f} us per parse, {} bytes\n", file_name,
+                                     1000 * shipped_parse / parses_per_run, shipped.size());
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << fmt::format("{:<41} not parsed: {}\n", file_name, e.what());
+        }
+    }
+
+    return 0;
+}
@@ -18,6 +18,7 @@
 #include "tests/fake_handle.h"
 #include "tests/mock_environment_helpers.h"
 #include "tests/mock_settings.h"
+#include "tests/temp_dir.h"
 #include "tests/test_with_mocked_bin_path.h"
 
 #include <src/platform/backends/libvirt/libvirt_virtual_machine_factory.h>
@@ -41,6 +42,10 @@
 
 #include <stdexcept>
 
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
 namespace mp = multipass;
 namespace mpt = multipass::test;
 using namespace testing;
@@ -349,6 +354,55 @@ TEST_F(PlatformLinux, test_not_snap_returns_expected_default_address)
     EXPECT_EQ(mp::platform::default_server_address(), fmt::format("unix:/run/multipass_socket"));
 }
 
+TEST_F(PlatformLinux, copy_file_keeps_contents_and_holes)
+{
+    mpt::TempDir temp_dir;
+    const auto source = temp_dir.path() + "/source.img";
+    const auto destination = temp_dir.path() + "/destination.img";
+    const QByteArray data{"some data in the middle"};
+    constexpr qint64 hole_size = 16 * 1024 * 1024;
+    {
+        QFile source_file{source};
+        ASSERT_TRUE(source_file.open(QIODevice::WriteOnly));
+        ASSERT_TRUE(source_file.seek(hole_size));
+        source_file.write(data);
+        ASSERT_TRUE(source_file.resize(2 * hole_size));
+    }
+
+    ASSERT_TRUE(
+        mp::platform::copy_file(QFile::encodeName(source).constData(), QFile::encodeName(destination).constData()));
+
+    QFile destination_file{destination};
+    ASSERT_TRUE(destination_file.open(QIODevice::ReadOnly));
+    EXPECT_EQ(destination_file.size(), 2 * hole_size);
+    ASSERT_TRUE(destination_file.seek(hole_size));
+    EXPECT_EQ(destination_file.read(data.size()), data);
+
+    struct stat destination_stat;
+    ASSERT_EQ(::stat(QFile::encodeName(destination).constData(), &destination_stat), 0);
+    EXPECT_LT(destination_stat.st_blocks * 512, hole_size);
+}
+
+TEST_F(PlatformLinux, copy_file_fails_for_missing_source)
+{
+    mpt::TempDir temp_dir;
+    const auto destination = temp_dir.path() + "/destination.img";
+
+    EXPECT_FALSE(mp::platform::copy_file("/not/a/file", QFile::encodeName(destination).constData()));
+    EXPECT_FALSE(QFile::exists(destination));
+}
+
+TEST_F(PlatformLinux, background_io_priority_is_idle_until_reset)
+{
+    auto io_class = [] { return ::syscall(SYS_ioprio_get, 1, 0) >> 13; }; // the calling thread's class
+
+    ASSERT_TRUE(mp::platform::set_background_io_priority(true));
+    EXPECT_EQ(io_class(), 3); // idle
+
+    ASSERT_TRUE(mp::platform::set_background_io_priority(false));
+    EXPECT_NE(io_class(), 3);
+}
+
 struct TestUnsupportedDrivers : public TestWithParam<QString>
 {
 };
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MULTIPASS_LOCAL_HTTP_SERVER_H
+#define MULTIPASS_LOCAL_HTTP_SERVER_H
+
+#include <QByteArray>
+#include <QHostAddress>
+#include <QList>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QUrl>
+
+#include <functional>
+#include <map>
+#include <memory>
+
+namespace multipass
+{
+namespace test
+{
+struct HTTPRequest
+{
+    QByteArray header(const QByteArray& name) const
+    {
+        auto it = headers.find(name.toLower());
+        return it == headers.end() ? QByteArray{} : it->second;
+    }
+
+    QByteArray method;
+    QByteArray path;
+    std::map<QByteArray, QByteArray> headers; // names in lower case
+};
+
+// Builds a response with the given status, such as "200 OK", that carries body. Content-Length is that of the body
+// unless headers give one, as for HEAD requests or bodies that are cut short.
+inline QByteArray http_response(const QByteArray& status, const QByteArray& body = {}, QList<QByteArray> headers = {})
+{
+    QByteArray response{"HTTP/1.1 " + status + "\r\n"};
+
+    bool has_length{false};
+    for (const auto& header : headers)
+    {
+        response += header + "\r\n";
+        has_length = has_length || header.toLower().startsWith("content-length:");
+    }
+
+    if (!has_length)
+        response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+
+    return response + "\r\n" + body;
+}
+
+/*
+ * LocalHTTPServer - answers HTTP requests on the loopback interface with what the handler makes of them
+ *
+ * Requests are taken as they come, on the thread that made the server, so that thread's event loop needs to run for
+ * them to be served. Downloads run one of their own while they wait. Connections are kept for further requests,
+ * unless a response says "Connection: close". Request bodies are not supported.
+ */
+class LocalHTTPServer
+{
+public:
+    using Handler = std::function<QByteArray(const HTTPRequest&)>;
+
+    explicit LocalHTTPServer(Handler handler) : handler{std::move(handler)}
+    {
+        server.listen(QHostAddress::LocalHost);
+
+        QObject::connect(&server, &QTcpServer::newConnection, [this] {
+            while (auto connection = server.nextPendingConnection())
+            {
+                auto received = std::make_shared<QByteArray>();
+                QObject::connect(connection, &QTcpSocket::readyRead, [this, connection, received] {
+                    *received += connection->readAll();
+
+                    int end;
+                    while ((end = received->indexOf("\r\n\r\n")) >= 0)
+                    {
+                        const auto response = this->handler(parse(received->left(end)));
+                        received->remove(0, end + 4);
+
+                        connection->write(response);
+                        if (response.left(response.indexOf("\r\n\r\n")).toLower().contains("connection: close"))
+                        {
+                            connection->disconnectFromHost();
+                            return;
+                        }
+                    }
+                });
+                QObject::connect(connection, &QTcpSocket::disconnected, connection, &QObject::deleteLater);
+            }
+        });
+    }
+
+    QUrl url_for(const QString& path) const
+    {
+        return QUrl{QString{"http://127.0.0.1:%1%2"}.arg(server.serverPort()).arg(path)};
+    }
+
+private:
+    static HTTPRequest parse(const QByteArray& head)
+    {
+        HTTPRequest request;
+
+        const auto lines = head.split('\n');
+        const auto request_line = lines.value(0).trimmed().split(' ');
+        request.method = request_line.value(0);
+        request.path = request_line.value(1);
+
+        for (auto i = 1; i < lines.size(); ++i)
+        {
+            const auto separator = lines[i].indexOf(':');
+            if (separator > 0)
+                request.headers[lines[i].left(separator).trimmed().toLower()] = lines[i].mid(separator + 1).trimmed();
+        }
+
+        return request;
+    }
+
+    Handler handler;
+    QTcpServer server;
+};
+} // namespace test
+} // namespace multipass
+
+#endif // MULTIPASS_LOCAL_HTTP_SERVER_H
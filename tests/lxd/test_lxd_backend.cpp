@@ -203,7 +203,8 @@ TEST_F(LXDBackend, factory_creates_expected_image_vault)
 
     mp::LXDVirtualMachineFactory backend{std::move(mock_network_access_manager), data_dir.path(), base_url};
 
-    auto vault = backend.create_image_vault(hosts, &stub_downloader, cache_dir.path(), data_dir.path(), mp::days{0});
+    auto vault = backend.create_image_vault(hosts, &stub_downloader, cache_dir.path(), data_dir.path(), mp::days{0},
+                                            mp::MemorySize{});
 
     EXPECT_TRUE(dynamic_cast<mp::LXDVMImageVault*>(vault.get()));
 }
@@ -648,7 +649,7 @@ TEST_F(LXDBackend, prepare_source_image_does_not_modify)
 {
     mp::LXDVirtualMachineFactory backend{std::move(mock_network_access_manager), data_dir.path(), base_url};
     const mp::VMImage original_image{"/path/to/image",          "", "", "deadbeef", "bin", "baz", "the past",
-                                     {"fee", "fi", "fo", "fum"}};
+                                     {"fee", "fi", "fo", "fum"}, {}};
 
     auto source_image = backend.prepare_source_image(original_image);
 
@@ -674,3 +674,29 @@ TEST_F(LXDImageVault, prune_expired_image_delete_fails_does_no_throw)
 
     EXPECT_TRUE(delete_requested);
 }
+
+TEST_F(LXDImageVault, cache_usage_reports_lxd_images)
+{
+    ON_CALL(*mock_network_access_manager.get(), createRequest(_, _, _)).WillByDefault([](auto, auto request, auto) {
+        auto op = request.attribute(QNetworkRequest::CustomVerbAttribute).toString();
+        auto url = request.url().toString();
+
+        if (op == "GET" && url.contains("1.0/images"))
+        {
+            return new mpt::MockLocalSocketReply(mpt::image_info_data);
+        }
+
+        return new mpt::MockLocalSocketReply(mpt::not_found_data, QNetworkReply::ContentNotFoundError);
+    });
+
+    mp::LXDVMImageVault image_vault{hosts, mock_network_access_manager.get(), base_url, mp::days{0}};
+
+    auto usage = image_vault.cache_usage();
+
+    ASSERT_EQ(usage.images.size(), 1u);
+    EXPECT_EQ(usage.images[0].id, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    EXPECT_EQ(usage.images[0].release, "bionic");
+    EXPECT_EQ(usage.images[0].size, 345572108);
+    EXPECT_EQ(usage.total_size, 345572108);
+    EXPECT_EQ(usage.budget, 0);
+}
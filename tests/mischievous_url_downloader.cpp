@@ -25,9 +25,17 @@ mpt::MischievousURLDownloader::MischievousURLDownloader(std::chrono::millisecond
 }
 
 void mpt::MischievousURLDownloader::download_to(const QUrl& url, const QString& file_name, int64_t size,
-                                                const int download_type, const mp::ProgressMonitor& monitor)
+                                                const int download_type, const mp::ProgressMonitor& monitor,
+                                                QCryptographicHash* digest)
 {
-    URLDownloader::download_to(choose_url(url), file_name, size, download_type, monitor);
+    URLDownloader::download_to(choose_url(url), file_name, size, download_type, monitor, digest);
+}
+
+void mpt::MischievousURLDownloader::download_stream(const QUrl& url, const DataConsumer& consume, int64_t size,
+                                                    const int download_type, const mp::ProgressMonitor& monitor,
+                                                    QCryptographicHash* digest)
+{
+    URLDownloader::download_stream(choose_url(url), consume, size, download_type, monitor, digest);
 }
 
 QByteArray mpt::MischievousURLDownloader::download(const QUrl& url)
@@ -35,6 +43,11 @@ QByteArray mpt::MischievousURLDownloader::download(const QUrl& url)
     return URLDownloader::download(choose_url(url));
 }
 
+QByteArray mpt::MischievousURLDownloader::download_if_modified(const QUrl& url, bool& not_modified)
+{
+    return URLDownloader::download_if_modified(choose_url(url), not_modified);
+}
+
 QDateTime mpt::MischievousURLDownloader::last_modified(const QUrl& url)
 {
     return URLDownloader::last_modified(choose_url(url));
@@ -32,8 +32,11 @@ public:
     MischievousURLDownloader(std::chrono::milliseconds timeout);
 
     void download_to(const QUrl& url, const QString& file_name, int64_t size, const int download_type,
-                     const ProgressMonitor& monitor) override;
+                     const ProgressMonitor& monitor, QCryptographicHash* digest) override;
+    void download_stream(const QUrl& url, const DataConsumer& consume, int64_t size, const int download_type,
+                         const ProgressMonitor& monitor, QCryptographicHash* digest) override;
     QByteArray download(const QUrl& url) override;
+    QByteArray download_if_modified(const QUrl& url, bool& not_modified) override;
     QDateTime last_modified(const QUrl& url) override;
 
 public:
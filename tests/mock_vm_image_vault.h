@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MULTIPASS_MOCK_VM_IMAGE_VAULT_H
+#define MULTIPASS_MOCK_VM_IMAGE_VAULT_H
+
+#include <multipass/query.h>
+#include <multipass/vm_image.h>
+#include <multipass/vm_image_vault.h>
+
+#include <gmock/gmock.h>
+
+namespace multipass
+{
+namespace test
+{
+struct MockVMImageVault : public VMImageVault
+{
+    MOCK_METHOD4(fetch_image, VMImage(const FetchType&, const Query&, const PrepareAction&, const ProgressMonitor&));
+    MOCK_METHOD1(remove, void(const std::string&));
+    MOCK_METHOD1(has_record_for, bool(const std::string&));
+    MOCK_METHOD0(prune_expired_images, void());
+    MOCK_METHOD3(update_images, void(const FetchType&, const PrepareAction&, const ProgressMonitor&));
+    MOCK_METHOD0(cache_usage, CacheUsage());
+    MOCK_METHOD5(prefetch_image,
+                 void(const FetchType&, const Query&, const PrepareAction&, const ProgressMonitor&, int64_t));
+};
+} // namespace test
+} // namespace multipass
+#endif // MULTIPASS_MOCK_VM_IMAGE_VAULT_H
@@ -176,6 +176,15 @@ TEST_F(TestQemuVMProcessSpec, apparmor_profile_includes_disk_images)
     EXPECT_TRUE(spec.apparmor_profile().contains("/path/to/cloud_init.iso rk,"));
 }
 
+TEST_F(TestQemuVMProcessSpec, apparmor_profile_includes_backing_image)
+{
+    auto overlay_desc = desc;
+    overlay_desc.image.backing_image_path = "/path/to/backing_image";
+    mp::QemuVMProcessSpec spec(overlay_desc, tap_device_name, mp::nullopt);
+
+    EXPECT_TRUE(spec.apparmor_profile().contains("/path/to/backing_image rk,"));
+}
+
 TEST_F(TestQemuVMProcessSpec, apparmor_profile_identifier)
 {
     mp::QemuVMProcessSpec spec(desc, tap_device_name, mp::nullopt);
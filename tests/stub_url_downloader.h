@@ -30,13 +30,21 @@ struct StubURLDownloader : public multipass::URLDownloader
     {
     }
     void download_to(const QUrl& url, const QString& file_name, int64_t size, const int download_type,
-                     const multipass::ProgressMonitor&) override
+                     const multipass::ProgressMonitor&, QCryptographicHash*) override
+    {
+    }
+    void download_stream(const QUrl& url, const DataConsumer& consume, int64_t size, const int download_type,
+                         const multipass::ProgressMonitor&, QCryptographicHash*) override
     {
     }
     QByteArray download(const QUrl& url) override
     {
         return {};
     }
+    QByteArray download_if_modified(const QUrl& url, bool& not_modified) override
+    {
+        return {};
+    }
 };
 } // namespace test
 } // namespace multipass
@@ -30,7 +30,7 @@ struct StubVMImageVault final : public multipass::VMImageVault
     multipass::VMImage fetch_image(const multipass::FetchType&, const multipass::Query&, const PrepareAction& prepare,
                                    const multipass::ProgressMonitor&) override
     {
-        return prepare({dummy_image.name(), dummy_image.name(), dummy_image.name(), {}, {}, {}, {}, {}});
+        return prepare({dummy_image.name(), dummy_image.name(), dummy_image.name(), {}, {}, {}, {}, {}, {}});
     };
 
     void remove(const std::string&) override{};
@@ -42,6 +42,12 @@ struct StubVMImageVault final : public multipass::VMImageVault
     void prune_expired_images() override{};
     void update_images(const FetchType& fetch_type, const PrepareAction& prepare,
                        const ProgressMonitor& monitor) override{};
+    CacheUsage cache_usage() override
+    {
+        return {};
+    }
+    void prefetch_image(const FetchType& fetch_type, const Query& query, const PrepareAction& prepare,
+                        const ProgressMonitor& monitor, int64_t bytes_per_second) override{};
 
     TempFile dummy_image;
 };
@@ -74,7 +74,8 @@ TEST_F(BaseFactory, create_image_vault_returns_default_vault)
     std::vector<mp::VMImageHost*> hosts;
     MockBaseFactory factory;
 
-    auto vault = factory.create_image_vault(hosts, &stub_downloader, cache_dir.path(), data_dir.path(), mp::days{0});
+    auto vault = factory.create_image_vault(hosts, &stub_downloader, cache_dir.path(), data_dir.path(), mp::days{0},
+                                            mp::MemorySize{});
 
     EXPECT_TRUE(dynamic_cast<mp::DefaultVMImageVault*>(vault.get()));
 }
@@ -62,6 +62,8 @@ struct MockDaemonRpc : public mp::DaemonRpc
                                       grpc::ServerWriter<mp::CreateReply>* reply)); // here only to ensure not called
     MOCK_METHOD3(launch, grpc::Status(grpc::ServerContext* context, const mp::LaunchRequest* request,
                                       grpc::ServerWriter<mp::LaunchReply>* reply));
+    MOCK_METHOD3(launch_many, grpc::Status(grpc::ServerContext* context, const mp::LaunchManyRequest* request,
+                                           grpc::ServerWriter<mp::LaunchReply>* reply));
     MOCK_METHOD3(purge, grpc::Status(grpc::ServerContext* context, const mp::PurgeRequest* request,
                                      grpc::ServerWriter<mp::PurgeReply>* response));
     MOCK_METHOD3(find, grpc::Status(grpc::ServerContext* context, const mp::FindRequest* request,
@@ -574,6 +576,35 @@ TEST_F(Client, launch_cmd_custom_image_http_ok)
     EXPECT_THAT(send_command({"launch", "http://foo"}), Eq(mp::ReturnCode::Ok));
 }
 
+TEST_F(Client, launch_cmd_count_option_launches_many)
+{
+    const auto many_matcher =
+        AllOf(Property(&mp::LaunchManyRequest::count, 3u), Property(&mp::LaunchManyRequest::max_parallel, 2u),
+              Property(&mp::LaunchManyRequest::launch, Property(&mp::LaunchRequest::instance_name, StrEq("ci"))));
+
+    EXPECT_CALL(mock_daemon, launch(_, _, _)).Times(0);
+    EXPECT_CALL(mock_daemon, launch_many(_, many_matcher, _));
+    EXPECT_THAT(send_command({"launch", "-n", "ci", "--count", "3", "--max-parallel", "2"}), Eq(mp::ReturnCode::Ok));
+}
+
+TEST_F(Client, launch_cmd_count_of_one_launches_single_instance)
+{
+    EXPECT_CALL(mock_daemon, launch(_, _, _));
+    EXPECT_CALL(mock_daemon, launch_many(_, _, _)).Times(0);
+    EXPECT_THAT(send_command({"launch", "--count", "1"}), Eq(mp::ReturnCode::Ok));
+}
+
+TEST_F(Client, launch_cmd_count_option_fails_with_invalid_value)
+{
+    EXPECT_THAT(send_command({"launch", "--count", "0"}), Eq(mp::ReturnCode::CommandLineError));
+    EXPECT_THAT(send_command({"launch", "--count", "many"}), Eq(mp::ReturnCode::CommandLineError));
+}
+
+TEST_F(Client, launch_cmd_max_parallel_option_fails_with_invalid_value)
+{
+    EXPECT_THAT(send_command({"launch", "--count", "2", "--max-parallel", "0"}), Eq(mp::ReturnCode::CommandLineError));
+}
+
 TEST_F(Client, launch_cmd_cloudinit_option_with_valid_file_is_ok)
 {
     QTemporaryFile tmpfile; // file is auto-deleted when this goes out of scope
@@ -1528,7 +1559,8 @@ TEST_P(TestBasicGetSetOptions, set_cmd_allows_empty_val)
 }
 
 INSTANTIATE_TEST_SUITE_P(Client, TestBasicGetSetOptions,
-                         Values(mp::petenv_key, mp::driver_key, mp::autostart_key, mp::hotkey_key));
+                         Values(mp::petenv_key, mp::driver_key, mp::autostart_key, mp::hotkey_key,
+                                mp::warm_images_key, mp::image_cache_budget_key));
 
 TEST_F(Client, get_cmd_fails_with_no_arguments)
 {
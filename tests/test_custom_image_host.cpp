@@ -222,7 +222,7 @@ TEST_F(CustomImageHost, handles_and_recovers_from_initial_network_failure)
     EXPECT_TRUE(host.info_for(query));
 }
 
-TEST_F(CustomImageHost, handles_and_recovers_from_later_network_failure)
+TEST_F(CustomImageHost, keeps_manifests_through_later_network_failure)
 {
     const auto ttl = 0s; // to ensure updates are always retried
     mp::CustomVMImageHost host{&url_downloader, ttl, test_path};
@@ -231,13 +231,16 @@ TEST_F(CustomImageHost, handles_and_recovers_from_later_network_failure)
     EXPECT_TRUE(host.info_for(query));
 
     url_downloader.mischiefs = 1000;
-    EXPECT_THROW(host.info_for(query), std::runtime_error);
+    EXPECT_TRUE(host.info_for(query)); // what it has is served while it is updated in the background
+    host.wait_for_manifest_update();
+    EXPECT_TRUE(host.info_for(query)); // and kept when the update fails
+    host.wait_for_manifest_update();
 
     url_downloader.mischiefs = 0;
     EXPECT_TRUE(host.info_for(query));
 }
 
-TEST_F(CustomImageHost, handles_and_recovers_from_independent_server_failures)
+TEST_F(CustomImageHost, keeps_manifests_of_servers_that_fail)
 {
     const auto ttl = 0h;
     mp::CustomVMImageHost host{&url_downloader, ttl, test_path};
@@ -248,6 +251,10 @@ TEST_F(CustomImageHost, handles_and_recovers_from_independent_server_failures)
     for (size_t i = 0; i < num_remotes; ++i)
     {
         url_downloader.mischiefs = i;
-        EXPECT_EQ(mpt::count_remotes(host), num_remotes - i);
+        mpt::count_remotes(host); // starts an update, which fails for i of the servers
+        host.wait_for_manifest_update();
+
+        EXPECT_EQ(mpt::count_remotes(host), num_remotes);
+        host.wait_for_manifest_update();
     }
 }
@@ -35,16 +35,22 @@
 #include "mock_environment_helpers.h"
 #include "mock_process_factory.h"
 #include "mock_standard_paths.h"
+#include "mock_settings.h"
+#include "mock_virtual_machine.h"
 #include "mock_virtual_machine_factory.h"
+#include "mock_vm_image_vault.h"
+#include "signal.h"
 #include "stub_cert_store.h"
 #include "stub_certprovider.h"
 #include "stub_image_host.h"
 #include "stub_logger.h"
 #include "stub_ssh_key_provider.h"
 #include "stub_terminal.h"
+#include "stub_virtual_machine.h"
 #include "stub_virtual_machine_factory.h"
 #include "stub_vm_image_vault.h"
 #include "temp_dir.h"
+#include "temp_file.h"
 
 #include <yaml-cpp/yaml.h>
 
@@ -53,17 +59,25 @@
 #include <QCoreApplication>
 #include <QNetworkProxyFactory>
 #include <QSysInfo>
+#include <QTimer>
 
 #include <scope_guard.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <initializer_list>
 #include <memory>
 #include <ostream>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace mp = multipass;
 namespace mpt = multipass::test;
 using namespace testing;
+using namespace std::literals::chrono_literals;
 
 namespace YAML
 {
@@ -123,6 +137,19 @@ struct MockDaemon : public mp::Daemon
     }
 };
 
+struct UnwatchTrackingDaemon : public mp::Daemon
+{
+    using mp::Daemon::Daemon;
+
+    void unwatch(mp::WatchQueue* updates) override
+    {
+        mp::Daemon::unwatch(updates);
+        unwatched.signal();
+    }
+
+    mpt::Signal unwatched;
+};
+
 struct StubNameGenerator : public mp::NameGenerator
 {
     explicit StubNameGenerator(std::string name) : name{std::move(name)}
@@ -224,6 +251,13 @@ struct Daemon : public Test
 {
     Daemon()
     {
+        reset_config_builder();
+    }
+
+    // Daemons take what their config is built from, so each one after the first needs the stubs afresh
+    void reset_config_builder()
+    {
+        config_builder.image_hosts.clear();
         config_builder.server_address = server_address;
         config_builder.cache_directory = cache_dir.path();
         config_builder.data_directory = data_dir.path();
@@ -267,6 +301,30 @@ struct Daemon : public Test
         return mock_factory_ptr;
     }
 
+    mpt::MockVMImageVault* use_a_mock_vault()
+    {
+        auto mock_vault = std::make_unique<NiceMock<mpt::MockVMImageVault>>();
+        auto mock_vault_ptr = mock_vault.get();
+
+        config_builder.vault = std::move(mock_vault);
+        return mock_vault_ptr;
+    }
+
+    // Runs the event loop, for the daemon's timers to fire, until quit_loop() is called or the timeout expires
+    void run_loop(std::chrono::milliseconds timeout = 5s)
+    {
+        QTimer timeout_timer;
+        timeout_timer.setSingleShot(true);
+        QObject::connect(&timeout_timer, &QTimer::timeout, &loop, &QEventLoop::quit);
+        timeout_timer.start(timeout);
+        loop.exec();
+    }
+
+    void quit_loop()
+    {
+        QMetaObject::invokeMethod(&loop, "quit", Qt::QueuedConnection);
+    }
+
     void send_command(const std::vector<std::string>& command, std::ostream& cout = trash_stream,
                       std::ostream& cerr = trash_stream, std::istream& cin = trash_stream)
     {
@@ -281,25 +339,55 @@ struct Daemon : public Test
         // Commands need to be sent from a thread different from that the QEventLoop is on.
         // Event loop is started/stopped to ensure all signals are delivered
         mp::AutoJoinThread t([this, &commands, &cout, &cerr, &cin] {
-            mpt::StubTerminal term(cout, cerr, cin);
-            mp::ClientConfig client_config{server_address, mp::RpcConnectionType::insecure,
-                                           std::make_unique<mpt::StubCertProvider>(), &term};
-            TestClient client{client_config};
-            for (const auto& command : commands)
-            {
-                QStringList args = QStringList() << "multipass_test";
-
-                for (const auto& arg : command)
-                {
-                    args << QString::fromStdString(arg);
-                }
-                client.run(args);
-            }
+            run_client(commands, cout, cerr, cin);
             loop.quit();
         });
         loop.exec();
     }
 
+    // Runs the commands on the calling thread, which needs to be another one than that of the event loop
+    void run_client(const std::vector<std::vector<std::string>>& commands, std::ostream& cout = trash_stream,
+                    std::ostream& cerr = trash_stream, std::istream& cin = trash_stream)
+    {
+        mpt::StubTerminal term(cout, cerr, cin);
+        mp::ClientConfig client_config{server_address, mp::RpcConnectionType::insecure,
+                                       std::make_unique<mpt::StubCertProvider>(), &term};
+        TestClient client{client_config};
+        for (const auto& command : commands)
+        {
+            QStringList args = QStringList() << "multipass_test";
+
+            for (const auto& arg : command)
+            {
+                args << QString::fromStdString(arg);
+            }
+            client.run(args);
+        }
+    }
+
+    // Asks for the list over gRPC, as the CLI only shows the instances once all replies are in
+    std::vector<mp::ListReply> list_instances(const mp::ListRequest& request)
+    {
+        std::vector<mp::ListReply> replies;
+        {
+            mp::AutoJoinThread client{[this, &request, &replies] {
+                auto stub = mp::Rpc::NewStub(grpc::CreateChannel(server_address, grpc::InsecureChannelCredentials()));
+                grpc::ClientContext context;
+                auto reader = stub->list(&context, request);
+
+                mp::ListReply reply;
+                while (reader->Read(&reply))
+                    replies.push_back(reply);
+                EXPECT_TRUE(reader->Finish().ok());
+                quit_loop();
+            }};
+
+            run_loop();
+        }
+
+        return replies;
+    }
+
     QByteArray fake_img_info(const mp::MemorySize& size)
     {
         return QByteArray::fromStdString(
@@ -851,6 +939,412 @@ TEST_F(Daemon, stop_when_qemuimg_info_doesnt_understand_the_image_size)
     EXPECT_THAT(stream.str(), HasSubstr("Could not obtain image's virtual size"));
 }
 
+TEST_F(Daemon, serves_list_info_and_ssh_info_while_the_main_thread_is_busy)
+{
+    auto mock_factory = use_a_mock_vm_factory();
+    config_builder.name_generator = std::make_unique<StubNameGenerator>("foo");
+
+    // Starting the instance holds the main thread until the other requests are served
+    mpt::Signal starting, served;
+    EXPECT_CALL(*mock_factory, create_virtual_machine(_, _))
+        .WillOnce([&starting, &served](const mp::VirtualMachineDescription& desc, auto&) -> mp::VirtualMachine::UPtr {
+            auto vm = std::make_unique<NiceMock<mpt::MockVirtualMachine>>(desc.vm_name);
+            EXPECT_CALL(*vm, start()).WillOnce([&starting, &served] {
+                starting.signal();
+                EXPECT_TRUE(served.wait_for(5s));
+            });
+            return vm;
+        });
+    mp::Daemon daemon{config_builder.build()};
+
+    const mp::ProcessState qemuimg_exit_status{0, mp::nullopt};
+    const QByteArray qemuimg_output(fake_img_info(mp::MemorySize{"1048576"}));
+    auto mock_factory_scope = inject_fake_qemuimg_callback(qemuimg_exit_status, qemuimg_output);
+
+    send_command({"test_create"});
+
+    std::stringstream list_output, info_output;
+    grpc::Status ssh_info_status;
+    {
+        mp::AutoJoinThread starter{[this] {
+            run_client({{"start", "foo"}});
+            quit_loop();
+        }};
+        mp::AutoJoinThread client{[this, &starting, &served, &list_output, &info_output, &ssh_info_status] {
+            auto served_guard = sg::make_scope_guard([&served]() noexcept { served.signal(); });
+            ASSERT_TRUE(starting.wait_for(5s));
+
+            run_client({{"list"}}, list_output);
+            run_client({{"info", "foo"}}, info_output);
+
+            auto stub = mp::Rpc::NewStub(grpc::CreateChannel(server_address, grpc::InsecureChannelCredentials()));
+            grpc::ClientContext context;
+            mp::SSHInfoRequest request;
+            request.add_instance_name("foo");
+            auto reader = stub->ssh_info(&context, request);
+
+            mp::SSHInfoReply reply;
+            while (reader->Read(&reply))
+                ;
+            ssh_info_status = reader->Finish();
+        }};
+
+        run_loop();
+    }
+
+    // The mock instance is only reported started once the backend says so, which it never does
+    EXPECT_THAT(list_output.str(), HasSubstr("foo"));
+    EXPECT_THAT(info_output.str(), HasSubstr("foo"));
+    EXPECT_EQ(ssh_info_status.error_code(), grpc::StatusCode::ABORTED);
+}
+
+TEST_F(Daemon, launches_many_instances_from_one_request)
+{
+    auto mock_factory = use_a_mock_vm_factory();
+    mp::Daemon daemon{config_builder.build()};
+
+    const mp::ProcessState qemuimg_exit_status{0, mp::nullopt};
+    const QByteArray qemuimg_output(fake_img_info(mp::MemorySize{"1048576"}));
+    auto mock_factory_scope = inject_fake_qemuimg_callback(qemuimg_exit_status, qemuimg_output);
+
+    std::vector<std::string> created;
+    EXPECT_CALL(*mock_factory, create_virtual_machine(_, _))
+        .Times(3)
+        .WillRepeatedly([&created](const mp::VirtualMachineDescription& desc, auto&) {
+            created.push_back(desc.vm_name);
+            return std::make_unique<mpt::StubVirtualMachine>();
+        });
+
+    std::stringstream launch_output;
+    send_command({"launch", "--name", "foo", "--count", "3", "--max-parallel", "2"}, launch_output);
+    EXPECT_THAT(created, UnorderedElementsAre("foo-1", "foo-2", "foo-3"));
+    EXPECT_THAT(launch_output.str(),
+                AllOf(HasSubstr("Launched: foo-1"), HasSubstr("Launched: foo-2"), HasSubstr("Launched: foo-3")));
+
+    std::stringstream list_output;
+    send_command({"list"}, list_output);
+    EXPECT_THAT(list_output.str(), AllOf(HasSubstr("foo-1"), HasSubstr("foo-2"), HasSubstr("foo-3")));
+}
+
+TEST_F(Daemon, releases_instances_of_a_batch_that_fail_to_start)
+{
+    auto mock_factory = use_a_mock_vm_factory();
+    mp::Daemon daemon{config_builder.build()};
+
+    const mp::ProcessState qemuimg_exit_status{0, mp::nullopt};
+    const QByteArray qemuimg_output(fake_img_info(mp::MemorySize{"1048576"}));
+    auto mock_factory_scope = inject_fake_qemuimg_callback(qemuimg_exit_status, qemuimg_output);
+
+    EXPECT_CALL(*mock_factory, create_virtual_machine(_, _))
+        .Times(3)
+        .WillRepeatedly([](const mp::VirtualMachineDescription& desc, auto&) -> mp::VirtualMachine::UPtr {
+            if (desc.vm_name != "foo-2")
+                return std::make_unique<mpt::StubVirtualMachine>();
+
+            auto vm = std::make_unique<NiceMock<mpt::MockVirtualMachine>>(desc.vm_name);
+            EXPECT_CALL(*vm, start()).WillOnce(Throw(std::runtime_error{"cannot boot"}));
+            return vm;
+        });
+    EXPECT_CALL(*mock_factory, remove_resources_for(_)).Times(0);
+    EXPECT_CALL(*mock_factory, remove_resources_for("foo-2"));
+
+    std::stringstream launch_errors;
+    send_command({"launch", "--name", "foo", "--count", "3"}, trash_stream, launch_errors);
+    EXPECT_THAT(launch_errors.str(),
+                AllOf(HasSubstr("Some instances failed to launch"), HasSubstr("foo-2: cannot boot")));
+
+    std::stringstream list_output;
+    send_command({"list"}, list_output);
+    EXPECT_THAT(list_output.str(), AllOf(HasSubstr("foo-1"), Not(HasSubstr("foo-2")), HasSubstr("foo-3")));
+}
+
+namespace
+{
+std::vector<std::string> names_in(const std::vector<mp::ListReply>& replies)
+{
+    std::vector<std::string> names;
+    for (const auto& reply : replies)
+        for (const auto& instance : reply.instances())
+            names.push_back(instance.name());
+
+    return names;
+}
+
+mp::ListRequest list_request_for_states(std::initializer_list<mp::InstanceStatus::Status> states)
+{
+    mp::ListRequest request;
+    for (const auto state : states)
+        request.add_states(state);
+
+    return request;
+}
+} // namespace
+
+TEST_F(Daemon, lists_instances_that_match_the_filters)
+{
+    use_a_mock_vm_factory();
+    auto mock_vault = use_a_mock_vault();
+    mpt::TempFile image_file;
+    ON_CALL(*mock_vault, fetch_image(_, _, _, _))
+        .WillByDefault([&image_file](auto&, const mp::Query& query, auto&, auto&) {
+            const auto is_foo = query.name.compare(0, 3, "foo") == 0;
+
+            mp::VMImage image;
+            image.image_path = image_file.name();
+            image.id = is_foo ? "abcd" : "efgh";
+            image.original_release = is_foo ? "focal" : "bionic";
+            return image;
+        });
+    mp::Daemon daemon{config_builder.build()};
+
+    const mp::ProcessState qemuimg_exit_status{0, mp::nullopt};
+    const QByteArray qemuimg_output(fake_img_info(mp::MemorySize{"1048576"}));
+    auto mock_factory_scope = inject_fake_qemuimg_callback(qemuimg_exit_status, qemuimg_output);
+
+    send_commands({{"launch", "--name", "foo", "--count", "2"}, {"launch", "--name", "bar"}});
+
+    mp::ListRequest by_name;
+    by_name.set_name_prefix("foo");
+    EXPECT_THAT(names_in(list_instances(by_name)), UnorderedElementsAre("foo-1", "foo-2"));
+
+    mp::ListRequest by_image_id;
+    by_image_id.set_image("ef");
+    EXPECT_THAT(names_in(list_instances(by_image_id)), ElementsAre("bar"));
+
+    mp::ListRequest by_release;
+    by_release.set_image("foc");
+    EXPECT_THAT(names_in(list_instances(by_release)), UnorderedElementsAre("foo-1", "foo-2"));
+
+    mp::ListRequest by_name_and_image;
+    by_name_and_image.set_name_prefix("bar");
+    by_name_and_image.set_image("abcd");
+    EXPECT_THAT(names_in(list_instances(by_name_and_image)), IsEmpty());
+
+    // The stub instances stay off
+    EXPECT_THAT(names_in(list_instances(list_request_for_states({mp::InstanceStatus::STOPPED}))),
+                UnorderedElementsAre("foo-1", "foo-2", "bar"));
+    EXPECT_THAT(names_in(list_instances(list_request_for_states({mp::InstanceStatus::RUNNING}))), IsEmpty());
+}
+
+TEST_F(Daemon, pages_list_replies)
+{
+    use_a_mock_vm_factory();
+    mp::Daemon daemon{config_builder.build()};
+
+    const mp::ProcessState qemuimg_exit_status{0, mp::nullopt};
+    const QByteArray qemuimg_output(fake_img_info(mp::MemorySize{"1048576"}));
+    auto mock_factory_scope = inject_fake_qemuimg_callback(qemuimg_exit_status, qemuimg_output);
+
+    send_command({"launch", "--name", "foo", "--count", "3"});
+
+    auto instances_per_reply = [this](unsigned page_size) {
+        mp::ListRequest request;
+        request.set_page_size(page_size);
+
+        std::vector<int> sizes;
+        for (const auto& reply : list_instances(request))
+            sizes.push_back(reply.instances_size());
+
+        return sizes;
+    };
+
+    EXPECT_THAT(instances_per_reply(0), ElementsAre(3));
+    EXPECT_THAT(instances_per_reply(2), ElementsAre(2, 1));
+    EXPECT_THAT(instances_per_reply(3), ElementsAre(3));
+    EXPECT_THAT(instances_per_reply(5), ElementsAre(3));
+
+    mp::ListRequest none_matching;
+    none_matching.set_name_prefix("bar");
+    none_matching.set_page_size(2);
+    const auto replies = list_instances(none_matching);
+    ASSERT_EQ(replies.size(), 1u);
+    EXPECT_EQ(replies[0].instances_size(), 0);
+}
+
+TEST_F(Daemon, serves_instances_being_restored)
+{
+    use_a_mock_vm_factory();
+    const mp::ProcessState qemuimg_exit_status{0, mp::nullopt};
+    const QByteArray qemuimg_output(fake_img_info(mp::MemorySize{"1048576"}));
+    auto mock_factory_scope = inject_fake_qemuimg_callback(qemuimg_exit_status, qemuimg_output);
+
+    {
+        mp::Daemon daemon{config_builder.build()};
+        send_commands({{"launch", "--name", "foo", "--count", "3"}, {"delete", "foo-1", "foo-2"}});
+    }
+
+    // The next daemon restores its instances one at a time while it serves requests, which need to wait for them
+    reset_config_builder();
+    use_a_mock_vm_factory();
+    mp::Daemon daemon{config_builder.build()};
+
+    grpc::Status ssh_info_status;
+    std::stringstream info_output, errors;
+    {
+        mp::AutoJoinThread client{[this, &ssh_info_status, &info_output, &errors] {
+            auto stub = mp::Rpc::NewStub(grpc::CreateChannel(server_address, grpc::InsecureChannelCredentials()));
+            grpc::ClientContext context;
+            mp::SSHInfoRequest request;
+            request.add_instance_name("foo-3");
+            auto reader = stub->ssh_info(&context, request);
+
+            mp::SSHInfoReply reply;
+            while (reader->Read(&reply))
+                ;
+            ssh_info_status = reader->Finish();
+
+            run_client({{"recover", "foo-1"}, {"purge"}, {"info", "--all"}}, info_output, errors);
+            quit_loop();
+        }};
+
+        run_loop();
+    }
+
+    // The stub instances stay off
+    EXPECT_EQ(ssh_info_status.error_code(), grpc::StatusCode::ABORTED);
+    EXPECT_EQ(errors.str(), "");
+    EXPECT_THAT(info_output.str(), AllOf(HasSubstr("foo-1"), Not(HasSubstr("foo-2")), HasSubstr("foo-3")));
+}
+
+TEST_F(Daemon, watchers_get_snapshot_and_updates_until_they_disconnect)
+{
+    use_a_mock_vm_factory();
+    config_builder.name_generator = std::make_unique<StubNameGenerator>("watched");
+    UnwatchTrackingDaemon daemon{config_builder.build()};
+
+    const mp::ProcessState qemuimg_exit_status{0, mp::nullopt};
+    const QByteArray qemuimg_output(fake_img_info(mp::MemorySize{"1048576"}));
+    auto mock_factory_scope = inject_fake_qemuimg_callback(qemuimg_exit_status, qemuimg_output);
+
+    std::vector<mp::WatchReply> replies;
+    grpc::ClientContext context;
+    {
+        mpt::Signal got_snapshot;
+        mp::AutoJoinThread watcher{[this, &replies, &context, &got_snapshot] {
+            auto stub = mp::Rpc::NewStub(grpc::CreateChannel(server_address, grpc::InsecureChannelCredentials()));
+            auto reader = stub->watch(&context, mp::WatchRequest{});
+
+            mp::WatchReply reply;
+            while (reader->Read(&reply))
+            {
+                replies.push_back(reply);
+                if (reply.snapshot())
+                    got_snapshot.signal();
+                else
+                    context.TryCancel(); // goes away once it sees an update
+            }
+            reader->Finish();
+        }};
+
+        EXPECT_TRUE(got_snapshot.wait_for(5s));
+        send_command({"test_create"});
+
+        EXPECT_TRUE(daemon.unwatched.wait_for(5s));
+        context.TryCancel(); // in case it is still waiting
+    }
+
+    ASSERT_GE(replies.size(), 2u);
+    EXPECT_TRUE(replies[0].snapshot());
+    EXPECT_EQ(replies[0].instances_size(), 0);
+    ASSERT_EQ(replies[1].instances_size(), 1);
+    EXPECT_EQ(replies[1].instances(0).name(), "watched");
+}
+
+TEST_F(Daemon, reports_image_cache_usage)
+{
+    auto mock_vault = use_a_mock_vault();
+    const auto last_accessed = std::chrono::system_clock::time_point{std::chrono::seconds{1600000000}};
+    mp::VMImageVault::CacheUsage usage{3072, 4096, {{"abcd", "focal", "release", 2048, last_accessed, false, true},
+                                                    {"efgh", "bionic", "", 1024, last_accessed, true, false}}};
+    EXPECT_CALL(*mock_vault, cache_usage()).WillOnce(Return(usage));
+
+    mp::Daemon daemon{config_builder.build()};
+
+    std::vector<mp::ImageCacheReply> replies;
+    grpc::Status status;
+    {
+        mp::AutoJoinThread client{[this, &replies, &status] {
+            auto stub = mp::Rpc::NewStub(grpc::CreateChannel(server_address, grpc::InsecureChannelCredentials()));
+            grpc::ClientContext context;
+            auto reader = stub->image_cache(&context, mp::ImageCacheRequest{});
+
+            mp::ImageCacheReply reply;
+            while (reader->Read(&reply))
+                replies.push_back(reply);
+            status = reader->Finish();
+            quit_loop();
+        }};
+
+        run_loop();
+    }
+
+    EXPECT_TRUE(status.ok());
+    ASSERT_EQ(replies.size(), 1u);
+    EXPECT_EQ(replies[0].total_size(), 3072);
+    EXPECT_EQ(replies[0].budget(), 4096);
+    ASSERT_EQ(replies[0].images_size(), 2);
+    EXPECT_EQ(replies[0].images(0).id(), "abcd");
+    EXPECT_EQ(replies[0].images(0).release(), "focal");
+    EXPECT_EQ(replies[0].images(0).remote_name(), "release");
+    EXPECT_EQ(replies[0].images(0).size(), 2048);
+    EXPECT_EQ(replies[0].images(0).last_accessed(), 1600000000);
+    EXPECT_FALSE(replies[0].images(0).persistent());
+    EXPECT_TRUE(replies[0].images(0).in_use());
+    EXPECT_EQ(replies[0].images(1).id(), "efgh");
+    EXPECT_TRUE(replies[0].images(1).persistent());
+    EXPECT_FALSE(replies[0].images(1).in_use());
+}
+
+TEST_F(Daemon, prefetches_warm_images)
+{
+    auto mock_vault = use_a_mock_vault();
+    config_builder.image_prefetch_interval = 10ms;
+
+    auto& mock_settings = mpt::MockSettings::mock_instance();
+    EXPECT_CALL(mock_settings, get(_)).Times(AnyNumber());
+    EXPECT_CALL(mock_settings, get(Eq(QString{mp::warm_images_key}))).WillRepeatedly(Return("daily:focal,bionic"));
+
+    EXPECT_CALL(*mock_vault, prefetch_image(_, AllOf(Field(&mp::Query::release, "focal"),
+                                                     Field(&mp::Query::remote_name, "daily")),
+                                            _, _, _))
+        .Times(AtLeast(1));
+    EXPECT_CALL(*mock_vault,
+                prefetch_image(_, AllOf(Field(&mp::Query::release, "bionic"), Field(&mp::Query::remote_name, "")),
+                               _, _, _))
+        .Times(AtLeast(1))
+        .WillRepeatedly(InvokeWithoutArgs([this] { quit_loop(); }));
+
+    mp::Daemon daemon{config_builder.build()};
+    run_loop();
+}
+
+TEST_F(Daemon, cuts_prefetching_short_on_destruction)
+{
+    auto mock_vault = use_a_mock_vault();
+    config_builder.image_prefetch_interval = 10ms;
+
+    auto& mock_settings = mpt::MockSettings::mock_instance();
+    EXPECT_CALL(mock_settings, get(_)).Times(AnyNumber());
+    EXPECT_CALL(mock_settings, get(Eq(QString{mp::warm_images_key}))).WillRepeatedly(Return("focal"));
+
+    std::atomic_bool aborted{false};
+    EXPECT_CALL(*mock_vault, prefetch_image(_, _, _, _, _))
+        .WillOnce([this, &aborted](auto&&, auto&&, auto&&, const mp::ProgressMonitor& monitor, auto&&) {
+            quit_loop();
+            while (monitor(mp::LaunchProgress::IMAGE, 0))
+                std::this_thread::sleep_for(1ms);
+
+            aborted = true;
+        });
+
+    {
+        mp::Daemon daemon{config_builder.build()};
+        run_loop();
+    }
+
+    EXPECT_TRUE(aborted);
+}
+
 INSTANTIATE_TEST_SUITE_P(Daemon, DaemonCreateLaunchTestSuite, Values("launch", "test_create"));
 INSTANTIATE_TEST_SUITE_P(Daemon, MinSpaceRespectedSuite,
                          Combine(Values("test_create", "launch"), Values("--mem", "--disk"),
@@ -68,6 +68,15 @@ TEST(InstanceStatusString, SUSPENDED_status_returns_Suspended)
     EXPECT_THAT(status_string, Eq("Suspended"));
 }
 
+TEST(InstanceStatusString, RESTORING_status_returns_Restoring)
+{
+    mp::InstanceStatus status;
+    status.set_status(mp::InstanceStatus::RESTORING);
+    auto status_string = mp::format::status_string_for(status);
+
+    EXPECT_THAT(status_string, Eq("Restoring"));
+}
+
 TEST(InstanceStatusString, RESTARTING_status_returns_Restarting)
 {
     mp::InstanceStatus status;
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "mock_ssh.h"
+#include "sftp_server_test_fixture.h"
+#include "stub_ssh_key_provider.h"
+
+#include <src/daemon/guest_telemetry_collector.h>
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace mp = multipass;
+using namespace testing;
+
+namespace
+{
+auto channel_read_returning(const std::string& output)
+{
+    auto remaining = std::make_shared<std::string>(output);
+    return [remaining](ssh_channel, void* dest, uint32_t count, int is_stderr, int) {
+        if (is_stderr)
+            return 0;
+
+        const auto num_to_copy = std::min(static_cast<std::string::size_type>(count), remaining->size());
+        std::copy_n(remaining->begin(), num_to_copy, reinterpret_cast<char*>(dest));
+        remaining->erase(0, num_to_copy);
+        return static_cast<int>(num_to_copy);
+    };
+}
+
+struct GuestTelemetryCollector : public Test
+{
+    GuestTelemetryCollector()
+    {
+        connect.returnValue(SSH_OK);
+        is_connected.returnValue(true);
+        userauth.returnValue(SSH_AUTH_SUCCESS);
+        open_session.returnValue(SSH_OK);
+        request_exec.returnValue(SSH_OK);
+        channel_is_closed.returnValue(0);
+        channel_read.returnValue(0);
+    }
+
+    decltype(MOCK(ssh_connect)) connect{MOCK(ssh_connect)};
+    decltype(MOCK(ssh_is_connected)) is_connected{MOCK(ssh_is_connected)};
+    decltype(MOCK(ssh_userauth_publickey)) userauth{MOCK(ssh_userauth_publickey)};
+    decltype(MOCK(ssh_channel_open_session)) open_session{MOCK(ssh_channel_open_session)};
+    decltype(MOCK(ssh_channel_request_exec)) request_exec{MOCK(ssh_channel_request_exec)};
+    decltype(MOCK(ssh_channel_is_closed)) channel_is_closed{MOCK(ssh_channel_is_closed)};
+    decltype(MOCK(ssh_channel_read_timeout)) channel_read{MOCK(ssh_channel_read_timeout)};
+    mp::test::ExitStatusMock exit_status;
+    mp::test::StubSSHKeyProvider key_provider;
+    mp::SSHSessionPool session_pool{key_provider};
+    mp::GuestTelemetryCollector collector{session_pool};
+};
+} // namespace
+
+TEST_F(GuestTelemetryCollector, gathers_all_values_from_one_command)
+{
+    REPLACE(ssh_channel_read_timeout,
+            channel_read_returning("load=0.01 0.02 0.03\nmemory_usage=123\nmemory_total=456\ndisk_usage=789\n"
+                                   "disk_total=1011\nrelease=Ubuntu 18.04.4 LTS\n"));
+
+    auto telemetry = collector.refresh("foo", "host", 42, "ubuntu");
+
+    EXPECT_EQ(telemetry.load, "0.01 0.02 0.03");
+    EXPECT_EQ(telemetry.memory_usage, "123");
+    EXPECT_EQ(telemetry.memory_total, "456");
+    EXPECT_EQ(telemetry.disk_usage, "789");
+    EXPECT_EQ(telemetry.disk_total, "1011");
+    EXPECT_EQ(telemetry.current_release, "Ubuntu 18.04.4 LTS");
+}
+
+TEST_F(GuestTelemetryCollector, leaves_missing_values_empty)
+{
+    REPLACE(ssh_channel_read_timeout, channel_read_returning("load=0.01 0.02 0.03\nrelease=\n"));
+
+    auto telemetry = collector.refresh("foo", "host", 42, "ubuntu");
+
+    EXPECT_EQ(telemetry.load, "0.01 0.02 0.03");
+    EXPECT_TRUE(telemetry.memory_usage.empty());
+    EXPECT_TRUE(telemetry.current_release.empty());
+}
+
+TEST_F(GuestTelemetryCollector, caches_last_result)
+{
+    EXPECT_FALSE(collector.cached("foo"));
+
+    REPLACE(ssh_channel_read_timeout, channel_read_returning("load=1.00 2.00 3.00\n"));
+    collector.refresh("foo", "host", 42, "ubuntu");
+
+    auto telemetry = collector.cached("foo");
+    ASSERT_TRUE(telemetry);
+    EXPECT_EQ(telemetry->load, "1.00 2.00 3.00");
+    EXPECT_FALSE(collector.cached("bar"));
+}
+
+TEST_F(GuestTelemetryCollector, forgets_cached_result)
+{
+    REPLACE(ssh_channel_read_timeout, channel_read_returning("load=1.00 2.00 3.00\n"));
+    collector.refresh("foo", "host", 42, "ubuntu");
+
+    collector.forget("foo");
+
+    EXPECT_FALSE(collector.cached("foo"));
+}
+
+TEST_F(GuestTelemetryCollector, reconnects_when_kept_session_fails)
+{
+    int connections{0};
+    REPLACE(ssh_connect, [&connections](auto...) {
+        ++connections;
+        return SSH_OK;
+    });
+    collector.refresh("foo", "host", 42, "ubuntu");
+
+    int execs{0};
+    REPLACE(ssh_channel_request_exec, [&execs](auto...) { return ++execs == 1 ? SSH_ERROR : SSH_OK; });
+    REPLACE(ssh_channel_read_timeout, channel_read_returning("load=1.00 2.00 3.00\n"));
+
+    EXPECT_EQ(collector.refresh("foo", "host", 42, "ubuntu").load, "1.00 2.00 3.00");
+    EXPECT_EQ(connections, 2);
+}
+
+TEST_F(GuestTelemetryCollector, throws_when_unable_to_connect)
+{
+    REPLACE(ssh_connect, [](auto...) { return SSH_ERROR; });
+
+    EXPECT_THROW(collector.refresh("foo", "host", 42, "ubuntu"), std::runtime_error);
+    EXPECT_FALSE(collector.cached("foo"));
+}
+
+TEST_F(GuestTelemetryCollector, gives_up_on_unresponsive_instance)
+{
+    REPLACE(ssh_event_dopoll, [](ssh_event, int timeout) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout + 1));
+        return SSH_OK;
+    });
+
+    EXPECT_THROW(collector.refresh("foo", "host", 42, "ubuntu", std::chrono::milliseconds(1)), std::runtime_error);
+    EXPECT_FALSE(collector.cached("foo"));
+}
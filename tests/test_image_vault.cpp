@@ -26,15 +26,24 @@
 #include <multipass/exceptions/aborted_download_exception.h>
 #include <multipass/exceptions/create_image_exception.h>
 #include <multipass/query.h>
+#include <multipass/rpc/multipass.grpc.pb.h>
 #include <multipass/url_downloader.h>
 #include <multipass/utils.h>
 
+#include <QCryptographicHash>
 #include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
 #include <QThread>
 #include <QUrl>
 
 #include <gmock/gmock.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+
 namespace mp = multipass;
 namespace mpt = multipass::test;
 
@@ -50,9 +59,11 @@ struct TrackingURLDownloader : public mp::URLDownloader
     {
     }
     void download_to(const QUrl& url, const QString& file_name, int64_t size, const int download_type,
-                     const mp::ProgressMonitor&) override
+                     const mp::ProgressMonitor&, QCryptographicHash* digest) override
     {
         mpt::make_file_with_content(file_name, "");
+
+        std::lock_guard<decltype(mutex)> lock{mutex}; // the kernel and initrd download at the same time
         downloaded_urls << url.toString();
         downloaded_files << file_name;
     }
@@ -67,6 +78,7 @@ struct TrackingURLDownloader : public mp::URLDownloader
         return QDateTime::currentDateTime();
     }
 
+    std::mutex mutex;
     QStringList downloaded_files;
     QStringList downloaded_urls;
 };
@@ -77,9 +89,29 @@ struct BadURLDownloader : public mp::URLDownloader
     {
     }
     void download_to(const QUrl& url, const QString& file_name, int64_t size, const int download_type,
-                     const mp::ProgressMonitor&) override
+                     const mp::ProgressMonitor&, QCryptographicHash* digest) override
+    {
+        const std::string content{"Bad hash"};
+        mpt::make_file_with_content(file_name, content);
+        if (digest)
+            digest->addData(content.data(), content.size());
+    }
+
+    QByteArray download(const QUrl& url) override
+    {
+        return {};
+    }
+};
+
+struct StreamingURLDownloader : public mp::URLDownloader
+{
+    StreamingURLDownloader() : mp::URLDownloader{std::chrono::seconds(10)}
+    {
+    }
+    void download_to(const QUrl& url, const QString& file_name, int64_t size, const int download_type,
+                     const mp::ProgressMonitor&, QCryptographicHash* digest) override
     {
-        mpt::make_file_with_content(file_name, "Bad hash");
+        mpt::make_file_with_content(file_name, "Not hashed");
     }
 
     QByteArray download(const QUrl& url) override
@@ -88,13 +120,44 @@ struct BadURLDownloader : public mp::URLDownloader
     }
 };
 
+// Holds each download until the given number of them run at the same time, or a while has passed
+struct ConcurrentURLDownloader : public mp::URLDownloader
+{
+    ConcurrentURLDownloader(int expected_concurrent)
+        : mp::URLDownloader{std::chrono::seconds(10)}, expected_concurrent{expected_concurrent}
+    {
+    }
+    void download_to(const QUrl& url, const QString& file_name, int64_t size, const int download_type,
+                     const mp::ProgressMonitor&, QCryptographicHash* digest) override
+    {
+        mpt::make_file_with_content(file_name, "");
+
+        std::unique_lock<decltype(mutex)> lock{mutex};
+        max_concurrent = std::max(max_concurrent, ++concurrent);
+        cv.notify_all();
+        cv.wait_for(lock, std::chrono::seconds(5), [this] { return max_concurrent >= expected_concurrent; });
+        --concurrent;
+    }
+
+    QByteArray download(const QUrl& url) override
+    {
+        return {};
+    }
+
+    const int expected_concurrent;
+    std::mutex mutex;
+    std::condition_variable cv;
+    int concurrent{0};
+    int max_concurrent{0};
+};
+
 struct HttpURLDownloader : public mp::URLDownloader
 {
     HttpURLDownloader() : mp::URLDownloader{std::chrono::seconds(10)}
     {
     }
     void download_to(const QUrl& url, const QString& file_name, int64_t size, const int download_type,
-                     const mp::ProgressMonitor&) override
+                     const mp::ProgressMonitor&, QCryptographicHash* digest) override
     {
         mpt::make_file_with_content(file_name, "");
         downloaded_urls << url.toString();
@@ -115,13 +178,89 @@ struct HttpURLDownloader : public mp::URLDownloader
     QStringList downloaded_urls;
 };
 
+// Writes about a kilobyte that is different for every URL
+struct ContentURLDownloader : public mp::URLDownloader
+{
+    ContentURLDownloader() : mp::URLDownloader{std::chrono::seconds(10)}
+    {
+    }
+    void download_to(const QUrl& url, const QString& file_name, int64_t size, const int download_type,
+                     const mp::ProgressMonitor&, QCryptographicHash* digest) override
+    {
+        const auto content = url.toString().repeated(1024 / url.toString().size() + 1).toStdString();
+        mpt::make_file_with_content(file_name, content);
+        if (digest)
+            digest->addData(content.data(), content.size());
+    }
+
+    QByteArray download(const QUrl& url) override
+    {
+        return {};
+    }
+};
+
+// Reports the image as done in one go, and times how long that takes to get through
+struct ReportingURLDownloader : public mp::URLDownloader
+{
+    ReportingURLDownloader() : mp::URLDownloader{std::chrono::seconds(10)}
+    {
+    }
+    void download_to(const QUrl& url, const QString& file_name, int64_t size, const int download_type,
+                     const mp::ProgressMonitor& monitor, QCryptographicHash* digest) override
+    {
+        mpt::make_file_with_content(file_name, "");
+
+        const auto start = std::chrono::steady_clock::now();
+        monitor(download_type, 100);
+        report_time = std::chrono::steady_clock::now() - start;
+    }
+
+    QByteArray download(const QUrl& url) override
+    {
+        return {};
+    }
+
+    std::chrono::steady_clock::duration report_time{0};
+};
+
+// Reports each download as half done and then done, with the server giving kernel_size and initrd_size for those
+struct ProgressURLDownloader : public mp::URLDownloader
+{
+    ProgressURLDownloader(const QString& kernel_url, const QString& initrd_url)
+        : mp::URLDownloader{std::chrono::seconds(10)}, kernel_url{kernel_url}, initrd_url{initrd_url}
+    {
+    }
+    void download_to(const QUrl& url, const QString& file_name, int64_t size, const int download_type,
+                     const mp::ProgressMonitor& monitor, QCryptographicHash* digest) override
+    {
+        mpt::make_file_with_content(file_name, "");
+        monitor(download_type, 50);
+        monitor(download_type, 100);
+    }
+
+    QByteArray download(const QUrl& url) override
+    {
+        return {};
+    }
+
+    int64_t content_length(const QUrl& url) override
+    {
+        return url.toString() == kernel_url ? kernel_size : url.toString() == initrd_url ? initrd_size : -1;
+    }
+
+    const QString kernel_url;
+    const QString initrd_url;
+    const int64_t kernel_size{300};
+    const int64_t initrd_size{700};
+};
+
 struct RunningURLDownloader : public mp::URLDownloader
 {
     RunningURLDownloader() : mp::URLDownloader{std::chrono::seconds(10)}
     {
     }
     void download_to(const QUrl& url, const QString& file_name, int64_t size, const int download_type,
-                     const mp::ProgressMonitor&) override
+                     const mp::ProgressMonitor&, QCryptographicHash* digest) override
     {
         while (!abort_download)
             QThread::yieldCurrentThread();
@@ -142,6 +281,14 @@ struct ImageVault : public testing::Test
         hosts.push_back(&host);
     }
 
+    mp::DefaultVMImageVault::CreateOverlay make_overlay_to(std::vector<std::pair<QString, QString>>& overlays)
+    {
+        return [&overlays](const mp::Path& backing_image_path, const mp::Path& overlay_path) {
+            mpt::make_file_with_content(overlay_path);
+            overlays.emplace_back(backing_image_path, overlay_path);
+        };
+    }
+
     QString host_url{QUrl::fromLocalFile(mpt::test_data_path()).toString()};
     TrackingURLDownloader url_downloader;
     std::vector<mp::VMImageHost*> hosts;
@@ -165,6 +312,36 @@ TEST_F(ImageVault, downloads_image)
     EXPECT_TRUE(url_downloader.downloaded_urls.contains(host.image.url()));
 }
 
+TEST_F(ImageVault, decodes_compressed_image_as_it_downloads)
+{
+    mp::URLDownloader file_url_downloader{std::chrono::seconds(10)};
+    host.mock_image_info.image_location = QUrl::fromLocalFile(mpt::test_data_path_for("image.img.xz")).toString();
+    host.mock_image_info.verify = false;
+
+    mp::DefaultVMImageVault vault{hosts, &file_url_downloader, cache_dir.path(), data_dir.path(), mp::days{0}};
+    auto vm_image = vault.fetch_image(mp::FetchType::ImageOnly, default_query, stub_prepare, stub_monitor);
+
+    EXPECT_TRUE(vm_image.image_path.endsWith("image.img"));
+    EXPECT_EQ(QFileInfo(vm_image.image_path).size(), 200000);
+
+    QDirIterator it{cache_dir.path(), QDir::Files, QDirIterator::Subdirectories};
+    while (it.hasNext())
+        EXPECT_FALSE(it.next().endsWith(".xz"));
+}
+
+TEST_F(ImageVault, fetches_image_even_when_records_cannot_be_saved)
+{
+    // Directories in the way of the records make writing them fail
+    QDir{cache_dir.path()}.mkpath("multipassd-image-records.json");
+    QDir{data_dir.path()}.mkpath("multipassd-instance-image-records.json");
+
+    mp::DefaultVMImageVault vault{hosts, &url_downloader, cache_dir.path(), data_dir.path(), mp::days{0}};
+    mp::VMImage vm_image;
+    EXPECT_NO_THROW(vm_image = vault.fetch_image(mp::FetchType::ImageOnly, default_query, stub_prepare, stub_monitor));
+
+    EXPECT_TRUE(vm_image.image_path.contains(QString::fromStdString(instance_name)));
+}
+
 TEST_F(ImageVault, returned_image_contains_instance_name)
 {
     mp::DefaultVMImageVault vault{hosts, &url_downloader, cache_dir.path(), data_dir.path(), mp::days{0}};
@@ -187,6 +364,45 @@ TEST_F(ImageVault, downloads_kernel_and_initrd)
     EXPECT_FALSE(vm_image.initrd_path.isEmpty());
 }
 
+TEST_F(ImageVault, downloads_kernel_and_initrd_alongside_image)
+{
+    ConcurrentURLDownloader concurrent_url_downloader{3};
+    mp::DefaultVMImageVault vault{hosts, &concurrent_url_downloader, cache_dir.path(), data_dir.path(), mp::days{0}};
+    vault.fetch_image(mp::FetchType::ImageKernelAndInitrd, default_query, stub_prepare, stub_monitor);
+
+    EXPECT_THAT(concurrent_url_downloader.max_concurrent, Eq(3));
+}
+
+TEST_F(ImageVault, reports_image_kernel_and_initrd_as_one_progress)
+{
+    host.mock_image_info.size = 1000;
+    ProgressURLDownloader progress_url_downloader{host.kernel.url(), host.initrd.url()};
+
+    std::vector<std::pair<int, int>> reports;
+    std::mutex reports_mutex;
+    auto monitor = [&reports, &reports_mutex](int download_type, int progress) {
+        std::lock_guard<decltype(reports_mutex)> lock{reports_mutex};
+        reports.emplace_back(download_type, progress);
+        return true;
+    };
+
+    mp::DefaultVMImageVault vault{hosts, &progress_url_downloader, cache_dir.path(), data_dir.path(), mp::days{0}};
+    vault.fetch_image(mp::FetchType::ImageKernelAndInitrd, default_query, stub_prepare, monitor);
+
+    std::vector<int> image_progress;
+    for (const auto& report : reports)
+    {
+        EXPECT_NE(report.first, mp::LaunchProgress::KERNEL);
+        EXPECT_NE(report.first, mp::LaunchProgress::INITRD);
+        if (report.first == mp::LaunchProgress::IMAGE)
+            image_progress.push_back(report.second);
+    }
+
+    ASSERT_THAT(image_progress.size(), Eq(6u));
+    EXPECT_TRUE(std::is_sorted(image_progress.cbegin(), image_progress.cend()));
+    EXPECT_EQ(image_progress.back(), 100);
+}
+
 TEST_F(ImageVault, calls_prepare)
 {
     mp::DefaultVMImageVault vault{hosts, &url_downloader, cache_dir.path(), data_dir.path(), mp::days{0}};
@@ -398,6 +614,21 @@ TEST_F(ImageVault, hash_mismatch_throws)
                  mp::CreateImageException);
 }
 
+TEST_F(ImageVault, verifies_image_with_hash_gathered_while_downloading)
+{
+    // Writes something other than what it hashes, which only verifying from the file would notice
+    StreamingURLDownloader streaming_url_downloader;
+    bool verify_reported{false};
+    mp::ProgressMonitor monitor{[&verify_reported](int type, int) {
+        verify_reported = verify_reported || type == mp::LaunchProgress::VERIFY;
+        return true;
+    }};
+    mp::DefaultVMImageVault vault{hosts, &streaming_url_downloader, cache_dir.path(), data_dir.path(), mp::days{0}};
+
+    EXPECT_NO_THROW(vault.fetch_image(mp::FetchType::ImageOnly, default_query, stub_prepare, monitor));
+    EXPECT_FALSE(verify_reported);
+}
+
 TEST_F(ImageVault, invalid_remote_throws)
 {
     mpt::StubURLDownloader stub_url_downloader;
@@ -460,19 +691,19 @@ TEST_F(ImageVault, image_update_creates_new_dir_and_removes_old)
     auto original_file{url_downloader.downloaded_files[0]};
     auto original_absolute_path{QFileInfo(original_file).absolutePath()};
     EXPECT_TRUE(QFileInfo::exists(original_file));
-    EXPECT_TRUE(original_absolute_path.contains(mpt::default_version));
+    EXPECT_TRUE(original_absolute_path.endsWith(mpt::default_id));
 
     // Mock an update to the image and don't verify because of hash mismatch
-    const QString new_date_string{"20180825"};
-    host.mock_image_info.id = "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b856";
-    host.mock_image_info.version = new_date_string;
+    const QString new_id{"e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b856"};
+    host.mock_image_info.id = new_id;
+    host.mock_image_info.version = "20180825";
     host.mock_image_info.verify = false;
 
     vault.update_images(mp::FetchType::ImageOnly, stub_prepare, stub_monitor);
 
     auto updated_file{url_downloader.downloaded_files[1]};
     EXPECT_TRUE(QFileInfo::exists(updated_file));
-    EXPECT_TRUE(QFileInfo(updated_file).absolutePath().contains(new_date_string));
+    EXPECT_TRUE(QFileInfo(updated_file).absolutePath().endsWith(new_id));
 
     // Old image and directory should be removed
     EXPECT_FALSE(QFileInfo::exists(original_file));
@@ -489,3 +720,200 @@ TEST_F(ImageVault, aborted_download_throws)
     EXPECT_THROW(vault.fetch_image(mp::FetchType::ImageOnly, default_query, stub_prepare, stub_monitor),
                  mp::AbortedDownloadException);
 }
+
+TEST_F(ImageVault, creates_overlay_instead_of_copying_prepared_image)
+{
+    std::vector<std::pair<QString, QString>> overlays;
+    mp::DefaultVMImageVault vault{
+        hosts, &url_downloader, cache_dir.path(), data_dir.path(), mp::days{0}, make_overlay_to(overlays)};
+    auto vm_image = vault.fetch_image(mp::FetchType::ImageOnly, default_query, stub_prepare, stub_monitor);
+
+    const auto prepared_image = url_downloader.downloaded_files[0];
+    ASSERT_THAT(overlays.size(), Eq(1u));
+    EXPECT_THAT(overlays[0].first, Eq(prepared_image));
+    EXPECT_THAT(overlays[0].second, Eq(vm_image.image_path));
+    EXPECT_THAT(vm_image.backing_image_path, Eq(prepared_image));
+    EXPECT_TRUE(vm_image.image_path.contains(QString::fromStdString(instance_name)));
+}
+
+TEST_F(ImageVault, expired_image_is_kept_while_instances_are_based_on_it)
+{
+    std::vector<std::pair<QString, QString>> overlays;
+    mp::DefaultVMImageVault vault{
+        hosts, &url_downloader, cache_dir.path(), data_dir.path(), mp::days{0}, make_overlay_to(overlays)};
+    vault.fetch_image(mp::FetchType::ImageOnly, default_query, stub_prepare, stub_monitor);
+    const auto prepared_image = url_downloader.downloaded_files[0];
+
+    vault.prune_expired_images();
+    EXPECT_TRUE(QFileInfo::exists(prepared_image));
+
+    vault.remove(instance_name);
+    vault.prune_expired_images();
+    EXPECT_FALSE(QFileInfo::exists(prepared_image));
+}
+
+TEST_F(ImageVault, remembers_instances_based_on_images)
+{
+    std::vector<std::pair<QString, QString>> overlays;
+    {
+        mp::DefaultVMImageVault first_vault{
+            hosts, &url_downloader, cache_dir.path(), data_dir.path(), mp::days{0}, make_overlay_to(overlays)};
+        first_vault.fetch_image(mp::FetchType::ImageOnly, default_query, stub_prepare, stub_monitor);
+    }
+
+    mp::DefaultVMImageVault another_vault{
+        hosts, &url_downloader, cache_dir.path(), data_dir.path(), mp::days{0}, make_overlay_to(overlays)};
+    another_vault.prune_expired_images();
+
+    EXPECT_TRUE(QFileInfo::exists(url_downloader.downloaded_files[0]));
+}
+
+TEST_F(ImageVault, image_update_keeps_old_image_while_instances_are_based_on_it)
+{
+    std::vector<std::pair<QString, QString>> overlays;
+    mp::DefaultVMImageVault vault{
+        hosts, &url_downloader, cache_dir.path(), data_dir.path(), mp::days{1}, make_overlay_to(overlays)};
+    vault.fetch_image(mp::FetchType::ImageOnly, default_query, stub_prepare, stub_monitor);
+    auto original_file{url_downloader.downloaded_files[0]};
+
+    host.mock_image_info.id = "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b856";
+    host.mock_image_info.version = "20180825";
+    host.mock_image_info.verify = false;
+
+    vault.update_images(mp::FetchType::ImageOnly, stub_prepare, stub_monitor);
+    vault.prune_expired_images();
+    EXPECT_TRUE(QFileInfo::exists(original_file));
+
+    vault.remove(instance_name);
+    vault.prune_expired_images();
+    EXPECT_FALSE(QFileInfo::exists(original_file));
+}
+
+TEST_F(ImageVault, keeps_images_under_their_hash)
+{
+    mp::DefaultVMImageVault vault{hosts, &url_downloader, cache_dir.path(), data_dir.path(), mp::days{0}};
+    vault.fetch_image(mp::FetchType::ImageOnly, default_query, stub_prepare, stub_monitor);
+
+    EXPECT_THAT(QFileInfo(url_downloader.downloaded_files[0]).absoluteDir().dirName(), Eq(mpt::default_id));
+}
+
+TEST_F(ImageVault, reuses_image_reached_through_another_remote)
+{
+    mp::DefaultVMImageVault vault{hosts, &url_downloader, cache_dir.path(), data_dir.path(), mp::days{0}};
+    auto query = default_query;
+    query.remote_name = "release";
+    vault.fetch_image(mp::FetchType::ImageOnly, query, stub_prepare, stub_monitor);
+
+    auto another_query = default_query;
+    another_query.name = "valley-pied-piper-chat";
+    auto vm_image = vault.fetch_image(mp::FetchType::ImageOnly, another_query, stub_prepare, stub_monitor);
+
+    EXPECT_THAT(url_downloader.downloaded_files.size(), Eq(1));
+    EXPECT_THAT(vm_image.id, Eq(mpt::default_id));
+}
+
+TEST_F(ImageVault, keeps_one_copy_of_urls_with_the_same_contents)
+{
+    HttpURLDownloader http_url_downloader;
+    mp::DefaultVMImageVault vault{hosts, &http_url_downloader, cache_dir.path(), data_dir.path(), mp::days{0}};
+
+    mp::Query query{instance_name, "http://www.foo.com/images/foo.img", false, "", mp::Query::Type::HttpDownload};
+    vault.fetch_image(mp::FetchType::ImageOnly, query, stub_prepare, stub_monitor);
+
+    mp::Query mirror_query{"valley-pied-piper-chat", "http://mirror.foo.com/foo.img", false, "",
+                           mp::Query::Type::HttpDownload};
+    vault.fetch_image(mp::FetchType::ImageOnly, mirror_query, stub_prepare, stub_monitor);
+
+    const auto image_dirs =
+        QDir{QDir{cache_dir.path()}.filePath("vault/images")}.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    EXPECT_THAT(image_dirs.size(), Eq(1));
+
+    EXPECT_THAT(vault.cache_usage().images.size(), Eq(2u));
+}
+
+TEST_F(ImageVault, removes_least_recently_used_images_beyond_budget)
+{
+    ContentURLDownloader content_url_downloader;
+    mp::DefaultVMImageVault vault{hosts,           &content_url_downloader, cache_dir.path(), data_dir.path(),
+                                  mp::days{1},     nullptr,                 mp::MemorySize{"1500"}};
+
+    host.mock_image_info.verify = false;
+    for (const auto& release : {"xenial", "bionic", "focal"})
+    {
+        host.mock_image_info.id = QString("%1-id").arg(release);
+        host.mock_image_info.image_location = QString("http://foo.com/%1.img").arg(release);
+
+        auto query = default_query;
+        query.name = release;
+        query.release = release;
+        vault.fetch_image(mp::FetchType::ImageOnly, query, stub_prepare, stub_monitor);
+    }
+
+    vault.prune_expired_images();
+
+    auto usage = vault.cache_usage();
+    ASSERT_THAT(usage.images.size(), Eq(1u));
+    EXPECT_THAT(usage.images[0].release, Eq("focal"));
+    EXPECT_THAT(usage.budget, Eq(1500));
+    EXPECT_LE(usage.total_size, usage.budget);
+}
+
+TEST_F(ImageVault, keeps_persistent_images_beyond_budget)
+{
+    ContentURLDownloader content_url_downloader;
+    mp::DefaultVMImageVault vault{hosts,       &content_url_downloader, cache_dir.path(), data_dir.path(),
+                                  mp::days{1}, nullptr,                 mp::MemorySize{"100"}};
+
+    auto query = default_query;
+    query.persistent = true;
+    host.mock_image_info.verify = false;
+    vault.fetch_image(mp::FetchType::ImageOnly, query, stub_prepare, stub_monitor);
+
+    vault.prune_expired_images();
+
+    auto usage = vault.cache_usage();
+    ASSERT_THAT(usage.images.size(), Eq(1u));
+    EXPECT_TRUE(usage.images[0].persistent);
+    EXPECT_GT(usage.total_size, usage.budget);
+}
+
+TEST_F(ImageVault, prefetches_image_once)
+{
+    mp::DefaultVMImageVault vault{hosts, &url_downloader, cache_dir.path(), data_dir.path(), mp::days{0}};
+    auto query = default_query;
+    query.name = "";
+
+    vault.prefetch_image(mp::FetchType::ImageOnly, query, stub_prepare, stub_monitor, 0);
+    vault.prefetch_image(mp::FetchType::ImageOnly, query, stub_prepare, stub_monitor, 0);
+    vault.fetch_image(mp::FetchType::ImageOnly, default_query, stub_prepare, stub_monitor);
+
+    EXPECT_THAT(url_downloader.downloaded_files.size(), Eq(1));
+}
+
+TEST_F(ImageVault, prefetch_holds_download_back)
+{
+    ReportingURLDownloader reporting_url_downloader;
+    mp::DefaultVMImageVault vault{hosts, &reporting_url_downloader, cache_dir.path(), data_dir.path(), mp::days{0}};
+    host.mock_image_info.size = 1000;
+
+    vault.prefetch_image(mp::FetchType::ImageOnly, default_query, stub_prepare, stub_monitor, 5000);
+
+    EXPECT_GE(reporting_url_downloader.report_time, std::chrono::milliseconds(150));
+}
+
+TEST_F(ImageVault, update_uses_prefetched_image)
+{
+    mp::DefaultVMImageVault vault{hosts, &url_downloader, cache_dir.path(), data_dir.path(), mp::days{1}};
+    vault.fetch_image(mp::FetchType::ImageOnly, default_query, stub_prepare, stub_monitor);
+    auto original_file{url_downloader.downloaded_files[0]};
+
+    host.mock_image_info.id = "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b856";
+    host.mock_image_info.version = "20180825";
+    host.mock_image_info.verify = false;
+    vault.prefetch_image(mp::FetchType::ImageOnly, default_query, stub_prepare, stub_monitor, 0);
+
+    vault.update_images(mp::FetchType::ImageOnly, stub_prepare, stub_monitor);
+
+    EXPECT_THAT(url_downloader.downloaded_files.size(), Eq(2));
+    EXPECT_FALSE(QFileInfo::exists(original_file));
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <src/daemon/instance_operation_queue.h>
+
+#include <gmock/gmock.h>
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace mp = multipass;
+using namespace testing;
+
+namespace
+{
+using Kind = mp::InstanceOperationQueue::Kind;
+
+struct InstanceOperationQueue : public Test
+{
+    // Schedules an operation that only records that it ran, keeping hold of its done callback
+    void schedule(const std::vector<std::string>& instances, Kind kind, const std::string& label)
+    {
+        queue.schedule(instances, kind, [this, label](const mp::InstanceOperationQueue::Done& done) {
+            ran.push_back(label);
+            pending[label] = done;
+        });
+    }
+
+    void finish(const std::string& label)
+    {
+        auto done = pending.at(label);
+        pending.erase(label);
+        done();
+    }
+
+    mp::InstanceOperationQueue queue;
+    std::vector<std::string> ran;
+    std::map<std::string, mp::InstanceOperationQueue::Done> pending;
+};
+} // namespace
+
+TEST_F(InstanceOperationQueue, runs_operation_on_idle_instance_immediately)
+{
+    schedule({"foo"}, Kind::start, "start foo");
+
+    EXPECT_THAT(ran, ElementsAre("start foo"));
+    EXPECT_TRUE(queue.is_busy("foo"));
+}
+
+TEST_F(InstanceOperationQueue, runs_operations_on_different_instances_in_parallel)
+{
+    schedule({"foo"}, Kind::start, "start foo");
+    schedule({"bar"}, Kind::stop, "stop bar");
+
+    EXPECT_THAT(ran, ElementsAre("start foo", "stop bar"));
+}
+
+TEST_F(InstanceOperationQueue, orders_operations_on_same_instance)
+{
+    schedule({"foo"}, Kind::start, "start foo");
+    schedule({"foo"}, Kind::stop, "stop foo");
+
+    EXPECT_THAT(ran, ElementsAre("start foo"));
+
+    finish("start foo");
+    EXPECT_THAT(ran, ElementsAre("start foo", "stop foo"));
+
+    finish("stop foo");
+    EXPECT_FALSE(queue.is_busy("foo"));
+}
+
+TEST_F(InstanceOperationQueue, runs_alongside_running_operation_of_same_kind)
+{
+    schedule({"foo"}, Kind::start, "first start");
+    schedule({"foo"}, Kind::start, "second start");
+
+    EXPECT_THAT(ran, ElementsAre("first start", "second start"));
+}
+
+TEST_F(InstanceOperationQueue, does_not_run_operations_that_cannot_be_repeated_alongside)
+{
+    schedule({"foo"}, Kind::restart, "first restart");
+    schedule({"foo"}, Kind::restart, "second restart");
+
+    EXPECT_THAT(ran, ElementsAre("first restart"));
+}
+
+TEST_F(InstanceOperationQueue, does_not_run_alongside_past_waiting_operation)
+{
+    schedule({"foo"}, Kind::start, "first start");
+    schedule({"foo"}, Kind::stop, "stop");
+    schedule({"foo"}, Kind::start, "second start");
+
+    EXPECT_THAT(ran, ElementsAre("first start"));
+
+    finish("first start");
+    EXPECT_THAT(ran, ElementsAre("first start", "stop"));
+
+    finish("stop");
+    EXPECT_THAT(ran, ElementsAre("first start", "stop", "second start"));
+}
+
+TEST_F(InstanceOperationQueue, waits_for_all_instances_of_an_operation)
+{
+    schedule({"foo"}, Kind::start, "start foo");
+    schedule({"bar"}, Kind::start, "start bar");
+    schedule({"foo", "bar"}, Kind::stop, "stop both");
+
+    finish("start foo");
+    EXPECT_THAT(ran, Not(Contains("stop both")));
+
+    finish("start bar");
+    EXPECT_THAT(ran, Contains("stop both"));
+}
+
+TEST_F(InstanceOperationQueue, runs_operation_with_no_instances_immediately)
+{
+    schedule({"foo"}, Kind::start, "start foo");
+    schedule({}, Kind::stop, "stop nothing");
+
+    EXPECT_THAT(ran, ElementsAre("start foo", "stop nothing"));
+}
+
+TEST_F(InstanceOperationQueue, handles_operations_finishing_synchronously)
+{
+    std::vector<std::string> order;
+    auto immediate = [&order](const std::string& label) {
+        return [&order, label](const mp::InstanceOperationQueue::Done& done) {
+            order.push_back(label);
+            done();
+        };
+    };
+
+    queue.schedule({"foo"}, Kind::start, immediate("start"));
+    queue.schedule({"foo"}, Kind::stop, immediate("stop"));
+
+    EXPECT_THAT(order, ElementsAre("start", "stop"));
+    EXPECT_FALSE(queue.is_busy("foo"));
+}
+
+TEST_F(InstanceOperationQueue, ignores_repeated_done)
+{
+    schedule({"foo"}, Kind::start, "start");
+    schedule({"foo"}, Kind::stop, "stop");
+
+    auto done = pending.at("start");
+    done();
+    done();
+
+    EXPECT_THAT(ran, ElementsAre("start", "stop"));
+    EXPECT_TRUE(queue.is_busy("foo"));
+}
+
+TEST_F(InstanceOperationQueue, moves_on_when_operation_throws)
+{
+    EXPECT_THROW(queue.schedule({"foo"}, Kind::mount,
+                                [](const mp::InstanceOperationQueue::Done&) { throw std::runtime_error{"oops"}; }),
+                 std::runtime_error);
+
+    EXPECT_FALSE(queue.is_busy("foo"));
+}
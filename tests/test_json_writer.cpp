@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "temp_dir.h"
+
+#include <src/daemon/json_writer.h>
+
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+
+#include <gmock/gmock.h>
+
+#include <stdexcept>
+
+namespace mp = multipass;
+namespace mpt = multipass::test;
+using namespace testing;
+
+namespace
+{
+QJsonObject read_json(const QString& file_name)
+{
+    QFile file{file_name};
+    file.open(QIODevice::ReadOnly);
+    return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+struct JsonWriter : public Test
+{
+    mpt::TempDir temp_dir;
+    QString file_name{temp_dir.path() + "/records.json"};
+};
+} // namespace
+
+TEST_F(JsonWriter, writes_records)
+{
+    QJsonObject records{{"foo", 42}};
+
+    mp::write_json(records, file_name);
+
+    EXPECT_EQ(read_json(file_name), records);
+}
+
+TEST_F(JsonWriter, replaces_previous_records_entirely)
+{
+    mp::write_json({{"a_long_record_name", QString(1024, 'x')}}, file_name);
+
+    QJsonObject records{{"foo", 1}};
+    mp::write_json(records, file_name);
+
+    EXPECT_EQ(read_json(file_name), records);
+}
+
+TEST_F(JsonWriter, leaves_no_temporary_files_behind)
+{
+    mp::write_json({{"foo", 1}}, file_name);
+    mp::write_json({{"foo", 2}}, file_name);
+
+    EXPECT_THAT(QDir{temp_dir.path()}.entryList(QDir::Files), ElementsAre("records.json"));
+}
+
+TEST_F(JsonWriter, throws_when_file_cannot_be_written)
+{
+    EXPECT_THROW(mp::write_json({{"foo", 1}}, temp_dir.path() + "/missing/records.json"), std::runtime_error);
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "mock_virtual_machine.h"
+
+#include <src/daemon/lazy_virtual_machine.h>
+
+#include <gmock/gmock.h>
+
+#include <memory>
+
+namespace mp = multipass;
+namespace mpt = multipass::test;
+using namespace testing;
+
+namespace
+{
+struct LazyVirtualMachine : public Test
+{
+    std::shared_ptr<mp::LazyVirtualMachine> make_lazy_vm(mp::VirtualMachine::State state)
+    {
+        return std::make_shared<mp::LazyVirtualMachine>(state, "pied-piper", "ubuntu",
+                                                        [this](mp::LazyVirtualMachine&) {
+                                                            ++backends_created;
+                                                            return backend;
+                                                        });
+    }
+
+    std::shared_ptr<NiceMock<mpt::MockVirtualMachine>> backend =
+        std::make_shared<NiceMock<mpt::MockVirtualMachine>>("pied-piper");
+    int backends_created{0};
+};
+} // namespace
+
+TEST_F(LazyVirtualMachine, does_not_create_backend_until_started)
+{
+    auto vm = make_lazy_vm(mp::VirtualMachine::State::stopped);
+
+    vm->stop();
+    vm->shutdown();
+    vm->suspend();
+    vm->update_state();
+
+    EXPECT_EQ(backends_created, 0);
+    EXPECT_FALSE(vm->backend());
+}
+
+TEST_F(LazyVirtualMachine, reports_state_it_was_given)
+{
+    auto vm = make_lazy_vm(mp::VirtualMachine::State::suspended);
+
+    EXPECT_EQ(vm->current_state(), mp::VirtualMachine::State::suspended);
+    EXPECT_EQ(vm->ssh_username(), "ubuntu");
+    EXPECT_EQ(vm->ipv4(), "UNKNOWN");
+}
+
+TEST_F(LazyVirtualMachine, throws_when_reaching_instance_before_start)
+{
+    auto vm = make_lazy_vm(mp::VirtualMachine::State::stopped);
+
+    EXPECT_THROW(vm->ssh_hostname(std::chrono::milliseconds(1)), std::runtime_error);
+    EXPECT_THROW(vm->ensure_vm_is_running(), std::runtime_error);
+    EXPECT_EQ(backends_created, 0);
+}
+
+TEST_F(LazyVirtualMachine, creates_and_starts_backend_on_start)
+{
+    auto vm = make_lazy_vm(mp::VirtualMachine::State::stopped);
+
+    EXPECT_CALL(*backend, start()).Times(2);
+
+    vm->start();
+    vm->start();
+
+    EXPECT_EQ(backends_created, 1);
+    EXPECT_EQ(vm->backend(), backend);
+}
+
+TEST_F(LazyVirtualMachine, forwards_to_backend_once_started)
+{
+    auto vm = make_lazy_vm(mp::VirtualMachine::State::stopped);
+    vm->start();
+
+    EXPECT_CALL(*backend, current_state()).WillOnce(Return(mp::VirtualMachine::State::running));
+    EXPECT_CALL(*backend, stop());
+
+    EXPECT_EQ(vm->current_state(), mp::VirtualMachine::State::running);
+    EXPECT_EQ(vm->ipv4(), "0.0.0.0");
+    EXPECT_EQ(vm->ssh_port(), 42);
+    vm->stop();
+}
+
+TEST_F(LazyVirtualMachine, survives_being_replaced_while_starting)
+{
+    std::shared_ptr<mp::VirtualMachine> instance;
+    auto vm = std::make_shared<mp::LazyVirtualMachine>(mp::VirtualMachine::State::stopped, "pied-piper", "ubuntu",
+                                                       [this, &instance](mp::LazyVirtualMachine&) {
+                                                           instance = backend;
+                                                           return backend;
+                                                       });
+    instance = vm;
+    std::weak_ptr<mp::VirtualMachine> placeholder = vm;
+    vm.reset();
+
+    EXPECT_CALL(*backend, start());
+    instance->start();
+
+    EXPECT_EQ(instance, backend);
+    EXPECT_TRUE(placeholder.expired());
+}
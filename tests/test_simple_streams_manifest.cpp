@@ -118,6 +118,38 @@ TEST(SimpleStreamsManifest, can_query_all_versions)
     }
 }
 
+TEST(SimpleStreamsManifest, can_find_products_by_id)
+{
+    auto json = mpt::load_test_file("releases/multiple_versions_manifest.json");
+    auto manifest = mp::SimpleStreamsManifest::fromJson(json, "");
+
+    for (const auto& product : manifest->products)
+    {
+        const auto info = manifest->product_with_id(product.id);
+        ASSERT_THAT(info, NotNull());
+        EXPECT_THAT(info->id, Eq(product.id));
+    }
+
+    EXPECT_THAT(manifest->product_with_id("1797"), IsNull());
+}
+
+TEST(SimpleStreamsManifest, can_find_products_by_id_prefix)
+{
+    auto json = mpt::load_test_file("releases/multiple_versions_manifest.json");
+    auto manifest = mp::SimpleStreamsManifest::fromJson(json, "");
+
+    QStringList ids;
+    const auto matches = manifest->products_with_id_prefix("1");
+    for (auto it = matches.first; it != matches.second; ++it)
+        ids << (*it)->id;
+
+    EXPECT_THAT(ids, ElementsAre("1507bd2b3288ef4bacd3e699fe71b827b7ccf321ec4487e168a30d7089d3c8e4",
+                                 "1797c5c82016c1e65f4008fcf89deae3a044ef76087a9ec5b907c6d64a3609ac"));
+
+    const auto no_matches = manifest->products_with_id_prefix("f");
+    EXPECT_EQ(no_matches.first, no_matches.second);
+}
+
 TEST(SimpleStreamsManifest, info_has_kernel_and_initrd_paths)
 {
     auto json = mpt::load_test_file("good_manifest.json");
@@ -146,3 +178,15 @@ TEST(SimpleStreamsManifest, lxd_driver_returns_expected_data)
     const QString expected_id{"09d24fab15c6e1c86a47d3de2e83d0d01a10f9ff2655a43f0959a672e03e7674"};
     EXPECT_EQ(info.id, expected_id);
 }
+
+TEST(SimpleStreamsManifest, reads_driver_setting_once)
+{
+    mpt::MockSettings& mock_settings = mpt::MockSettings::mock_instance();
+
+    EXPECT_CALL(mock_settings, get(Eq(mp::driver_key))).WillOnce(Return("qemu"));
+
+    auto json = mpt::load_test_file("releases/multiple_versions_manifest.json");
+    auto manifest = mp::SimpleStreamsManifest::fromJson(json, "");
+
+    EXPECT_GT(manifest->products.size(), 1u);
+}
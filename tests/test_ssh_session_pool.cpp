@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "mock_ssh.h"
+#include "stub_ssh_key_provider.h"
+
+#include <multipass/ssh/ssh_session_pool.h>
+
+#include <gmock/gmock.h>
+
+namespace mp = multipass;
+using namespace testing;
+
+namespace
+{
+struct SSHSessionPool : public Test
+{
+    SSHSessionPool()
+    {
+        is_connected.returnValue(true);
+        userauth.returnValue(SSH_AUTH_SUCCESS);
+        open_session.returnValue(SSH_OK);
+        request_exec.returnValue(SSH_OK);
+        channel_is_closed.returnValue(0);
+    }
+
+    decltype(MOCK(ssh_is_connected)) is_connected{MOCK(ssh_is_connected)};
+    decltype(MOCK(ssh_userauth_publickey)) userauth{MOCK(ssh_userauth_publickey)};
+    decltype(MOCK(ssh_channel_open_session)) open_session{MOCK(ssh_channel_open_session)};
+    decltype(MOCK(ssh_channel_request_exec)) request_exec{MOCK(ssh_channel_request_exec)};
+    decltype(MOCK(ssh_channel_is_closed)) channel_is_closed{MOCK(ssh_channel_is_closed)};
+    int connections{0};
+    mp::test::StubSSHKeyProvider key_provider;
+    mp::SSHSessionPool pool{key_provider};
+};
+} // namespace
+
+TEST_F(SSHSessionPool, keeps_session_between_leases)
+{
+    REPLACE(ssh_connect, [this](auto...) {
+        ++connections;
+        return SSH_OK;
+    });
+
+    pool.lease("foo", "host", 42, "ubuntu");
+    pool.lease("foo", "host", 42, "ubuntu");
+
+    EXPECT_EQ(connections, 1);
+    EXPECT_EQ(pool.metrics().handshakes, 1u);
+    EXPECT_EQ(pool.metrics().handshakes_saved, 1u);
+}
+
+TEST_F(SSHSessionPool, keeps_a_session_per_instance)
+{
+    REPLACE(ssh_connect, [this](auto...) {
+        ++connections;
+        return SSH_OK;
+    });
+
+    pool.lease("foo", "host", 42, "ubuntu");
+    pool.lease("bar", "other host", 42, "ubuntu");
+
+    EXPECT_EQ(connections, 2);
+}
+
+TEST_F(SSHSessionPool, reconnects_when_address_changes)
+{
+    REPLACE(ssh_connect, [this](auto...) {
+        ++connections;
+        return SSH_OK;
+    });
+
+    pool.lease("foo", "host", 42, "ubuntu");
+    pool.lease("foo", "new host", 42, "ubuntu");
+
+    EXPECT_EQ(connections, 2);
+}
+
+TEST_F(SSHSessionPool, reconnects_when_connection_is_down)
+{
+    REPLACE(ssh_connect, [this](auto...) {
+        ++connections;
+        return SSH_OK;
+    });
+    pool.lease("foo", "host", 42, "ubuntu");
+
+    is_connected.returnValue(false);
+    pool.lease("foo", "host", 42, "ubuntu");
+
+    EXPECT_EQ(connections, 2);
+}
+
+TEST_F(SSHSessionPool, reconnects_after_drop)
+{
+    REPLACE(ssh_connect, [this](auto...) {
+        ++connections;
+        return SSH_OK;
+    });
+    pool.lease("foo", "host", 42, "ubuntu");
+
+    pool.drop("foo");
+    pool.lease("foo", "host", 42, "ubuntu");
+
+    EXPECT_EQ(connections, 2);
+}
+
+TEST_F(SSHSessionPool, drops_a_leased_session_without_waiting_for_the_lease)
+{
+    REPLACE(ssh_connect, [this](auto...) {
+        ++connections;
+        return SSH_OK;
+    });
+    auto lease = pool.lease("foo", "host", 42, "ubuntu");
+
+    pool.drop("foo");
+    auto next_lease = pool.lease("foo", "host", 42, "ubuntu");
+
+    EXPECT_EQ(connections, 2);
+}
+
+TEST_F(SSHSessionPool, reconnects_on_request)
+{
+    REPLACE(ssh_connect, [this](auto...) {
+        ++connections;
+        return SSH_OK;
+    });
+
+    auto lease = pool.lease("foo", "host", 42, "ubuntu");
+    lease.reconnect();
+
+    EXPECT_EQ(connections, 2);
+}
+
+TEST_F(SSHSessionPool, counts_channels_opened)
+{
+    REPLACE(ssh_connect, [](auto...) { return SSH_OK; });
+
+    auto lease = pool.lease("foo", "host", 42, "ubuntu");
+    lease.exec("one");
+    lease.exec("two");
+
+    EXPECT_EQ(pool.metrics().channels_opened, 2u);
+}
+
+TEST_F(SSHSessionPool, throws_when_unable_to_connect)
+{
+    REPLACE(ssh_connect, [](auto...) { return SSH_ERROR; });
+
+    EXPECT_THROW(pool.lease("foo", "host", 42, "ubuntu"), std::runtime_error);
+}
@@ -22,14 +22,18 @@
 #include "path.h"
 #include "stub_url_downloader.h"
 
+#include <multipass/exceptions/download_exception.h>
 #include <multipass/exceptions/unsupported_image_exception.h>
 #include <multipass/query.h>
+#include <multipass/url_downloader.h>
 
 #include <QUrl>
 
 #include <gmock/gmock.h>
 
+#include <atomic>
 #include <cstddef>
+#include <thread>
 #include <unordered_set>
 
 namespace mp = multipass;
@@ -40,6 +44,85 @@ using namespace std::literals::chrono_literals;
 
 namespace
 {
+// Serves what one host has under the URLs of another, once told to
+struct SwitchingURLDownloader : public mp::URLDownloader
+{
+    using URLDownloader::URLDownloader;
+
+    QByteArray download(const QUrl& url) override
+    {
+        return URLDownloader::download(switch_url(url));
+    }
+
+    QByteArray download_if_modified(const QUrl& url, bool& not_modified) override
+    {
+        return URLDownloader::download_if_modified(switch_url(url), not_modified);
+    }
+
+    QUrl switch_url(const QUrl& url) const
+    {
+        auto switched_url = url.toString();
+        if (switched)
+            switched_url.replace(from, to);
+
+        return QUrl{switched_url};
+    }
+
+    bool switched{false};
+    QString from{"releases/"}, to{"daily/"};
+};
+
+// Never reaches one host, counting the attempts made on the thread that created it
+struct UnreachableHostURLDownloader : public mp::URLDownloader
+{
+    UnreachableHostURLDownloader(const QString& unreachable_url)
+        : URLDownloader{std::chrono::seconds{10}}, unreachable_url{unreachable_url}
+    {
+    }
+
+    QByteArray download(const QUrl& url) override
+    {
+        check_reachable(url);
+        return URLDownloader::download(url);
+    }
+
+    QByteArray download_if_modified(const QUrl& url, bool& not_modified) override
+    {
+        check_reachable(url);
+        return URLDownloader::download_if_modified(url, not_modified);
+    }
+
+    void check_reachable(const QUrl& url)
+    {
+        if (url.toString().startsWith(unreachable_url))
+        {
+            if (std::this_thread::get_id() == owner)
+                ++attempts_in_foreground;
+
+            throw mp::DownloadException{url.toString().toStdString(), "unreachable"};
+        }
+    }
+
+    const QString unreachable_url;
+    const std::thread::id owner{std::this_thread::get_id()};
+    std::atomic_int attempts_in_foreground{0};
+};
+
+// Answers that manifests did not change, once they were downloaded
+struct NotModifiedURLDownloader : public mp::URLDownloader
+{
+    using URLDownloader::URLDownloader;
+
+    QByteArray download_if_modified(const QUrl& url, bool& not_modified) override
+    {
+        ++not_modified_answers;
+        not_modified = true;
+        return {};
+    }
+
+    std::atomic_int not_modified_answers{0};
+};
+
 struct UbuntuImageHost : public testing::Test
 {
     mp::Query make_query(std::string release, std::string remote)
@@ -257,7 +340,23 @@ TEST_F(UbuntuImageHost, handles_and_recovers_from_initial_network_failure)
     EXPECT_TRUE(host.info_for(query));
 }
 
-TEST_F(UbuntuImageHost, handles_and_recovers_from_later_network_failure)
+TEST_F(UbuntuImageHost, retries_unreachable_servers_in_the_background)
+{
+    const auto ttl = 1h; // so that only the unreachable server is retried
+    UnreachableHostURLDownloader unreachable_downloader{daily_url};
+    mp::UbuntuVMImageHost host{all_remote_specs, &unreachable_downloader, ttl};
+
+    const auto query = make_query("xenial", release_remote_spec.first);
+    for (auto i = 0; i < 3; ++i)
+    {
+        EXPECT_TRUE(host.info_for(query));
+        host.wait_for_manifest_update();
+    }
+
+    EXPECT_EQ(unreachable_downloader.attempts_in_foreground, 1);
+}
+
+TEST_F(UbuntuImageHost, keeps_manifests_through_later_network_failure)
 {
     const auto ttl = 0s; // to ensure updates are always retried
     mp::UbuntuVMImageHost host{all_remote_specs, &url_downloader, ttl};
@@ -266,13 +365,16 @@ TEST_F(UbuntuImageHost, handles_and_recovers_from_later_network_failure)
     EXPECT_TRUE(host.info_for(query));
 
     url_downloader.mischiefs = 1000;
-    EXPECT_THROW(host.info_for(query), std::runtime_error);
+    EXPECT_TRUE(host.info_for(query)); // what it has is served while it is updated in the background
+    host.wait_for_manifest_update();
+    EXPECT_TRUE(host.info_for(query)); // and kept when the update fails
+    host.wait_for_manifest_update();
 
     url_downloader.mischiefs = 0;
     EXPECT_TRUE(host.info_for(query));
 }
 
-TEST_F(UbuntuImageHost, handles_and_recovers_from_independent_server_failures)
+TEST_F(UbuntuImageHost, keeps_manifests_of_servers_that_fail)
 {
     const auto ttl = 0h;
     mp::UbuntuVMImageHost host{all_remote_specs, &url_downloader, ttl};
@@ -283,10 +385,48 @@ TEST_F(UbuntuImageHost, handles_and_recovers_from_independent_server_failures)
     for (size_t i = 0; i < num_remotes; ++i)
     {
         url_downloader.mischiefs = i;
-        EXPECT_EQ(mpt::count_remotes(host), num_remotes - i);
+        mpt::count_remotes(host); // starts an update, which fails for i of the servers
+        host.wait_for_manifest_update();
+
+        EXPECT_EQ(mpt::count_remotes(host), num_remotes);
+        host.wait_for_manifest_update();
     }
 }
 
+TEST_F(UbuntuImageHost, picks_up_manifest_changes)
+{
+    SwitchingURLDownloader switching_url_downloader{std::chrono::seconds{10}};
+    mp::UbuntuVMImageHost host{{release_remote_spec}, &switching_url_downloader, 0s};
+
+    EXPECT_EQ(host.all_images_for(release_remote_spec.first, false).size(), 4u);
+    EXPECT_EQ(host.all_images_for(release_remote_spec.first, false).size(), 4u);
+    host.wait_for_manifest_update();
+
+    switching_url_downloader.switched = true;
+    EXPECT_EQ(host.all_images_for(release_remote_spec.first, false).size(), 4u); // until the update is done
+    host.wait_for_manifest_update();
+
+    EXPECT_EQ(host.all_images_for(release_remote_spec.first, false).size(), 2u);
+}
+
+TEST_F(UbuntuImageHost, keeps_manifests_that_were_not_modified)
+{
+    NotModifiedURLDownloader not_modified_downloader{std::chrono::seconds{10}};
+    mp::UbuntuVMImageHost host{{release_remote_spec}, &not_modified_downloader, 0s};
+
+    const auto query = make_query("xenial", release_remote_spec.first);
+    EXPECT_TRUE(host.info_for(query));
+    EXPECT_EQ(not_modified_downloader.not_modified_answers, 0); // there was nothing to keep yet
+
+    host.info_for(query);
+    host.wait_for_manifest_update();
+
+    EXPECT_EQ(not_modified_downloader.not_modified_answers, 1);
+    auto info = host.info_for(query);
+    ASSERT_TRUE(info);
+    EXPECT_EQ(info->id, expected_id);
+}
+
 TEST_F(UbuntuImageHost, throws_unsupported_image_when_image_not_supported)
 {
     mp::UbuntuVMImageHost host{all_remote_specs, &url_downloader, default_ttl};
@@ -0,0 +1,454 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "file_operations.h"
+#include "local_http_server.h"
+#include "temp_dir.h"
+
+#include <multipass/exceptions/download_exception.h>
+#include <multipass/url_downloader.h>
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QUrl>
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace mp = multipass;
+namespace mpt = multipass::test;
+using namespace testing;
+
+namespace
+{
+// Made so that any part out of place shows
+QByteArray make_content(int size)
+{
+    QByteArray content(size, '\0');
+    for (auto i = 0; i < content.size(); ++i)
+        content[i] = static_cast<char>(i % 251);
+
+    return content;
+}
+
+// Big enough to be downloaded in segments
+QByteArray make_large_content()
+{
+    return make_content(64 * 1024 * 1024 + 1000);
+}
+
+// Answers like a server holding the version of content that etag names. It sends the ranges it is asked for when
+// accept_ranges is set, unless If-Range names another version, and the whole of content otherwise.
+QByteArray serve(const mpt::HTTPRequest& request, const QByteArray& content, bool accept_ranges = true,
+                 const QByteArray& etag = "\"v1\"")
+{
+    QList<QByteArray> headers{"ETag: " + etag};
+    if (accept_ranges)
+        headers << "Accept-Ranges: bytes";
+
+    if (request.method == "HEAD")
+        return mpt::http_response("200 OK", {}, headers << "Content-Length: " + QByteArray::number(content.size()));
+
+    const auto range = request.header("Range");
+    const auto if_range = request.header("If-Range");
+    if (!accept_ranges || !range.startsWith("bytes=") || (!if_range.isEmpty() && if_range != etag))
+        return mpt::http_response("200 OK", content, headers);
+
+    const auto bounds = range.mid(6).split('-');
+    const auto first = bounds[0].toLongLong();
+    if (first >= content.size())
+        return mpt::http_response("416 Range Not Satisfiable", {},
+                                  headers << "Content-Range: bytes */" + QByteArray::number(content.size()));
+
+    const auto last = bounds.value(1).isEmpty() ? content.size() - 1 : bounds[1].toLongLong();
+    headers << "Content-Range: bytes " + QByteArray::number(first) + "-" + QByteArray::number(last) + "/" +
+                   QByteArray::number(content.size());
+
+    return mpt::http_response("206 Partial Content", content.mid(first, last - first + 1), headers);
+}
+
+struct URLDownloader : public Test
+{
+    URLDownloader()
+    {
+        mpt::make_file_with_content(source_name, content);
+    }
+
+    QByteArray read(const QString& file_name)
+    {
+        QFile file{file_name};
+        file.open(QIODevice::ReadOnly);
+        return file.readAll();
+    }
+
+    mpt::TempDir temp_dir;
+    const std::string content{"the image's contents"};
+    const QString source_name{temp_dir.path() + "/source.img"};
+    const QString file_name{temp_dir.path() + "/downloaded.img"};
+    mp::ProgressMonitor stub_monitor{[](int, int) { return true; }};
+    mp::URLDownloader downloader{std::chrono::seconds(10)};
+};
+} // namespace
+
+TEST_F(URLDownloader, moves_download_into_place)
+{
+    downloader.download_to(QUrl::fromLocalFile(source_name), file_name, -1, 0, stub_monitor, nullptr);
+
+    EXPECT_EQ(read(file_name).toStdString(), content);
+    EXPECT_FALSE(QFile::exists(file_name + ".part"));
+    EXPECT_FALSE(QFile::exists(file_name + ".part.validator"));
+}
+
+TEST_F(URLDownloader, hashes_what_it_downloads)
+{
+    QCryptographicHash digest{QCryptographicHash::Sha256};
+
+    downloader.download_to(QUrl::fromLocalFile(source_name), file_name, -1, 0, stub_monitor, &digest);
+
+    const auto expected = QCryptographicHash::hash(QByteArray::fromStdString(content), QCryptographicHash::Sha256);
+    EXPECT_EQ(digest.result(), expected);
+}
+
+TEST_F(URLDownloader, starts_over_when_part_cannot_be_resumed)
+{
+    mpt::make_file_with_content(file_name + ".part", "left over from a download without a validator");
+
+    downloader.download_to(QUrl::fromLocalFile(source_name), file_name, -1, 0, stub_monitor, nullptr);
+
+    EXPECT_EQ(read(file_name).toStdString(), content);
+}
+
+TEST_F(URLDownloader, does_not_retry_missing_files)
+{
+    EXPECT_THROW(downloader.download_to(QUrl::fromLocalFile(temp_dir.path() + "/missing.img"), file_name, -1, 0,
+                                        stub_monitor, nullptr),
+                 mp::DownloadException);
+    EXPECT_FALSE(QFile::exists(file_name));
+}
+
+TEST_F(URLDownloader, streams_what_it_downloads)
+{
+    QByteArray streamed;
+    QCryptographicHash digest{QCryptographicHash::Sha256};
+
+    downloader.download_stream(
+        QUrl::fromLocalFile(source_name), [&streamed](const QByteArray& data) { streamed += data; }, -1, 0,
+        stub_monitor, &digest);
+
+    EXPECT_EQ(streamed.toStdString(), content);
+    EXPECT_EQ(digest.result(), QCryptographicHash::hash(streamed, QCryptographicHash::Sha256));
+    EXPECT_FALSE(QFile::exists(file_name + ".part"));
+}
+
+TEST_F(URLDownloader, passes_on_what_stream_consumer_throws)
+{
+    EXPECT_THROW(downloader.download_stream(
+                     QUrl::fromLocalFile(source_name),
+                     [](const QByteArray&) { throw std::logic_error{"cannot consume"}; }, -1, 0, stub_monitor, nullptr),
+                 std::logic_error);
+}
+
+TEST_F(URLDownloader, downloaders_sharing_a_cache_keep_working)
+{
+    mpt::TempDir cache_dir;
+    for (auto i = 0; i < 2; ++i)
+    {
+        mp::URLDownloader cached_downloader{cache_dir.path(), std::chrono::seconds(10)};
+        EXPECT_EQ(cached_downloader.download(QUrl::fromLocalFile(source_name)).toStdString(), content);
+    }
+}
+
+TEST_F(URLDownloader, downloads_on_other_threads)
+{
+    QByteArray downloaded;
+    std::thread other_thread{
+        [this, &downloaded] { downloaded = downloader.download(QUrl::fromLocalFile(source_name)); }};
+    other_thread.join();
+
+    EXPECT_EQ(downloaded.toStdString(), content);
+    EXPECT_EQ(downloader.download(QUrl::fromLocalFile(source_name)).toStdString(), content);
+}
+
+TEST_F(URLDownloader, downloads_large_files_in_segments)
+{
+    const auto large_content = make_large_content();
+    int heads{0}, whole_gets{0};
+    std::map<QByteArray, int> ranged_gets;
+    mpt::LocalHTTPServer server{[&](const mpt::HTTPRequest& request) {
+        if (request.method == "HEAD")
+            ++heads;
+        else if (request.header("Range").isEmpty())
+            ++whole_gets;
+        else
+            ++ranged_gets[request.header("Range")];
+
+        return serve(request, large_content);
+    }};
+
+    int last_progress{0};
+    auto monitor = [&last_progress](int, int progress) {
+        last_progress = progress;
+        return true;
+    };
+
+    QCryptographicHash digest{QCryptographicHash::Sha256};
+    downloader.download_to(server.url_for("/large.img"), file_name, large_content.size(), 0, monitor, &digest);
+
+    EXPECT_EQ(heads, 1);
+    EXPECT_EQ(whole_gets, 0);
+    EXPECT_EQ(ranged_gets.size(), 4u);
+    EXPECT_EQ(last_progress, 100);
+    EXPECT_TRUE(read(file_name) == large_content);
+    EXPECT_EQ(digest.result(), QCryptographicHash::hash(large_content, QCryptographicHash::Sha256));
+}
+
+TEST_F(URLDownloader, does_not_segment_without_ranges_on_offer)
+{
+    const auto large_content = make_large_content();
+    int heads{0}, ranged_gets{0};
+    mpt::LocalHTTPServer server{[&](const mpt::HTTPRequest& request) {
+        if (request.method == "HEAD")
+            ++heads;
+        else if (!request.header("Range").isEmpty())
+            ++ranged_gets;
+
+        return serve(request, large_content, /*accept_ranges=*/false);
+    }};
+
+    downloader.download_to(server.url_for("/large.img"), file_name, large_content.size(), 0, stub_monitor, nullptr);
+
+    EXPECT_EQ(heads, 1);
+    EXPECT_EQ(ranged_gets, 0);
+    EXPECT_TRUE(read(file_name) == large_content);
+}
+
+TEST_F(URLDownloader, retries_failed_segments_on_their_own)
+{
+    const auto large_content = make_large_content();
+    std::map<QByteArray, int> ranged_gets;
+    mpt::LocalHTTPServer server{[&](const mpt::HTTPRequest& request) {
+        const auto range = request.header("Range");
+        if (request.method == "GET" && ++ranged_gets[range] == 1 && range.startsWith("bytes=0-"))
+            return mpt::http_response("503 Service Unavailable");
+
+        return serve(request, large_content);
+    }};
+
+    QCryptographicHash digest{QCryptographicHash::Sha256};
+    downloader.download_to(server.url_for("/large.img"), file_name, large_content.size(), 0, stub_monitor, &digest);
+
+    ASSERT_EQ(ranged_gets.size(), 4u);
+    for (const auto& range : ranged_gets)
+        EXPECT_EQ(range.second, range.first.startsWith("bytes=0-") ? 2 : 1) << range.first.toStdString();
+
+    EXPECT_TRUE(read(file_name) == large_content);
+    EXPECT_EQ(digest.result(), QCryptographicHash::hash(large_content, QCryptographicHash::Sha256));
+}
+
+TEST_F(URLDownloader, downloads_whole_file_when_ranges_are_refused)
+{
+    const auto large_content = make_large_content();
+    int ranged_gets{0}, whole_gets{0};
+    mpt::LocalHTTPServer server{[&](const mpt::HTTPRequest& request) {
+        if (request.method == "HEAD")
+            return serve(request, large_content);
+
+        if (request.header("Range").isEmpty())
+        {
+            ++whole_gets;
+            return serve(request, large_content);
+        }
+
+        // Offers ranges, but then sends the whole file anyway. The download gives up on it from the start.
+        ++ranged_gets;
+        return mpt::http_response("200 OK", large_content.left(1024),
+                                  {"Content-Length: " + QByteArray::number(large_content.size())});
+    }};
+
+    QCryptographicHash digest{QCryptographicHash::Sha256};
+    downloader.download_to(server.url_for("/large.img"), file_name, large_content.size(), 0, stub_monitor, &digest);
+
+    EXPECT_GE(ranged_gets, 1);
+    EXPECT_EQ(whole_gets, 1);
+    EXPECT_TRUE(read(file_name) == large_content);
+    EXPECT_EQ(digest.result(), QCryptographicHash::hash(large_content, QCryptographicHash::Sha256));
+}
+
+TEST_F(URLDownloader, resumes_part_of_the_same_version)
+{
+    const auto remote_content = make_content(1024 * 1024);
+    const auto offset = remote_content.size() / 2;
+    mpt::make_file_with_content(file_name + ".part", remote_content.left(offset).toStdString());
+    mpt::make_file_with_content(file_name + ".part.validator", "\"v1\"");
+
+    std::vector<mpt::HTTPRequest> gets;
+    mpt::LocalHTTPServer server{[&](const mpt::HTTPRequest& request) {
+        gets.push_back(request);
+        return serve(request, remote_content);
+    }};
+
+    std::vector<int> progress;
+    auto monitor = [&progress](int, int percent) {
+        progress.push_back(percent);
+        return true;
+    };
+
+    QCryptographicHash digest{QCryptographicHash::Sha256};
+    downloader.download_to(server.url_for("/resumed.img"), file_name, -1, 0, monitor, &digest);
+
+    ASSERT_EQ(gets.size(), 1u);
+    EXPECT_EQ(gets[0].header("Range"), "bytes=" + QByteArray::number(offset) + "-");
+    EXPECT_EQ(gets[0].header("If-Range"), "\"v1\"");
+
+    // Progress is over the whole file, so it carries on from where the part left off
+    ASSERT_FALSE(progress.empty());
+    EXPECT_GE(progress.front(), 50);
+    EXPECT_EQ(progress.back(), 100);
+
+    EXPECT_TRUE(read(file_name) == remote_content);
+    EXPECT_EQ(digest.result(), QCryptographicHash::hash(remote_content, QCryptographicHash::Sha256));
+    EXPECT_FALSE(QFile::exists(file_name + ".part.validator"));
+}
+
+TEST_F(URLDownloader, starts_over_when_the_remote_file_changed)
+{
+    const auto remote_content = make_content(1024 * 1024);
+    mpt::make_file_with_content(file_name + ".part", "part of an older version");
+    mpt::make_file_with_content(file_name + ".part.validator", "\"v0\"");
+
+    int ranged_gets{0};
+    mpt::LocalHTTPServer server{[&](const mpt::HTTPRequest& request) {
+        ranged_gets += !request.header("Range").isEmpty();
+        return serve(request, remote_content);
+    }};
+
+    QCryptographicHash digest{QCryptographicHash::Sha256};
+    downloader.download_to(server.url_for("/changed.img"), file_name, -1, 0, stub_monitor, &digest);
+
+    EXPECT_EQ(ranged_gets, 1);
+    EXPECT_TRUE(read(file_name) == remote_content);
+    EXPECT_EQ(digest.result(), QCryptographicHash::hash(remote_content, QCryptographicHash::Sha256));
+}
+
+TEST_F(URLDownloader, starts_over_when_the_range_is_not_satisfiable)
+{
+    const auto remote_content = make_content(1024);
+    mpt::make_file_with_content(file_name + ".part", make_content(2048).toStdString());
+    mpt::make_file_with_content(file_name + ".part.validator", "\"v1\"");
+
+    std::vector<QByteArray> ranges;
+    mpt::LocalHTTPServer server{[&](const mpt::HTTPRequest& request) {
+        ranges.push_back(request.header("Range"));
+        return serve(request, remote_content);
+    }};
+
+    downloader.download_to(server.url_for("/shrunk.img"), file_name, -1, 0, stub_monitor, nullptr);
+
+    EXPECT_THAT(ranges, ElementsAre("bytes=2048-", ""));
+    EXPECT_TRUE(read(file_name) == remote_content);
+}
+
+TEST_F(URLDownloader, retries_transient_failures_waiting_longer_each_time)
+{
+    const auto remote_content = make_content(1024);
+    std::vector<std::chrono::steady_clock::time_point> gets;
+    mpt::LocalHTTPServer server{[&](const mpt::HTTPRequest& request) {
+        gets.push_back(std::chrono::steady_clock::now());
+        if (gets.size() < 3)
+            return mpt::http_response("503 Service Unavailable");
+
+        return serve(request, remote_content);
+    }};
+
+    downloader.download_to(server.url_for("/busy.img"), file_name, -1, 0, stub_monitor, nullptr);
+
+    ASSERT_EQ(gets.size(), 3u);
+    EXPECT_GE(gets[1] - gets[0], std::chrono::seconds(1));
+    EXPECT_GE(gets[2] - gets[1], std::chrono::seconds(2));
+    EXPECT_TRUE(read(file_name) == remote_content);
+}
+
+TEST_F(URLDownloader, resumes_dropped_download_with_its_validator)
+{
+    const auto remote_content = make_content(1024 * 1024);
+    const auto cut = remote_content.size() / 4;
+
+    std::vector<mpt::HTTPRequest> gets;
+    QByteArray validator_on_retry;
+    mpt::LocalHTTPServer server{[&](const mpt::HTTPRequest& request) {
+        gets.push_back(request);
+        if (gets.size() == 1)
+            return mpt::http_response("200 OK", remote_content.left(cut),
+                                      {"ETag: \"v1\"", "Content-Length: " + QByteArray::number(remote_content.size()),
+                                       "Connection: close"});
+
+        validator_on_retry = read(file_name + ".part.validator");
+        return serve(request, remote_content);
+    }};
+
+    std::vector<int> progress;
+    auto monitor = [&progress](int, int percent) {
+        progress.push_back(percent);
+        return true;
+    };
+
+    QCryptographicHash digest{QCryptographicHash::Sha256};
+    downloader.download_to(server.url_for("/dropped.img"), file_name, -1, 0, monitor, &digest);
+
+    ASSERT_EQ(gets.size(), 2u);
+    EXPECT_EQ(validator_on_retry, "\"v1\"");
+    EXPECT_EQ(gets[1].header("Range"), "bytes=" + QByteArray::number(cut) + "-");
+    EXPECT_EQ(gets[1].header("If-Range"), "\"v1\"");
+
+    // The retry doesn't take progress back to the start
+    EXPECT_TRUE(std::is_sorted(progress.begin(), progress.end()));
+    EXPECT_EQ(progress.back(), 100);
+
+    EXPECT_TRUE(read(file_name) == remote_content);
+    EXPECT_EQ(digest.result(), QCryptographicHash::hash(remote_content, QCryptographicHash::Sha256));
+    EXPECT_FALSE(QFile::exists(file_name + ".part.validator"));
+}
+
+TEST_F(URLDownloader, returns_nothing_when_copy_is_not_modified)
+{
+    const QByteArray manifest{"the manifest"};
+    std::vector<QByteArray> if_none_match;
+    mpt::LocalHTTPServer server{[&](const mpt::HTTPRequest& request) {
+        if_none_match.push_back(request.header("If-None-Match"));
+        if (request.header("If-None-Match") == "\"v1\"")
+            return mpt::http_response("304 Not Modified", {}, {"ETag: \"v1\""});
+
+        return serve(request, manifest);
+    }};
+
+    mpt::TempDir cache_dir;
+    mp::URLDownloader cached_downloader{cache_dir.path(), std::chrono::seconds(10)};
+
+    bool not_modified{true};
+    EXPECT_EQ(cached_downloader.download_if_modified(server.url_for("/manifest.json"), not_modified), manifest);
+    EXPECT_FALSE(not_modified);
+
+    EXPECT_TRUE(cached_downloader.download_if_modified(server.url_for("/manifest.json"), not_modified).isEmpty());
+    EXPECT_TRUE(not_modified);
+
+    EXPECT_THAT(if_none_match, ElementsAre("", "\"v1\""));
+}
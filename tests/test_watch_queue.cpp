@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <src/daemon/watch_queue.h>
+
+#include <multipass/auto_join_thread.h>
+
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace mp = multipass;
+using namespace testing;
+using namespace std::literals::chrono_literals;
+
+namespace
+{
+mp::WatchReply reply_for(const std::string& name, mp::InstanceStatus::Status status)
+{
+    mp::WatchReply reply;
+    auto entry = reply.add_instances();
+    entry->set_name(name);
+    entry->mutable_instance_status()->set_status(status);
+
+    return reply;
+}
+
+mp::WatchReply removal_of(const std::string& name)
+{
+    mp::WatchReply reply;
+    reply.add_removed_instances(name);
+
+    return reply;
+}
+
+auto status_of(const mp::WatchReply& reply, const std::string& name)
+{
+    for (const auto& instance : reply.instances())
+        if (instance.name() == name)
+            return instance.instance_status().status();
+
+    ADD_FAILURE() << "no status for " << name;
+    return mp::InstanceStatus::UNKNOWN;
+}
+} // namespace
+
+TEST(WatchQueue, hands_over_updates_in_order)
+{
+    mp::WatchQueue queue{8};
+    queue.push(reply_for("foo", mp::InstanceStatus::STARTING));
+    queue.push(reply_for("bar", mp::InstanceStatus::STOPPED));
+
+    const auto replies = queue.take(0ms);
+
+    ASSERT_EQ(replies.size(), 2u);
+    EXPECT_EQ(status_of(replies[0], "foo"), mp::InstanceStatus::STARTING);
+    EXPECT_EQ(status_of(replies[1], "bar"), mp::InstanceStatus::STOPPED);
+    EXPECT_TRUE(queue.take(0ms).empty());
+}
+
+TEST(WatchQueue, folds_updates_together_once_full)
+{
+    mp::WatchQueue queue{2};
+    queue.push(reply_for("foo", mp::InstanceStatus::STARTING));
+    queue.push(reply_for("foo", mp::InstanceStatus::RUNNING));
+    queue.push(reply_for("bar", mp::InstanceStatus::STARTING));
+    queue.push(reply_for("foo", mp::InstanceStatus::STOPPED));
+
+    const auto replies = queue.take(0ms);
+
+    ASSERT_EQ(replies.size(), 2u);
+    EXPECT_EQ(status_of(replies[0], "foo"), mp::InstanceStatus::STARTING);
+    ASSERT_EQ(replies[1].instances_size(), 2);
+    EXPECT_EQ(status_of(replies[1], "foo"), mp::InstanceStatus::STOPPED);
+    EXPECT_EQ(status_of(replies[1], "bar"), mp::InstanceStatus::STARTING);
+}
+
+TEST(WatchQueue, folds_removals_over_earlier_updates)
+{
+    mp::WatchQueue queue{1};
+    queue.push(reply_for("foo", mp::InstanceStatus::STOPPED));
+    queue.push(removal_of("foo"));
+    queue.push(reply_for("bar", mp::InstanceStatus::RUNNING));
+
+    const auto replies = queue.take(0ms);
+
+    ASSERT_EQ(replies.size(), 1u);
+    ASSERT_EQ(replies[0].instances_size(), 1);
+    EXPECT_EQ(status_of(replies[0], "bar"), mp::InstanceStatus::RUNNING);
+    EXPECT_THAT(replies[0].removed_instances(), ElementsAre("foo"));
+}
+
+TEST(WatchQueue, waits_for_updates)
+{
+    mp::WatchQueue queue{8};
+    mp::AutoJoinThread pusher{[&queue] {
+        std::this_thread::sleep_for(10ms);
+        queue.push(reply_for("foo", mp::InstanceStatus::RUNNING));
+    }};
+
+    EXPECT_EQ(queue.take(5s).size(), 1u);
+}
+
+TEST(WatchQueue, gives_up_waiting_after_timeout)
+{
+    mp::WatchQueue queue{8};
+
+    EXPECT_TRUE(queue.take(1ms).empty());
+}
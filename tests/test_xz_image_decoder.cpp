@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2020 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "path.h"
+#include "temp_dir.h"
+
+#include <multipass/rpc/multipass.grpc.pb.h>
+#include <multipass/xz_image_decoder.h>
+
+#include <QFile>
+
+#include <gmock/gmock.h>
+
+namespace mp = multipass;
+namespace mpt = multipass::test;
+using namespace testing;
+
+namespace
+{
+struct XzImageDecoder : public Test
+{
+    QByteArray read(const QString& file_name)
+    {
+        QFile file{file_name};
+        file.open(QIODevice::ReadOnly);
+        return file.readAll();
+    }
+
+    // The test images hold "multipass\n" over and over, up to 200000 bytes. image-blocks.img.xz has it in 4 blocks.
+    QByteArray expected_image()
+    {
+        QByteArray image;
+        while (image.size() < 200000)
+            image += "multipass\n";
+        image.truncate(200000);
+        return image;
+    }
+
+    mpt::TempDir temp_dir;
+    const QString xz_file_name{mpt::test_data_path_for("image.img.xz")};
+    const QString decoded_file_name{temp_dir.path() + "/image.img"};
+    mp::ProgressMonitor stub_monitor{[](int, int) { return true; }};
+};
+} // namespace
+
+TEST_F(XzImageDecoder, decodes_file)
+{
+    mp::XzImageDecoder decoder{xz_file_name};
+    decoder.decode_to(decoded_file_name, stub_monitor);
+
+    EXPECT_EQ(read(decoded_file_name), expected_image());
+}
+
+TEST_F(XzImageDecoder, keeps_zeros_it_skips_over)
+{
+    // image-sparse.img.xz holds 1 MiB of zeros on each side of one line
+    const QByteArray zeros(1024 * 1024, '\0');
+
+    mp::XzImageDecoder decoder{mpt::test_data_path_for("image-sparse.img.xz")};
+    decoder.decode_to(decoded_file_name, stub_monitor);
+
+    EXPECT_EQ(read(decoded_file_name), zeros + "multipass\n" + zeros);
+}
+
+TEST_F(XzImageDecoder, decodes_file_in_blocks)
+{
+    int extract_reports{0};
+    mp::ProgressMonitor counting_monitor{[&extract_reports](int type, int) {
+        if (type == mp::LaunchProgress::EXTRACT)
+            ++extract_reports;
+        return true;
+    }};
+
+    mp::XzImageDecoder decoder{mpt::test_data_path_for("image-blocks.img.xz")};
+    decoder.decode_to(decoded_file_name, counting_monitor);
+
+    EXPECT_EQ(read(decoded_file_name), expected_image());
+    EXPECT_EQ(extract_reports, 4);
+}
+
+TEST_F(XzImageDecoder, throws_when_a_block_is_corrupt)
+{
+    auto xz_data = read(mpt::test_data_path_for("image-blocks.img.xz"));
+    xz_data[150] = ~xz_data[150]; // inside the second block
+
+    const auto corrupt_file_name = temp_dir.path() + "/corrupt.img.xz";
+    QFile corrupt_file{corrupt_file_name};
+    corrupt_file.open(QIODevice::WriteOnly);
+    corrupt_file.write(xz_data);
+    corrupt_file.close();
+
+    mp::XzImageDecoder decoder{corrupt_file_name};
+    EXPECT_THROW(decoder.decode_to(decoded_file_name, stub_monitor), std::runtime_error);
+}
+
+TEST_F(XzImageDecoder, decodes_stream_in_any_pieces)
+{
+    const auto xz_data = read(xz_file_name);
+
+    mp::XzImageDecoder::StreamDecoder decoder{decoded_file_name};
+    for (int pos = 0; pos < xz_data.size(); pos += 7)
+        decoder.decode(xz_data.mid(pos, 7));
+    decoder.finish();
+
+    EXPECT_EQ(read(decoded_file_name), expected_image());
+}
+
+TEST_F(XzImageDecoder, throws_when_stream_is_cut_short)
+{
+    const auto xz_data = read(xz_file_name);
+
+    mp::XzImageDecoder::StreamDecoder decoder{decoded_file_name};
+    decoder.decode(xz_data.left(xz_data.size() / 2));
+
+    EXPECT_THROW(decoder.finish(), std::runtime_error);
+}
+
+TEST_F(XzImageDecoder, throws_on_data_that_is_not_xz)
+{
+    mp::XzImageDecoder::StreamDecoder decoder{decoded_file_name};
+
+    EXPECT_THROW(decoder.decode("not a xz stream"), std::runtime_error);
+}